@@ -5,14 +5,10 @@ int main(int argc, char* argv[])
 {
     try 
     {
-        std::string filename;
+        // 命令行可以给出多个文件或 .m3u 列表（--loop 循环播放），没有文件时空启动
+        Playlist playlist = Playlist::fromArguments(argc, argv);
         
-        // 如果命令行提供了文件名则使用，否则空启动
-        if (argc > 1) {
-            filename = argv[1];
-        }
-        
-        PlayerApp app(filename); // 支持空字符串启动
+        PlayerApp app(playlist); // 支持空列表启动
         if (!app.init()) 
         {
             std::cerr << "Failed to initialize player" << std::endl;
@@ -4,24 +4,26 @@ in vec2 TexCoord;
 out vec4 FragColor;
 
 uniform sampler2D y_texture;
-uniform sampler2D u_texture;
+uniform sampler2D u_texture;    // 半平面格式（NV12/P010）时为 UV 交错的双通道纹理
 uniform sampler2D v_texture;
+uniform int uv_interleaved;
+
+// 由渲染器按流的色彩空间、范围和位深计算：rgb = yuv_matrix * 采样值 + yuv_offset
+uniform mat3 yuv_matrix;
+uniform vec3 yuv_offset;
 
 void main() {
-    // 获取YUV分量
+    // 获取YUV分量（归一化的纹理采样值，范围和位深在矩阵中处理）
     float y = texture(y_texture, TexCoord).r;
-    float u = texture(u_texture, TexCoord).r - 0.5;
-    float v = texture(v_texture, TexCoord).r - 0.5;
+    vec2 uv;
+    if (uv_interleaved == 1) {
+        uv = texture(u_texture, TexCoord).rg;
+    } else {
+        uv = vec2(texture(u_texture, TexCoord).r, texture(v_texture, TexCoord).r);
+    }
     
-    // 使用BT.601标准YUV到RGB转换矩阵
-    float r = y + 1.402 * v;
-    float g = y - 0.344136 * u - 0.714136 * v;
-    float b = y + 1.772 * u;
+    vec3 rgb = yuv_matrix * vec3(y, uv) + yuv_offset;
     
     // 确保颜色值在[0,1]范围内
-    r = clamp(r, 0.0, 1.0);
-    g = clamp(g, 0.0, 1.0);
-    b = clamp(b, 0.0, 1.0);
-    
-    FragColor = vec4(r, g, b, 1.0);
-}
\ No newline at end of file
+    FragColor = vec4(clamp(rgb, 0.0, 1.0), 1.0);
+}
@@ -0,0 +1,157 @@
+// audio_gain_bench.cpp
+// 音量/混音内核微基准：各 SIMD 实现对比标量定点实现和原先的 int16_t(sample * float) 循环。
+// 输入是合成的交错 S16 多声道 PCM，不需要媒体文件；结果以 JSON 输出。
+//
+// 用法: sdl2_player_audio_gain_bench [--channels N] [--rate HZ] [--buffer FRAMES] [--iterations N]
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <functional>
+
+#include "../play/audio_gain.hpp"
+
+extern "C" {
+#include <libavutil/time.h>
+}
+
+namespace {
+
+struct GainOptions
+{
+    int channels = 6;
+    int rate = 48000;
+    int buffer = 1024;      // 每次处理的采样帧数，对应一次 SDL 音频回调
+    int iterations = 20000;
+};
+
+bool parseArgs(int argc, char* argv[], GainOptions& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        int value = std::atoi(argv[++i]);
+        if (value <= 0) return false;
+
+        if (arg == "--channels") options.channels = value;
+        else if (arg == "--rate") options.rate = value;
+        else if (arg == "--buffer") options.buffer = value;
+        else if (arg == "--iterations") options.iterations = value;
+        else return false;
+    }
+    return true;
+}
+
+// 预热一次后计时，返回每个缓冲区的平均微秒数
+double timeIt(int iterations, const std::function<void()>& body)
+{
+    body();
+    int64_t start = av_gettime_relative();
+    for (int i = 0; i < iterations; i++) body();
+    return (av_gettime_relative() - start) / static_cast<double>(iterations);
+}
+
+// realtime_x：处理速度是实时播放的多少倍
+void writeResult(std::ostream& out, const std::string& name, double us, int64_t samples, double buffer_us,
+                 const char* extra, bool last)
+{
+    out << "    \"" << name << "\": {\"us_per_buffer\": " << us
+        << ", \"msamples_s\": " << (us > 0 ? samples / us : 0.0)
+        << ", \"realtime_x\": " << (us > 0 ? buffer_us / us : 0.0)
+        << extra << "}" << (last ? "\n" : ",\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    GainOptions options;
+    if (!parseArgs(argc, argv, options))
+    {
+        std::cerr << "Usage: sdl2_player_audio_gain_bench [--channels N] [--rate HZ] [--buffer FRAMES] "
+                     "[--iterations N]" << std::endl;
+        return 2;
+    }
+
+    // 合成的 PCM：接近满幅的正弦叠加噪声，增益 > 1 时会触发饱和
+    const size_t count = static_cast<size_t>(options.buffer) * options.channels;
+    std::vector<int16_t> source(count), other(count);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < count; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        int32_t noise = static_cast<int32_t>(seed >> 20) - 2048;
+        int32_t wave = static_cast<int32_t>((i / options.channels) % 96) * 600 - 28800;
+        source[i] = static_cast<int16_t>(wave + noise);
+        other[i] = static_cast<int16_t>(noise * 8);
+    }
+    std::vector<int16_t> work(count), reference(count), mix_reference(count);
+    const int64_t samples = static_cast<int64_t>(count);
+    const double buffer_us = 1e6 * options.buffer / options.rate;
+
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"source\": \"" << options.channels << "ch " << options.rate << "Hz s16, "
+         << options.buffer << " frames\",\n";
+    json << "  \"cpu\": \"" << simdLevelName(detectSimdLevel()) << "\",\n";
+    json << "  \"iterations\": " << options.iterations << ",\n";
+
+    // 每个增益各跑一遍：衰减（音量滑块）和放大（触发饱和）。各项计时都包含把源数据拷回工作区
+    for (float gain : {0.5f, 2.0f})
+    {
+        AudioGain scalar;
+        scalar.configure(GainKernel::SCALAR);
+        reference = source;
+        scalar.apply(reference.data(), count, gain);
+        mix_reference = other;
+        scalar.mix(mix_reference.data(), source.data(), count, gain);
+
+        json << "  \"apply_gain_" << gain << "\": {\n";
+        {
+            // 原先回调里的写法，作为对照（增益 > 1 时溢出回绕）
+            double us = timeIt(options.iterations, [&]() {
+                work = source;
+                for (size_t i = 0; i < count; i++) work[i] = (int16_t)(work[i] * gain);
+            });
+            writeResult(json, "float_loop", us, samples, buffer_us, "", false);
+        }
+        for (GainKernel kernel : {GainKernel::SCALAR, GainKernel::SSE2, GainKernel::AVX2, GainKernel::NEON})
+        {
+            if (!AudioGain::isAvailable(kernel)) continue;
+            AudioGain gain_kernel;
+            gain_kernel.configure(kernel);
+            double us = timeIt(options.iterations, [&]() {
+                work = source;
+                gain_kernel.apply(work.data(), count, gain);
+            });
+            writeResult(json, AudioGain::kernelName(kernel), us, samples, buffer_us,
+                        work == reference ? ", \"exact\": true" : ", \"exact\": false",
+                        kernel == AudioGain::kernelFor(detectSimdLevel()));
+        }
+        json << "  },\n";
+
+        json << "  \"mix_gain_" << gain << "\": {\n";
+        for (GainKernel kernel : {GainKernel::SCALAR, GainKernel::SSE2, GainKernel::AVX2, GainKernel::NEON})
+        {
+            if (!AudioGain::isAvailable(kernel)) continue;
+            AudioGain gain_kernel;
+            gain_kernel.configure(kernel);
+            double us = timeIt(options.iterations, [&]() {
+                work = other;
+                gain_kernel.mix(work.data(), source.data(), count, gain);
+            });
+            writeResult(json, AudioGain::kernelName(kernel), us, samples, buffer_us,
+                        work == mix_reference ? ", \"exact\": true" : ", \"exact\": false",
+                        kernel == AudioGain::kernelFor(detectSimdLevel()));
+        }
+        json << (gain == 2.0f ? "  }\n" : "  },\n");
+    }
+    json << "}\n";
+
+    std::cout << json.str();
+    return 0;
+}
@@ -0,0 +1,343 @@
+// bench_main.cpp
+// 无头基准测试：运行与播放器相同的解封装/解码线程和队列，音视频输出换成空消费者，
+// 不需要窗口、OpenGL 或音频设备。结果以 JSON 输出，便于在 CI 上比较流水线改动。
+//
+// 用法: sdl2_player_bench <文件> [--seconds N] [--no-audio] [--no-video] [--output 结果.json]
+//                          [--decoder 后端] [--threads N] [--thread-type frame|slice|auto]
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+
+// 基准程序自己提供 main，不使用 SDL2main 的入口（Windows 上 SDL_main.h 会把 main 重定义为 SDL_main）
+#define SDL_MAIN_HANDLED
+
+#include "../player_core/player_state.hpp"
+#include "../player_core/media_input.hpp"
+#include "../player_core/decode/audio_decode.hpp"
+#include "../player_core/decode/video_decode.hpp"
+#include "../player_thread/demux_thread.hpp"
+#include "../player_thread/decode_thread.hpp"
+#include "null_sink.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+struct BenchOptions
+{
+    std::string filename;
+    std::string output;       // 为空时输出到标准输出
+    double seconds = 0.0;     // 0 表示解码到文件结束
+    bool audio = true;
+    bool video = true;
+    DecoderConfig decoder = DecoderConfig::fromEnvironment(AVMEDIA_TYPE_VIDEO);   // 视频流的解码后端和线程设置
+};
+
+bool parseArgs(int argc, char* argv[], BenchOptions& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--seconds" && i + 1 < argc) {
+            options.seconds = std::atof(argv[++i]);
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg == "--no-audio") {
+            options.audio = false;
+        } else if (arg == "--no-video") {
+            options.video = false;
+        } else if (arg == "--decoder" && i + 1 < argc) {
+            options.decoder.backend = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.decoder.thread_count = std::atoi(argv[++i]);
+        } else if (arg == "--thread-type" && i + 1 < argc) {
+            if (!DecoderConfig::parseThreadType(argv[++i], options.decoder.thread_type)) return false;
+        } else if (!arg.empty() && arg[0] != '-' && options.filename.empty()) {
+            options.filename = arg;
+        } else {
+            return false;
+        }
+    }
+    return !options.filename.empty();
+}
+
+// 与 PlayerApp::setupAudio/setupVideo 相同的解码器打开方式，保证测量的是同一条路径
+template<typename Decoder>
+std::unique_ptr<Decoder> openDecoder(PlayerState& state, AVStream* stream, DecoderConfig config, PipelineThread thread)
+{
+    AVMediaType type = stream->codecpar->codec_type;
+    state.threading.configureDecoder(config, type);
+
+    auto decoder = std::make_unique<Decoder>();
+    AffinityScope affinity(state.threading, thread);
+    if (!decoder->open(stream->codecpar, config)) {
+        std::cerr << "Bench: Cannot open codec for stream " << stream->index << std::endl;
+        return nullptr;
+    }
+    state.threading.recordDecoder(type, decoder->getCodecCtx());
+    return decoder;
+}
+
+double peakRssMB()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+    }
+    return 0.0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return usage.ru_maxrss / (1024.0 * 1024.0);   // 字节
+#else
+        return usage.ru_maxrss / 1024.0;              // KB
+#endif
+    }
+    return 0.0;
+#endif
+}
+
+std::string jsonEscape(const std::string& text)
+{
+    std::string out;
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+void writeHistogram(std::ostream& out, const char* name, const LatencyHistogram& histogram, bool last)
+{
+    LatencyHistogram::Snapshot s = histogram.snapshot();
+    out << "    \"" << name << "\": {\"count\": " << s.count
+        << ", \"mean_us\": " << s.mean_us
+        << ", \"p50_us\": " << s.p50_us
+        << ", \"p90_us\": " << s.p90_us
+        << ", \"p99_us\": " << s.p99_us
+        << ", \"p999_us\": " << s.p999_us
+        << ", \"max_us\": " << s.max_us << "}" << (last ? "\n" : ",\n");
+}
+
+void writeStream(std::ostream& out, const char* name, const NullSink* sink, double elapsed, bool last)
+{
+    int64_t frames = sink ? sink->frames() : 0;
+    int64_t bytes = sink ? sink->bytes() : 0;
+    out << "  \"" << name << "\": {\"frames\": " << frames
+        << ", \"fps\": " << (elapsed > 0 ? frames / elapsed : 0.0)
+        << ", \"decoded_bytes\": " << bytes
+        << ", \"decoded_mb_s\": " << (elapsed > 0 ? bytes / (1024.0 * 1024.0) / elapsed : 0.0)
+        << "}" << (last ? "\n" : ",\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    BenchOptions options;
+    if (!parseArgs(argc, argv, options))
+    {
+        std::cerr << "Usage: sdl2_player_bench <file> [--seconds N] [--no-audio] [--no-video] [--output result.json] "
+                     "[--decoder NAME] [--threads N] [--thread-type frame|slice|auto]" << std::endl;
+        return 2;
+    }
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    PlayerState state;
+    state.filename = options.filename;
+
+    // 在主线程打开输入并确定参与测试的流，再交给解封装线程（走预先打开输入的路径），
+    // 解封装线程开始读包之后不再修改流索引和 discard
+    {
+        MediaInput input;
+        std::string message;
+        if (openMediaInput(state.io_options, state.probe_options, state.filename, input, message) != PlayerError::NONE)
+        {
+            std::cerr << "Bench: Cannot open " << options.filename << ": " << message << std::endl;
+            return 1;
+        }
+        state.adoptInput(input);
+    }
+
+    // 不参与测试的流在解封装层丢弃，避免其包队列写满后阻塞解封装线程
+    if (!options.audio && state.audio_stream >= 0) {
+        state.fmt_ctx->streams[state.audio_stream]->discard = AVDISCARD_ALL;
+        state.audio_stream = -1;
+    }
+    if (!options.video && state.video_stream >= 0) {
+        state.fmt_ctx->streams[state.video_stream]->discard = AVDISCARD_ALL;
+        state.video_stream = -1;
+    }
+
+    // 解码器打不开的流同样丢弃；音频始终软件解码，线程数按线程策略决定
+    std::unique_ptr<AudioDecode> audio_decoder;
+    std::unique_ptr<VideoDecode> video_decoder;
+    if (state.audio_stream >= 0) {
+        DecoderConfig audio_config = DecoderConfig::fromEnvironment(AVMEDIA_TYPE_AUDIO);
+        audio_config.backend = "software";
+        audio_decoder = openDecoder<AudioDecode>(state, state.fmt_ctx->streams[state.audio_stream], audio_config,
+                                                 PipelineThread::AUDIO_DECODE);
+        if (audio_decoder) {
+            state.audio_ctx = audio_decoder->detachCodecCtx();
+        } else {
+            state.fmt_ctx->streams[state.audio_stream]->discard = AVDISCARD_ALL;
+            state.audio_stream = -1;
+        }
+    }
+    if (state.video_stream >= 0) {
+        video_decoder = openDecoder<VideoDecode>(state, state.fmt_ctx->streams[state.video_stream], options.decoder,
+                                                 PipelineThread::VIDEO_DECODE);
+        if (video_decoder) {
+            state.video_ctx = video_decoder->detachCodecCtx();
+        } else {
+            state.fmt_ctx->streams[state.video_stream]->discard = AVDISCARD_ALL;
+            state.video_stream = -1;
+        }
+    }
+
+    std::unique_ptr<AudioDecodeThread> audio_thread;
+    std::unique_ptr<VideoDecodeThread> video_thread;
+    std::unique_ptr<NullSink> audio_sink;
+    std::unique_ptr<NullSink> video_sink;
+
+    if (state.audio_stream >= 0)
+    {
+        audio_thread = std::make_unique<AudioDecodeThread>(audio_decoder.get(), &state.audio_packet_queue,
+                                                           &state.audio_frame_queue, &state, "AudioDecodeThread");
+        audio_sink = std::make_unique<NullSink>(&state, &state.audio_frame_queue, &state.audio_frame_pool, "audio");
+    }
+    if (state.video_stream >= 0)
+    {
+        video_thread = std::make_unique<VideoDecodeThread>(video_decoder.get(), &state.video_packet_queue,
+                                                           &state.video_frame_queue, &state, "VideoDecodeThread");
+        video_sink = std::make_unique<NullSink>(&state, &state.video_frame_queue, &state.video_frame_pool, "video");
+    }
+
+    if (!audio_thread && !video_thread)
+    {
+        std::cerr << "Bench: No decodable stream" << std::endl;
+        return 1;
+    }
+
+    // 解封装线程与播放器完全相同
+    DemuxThread demux_thread(&state);
+
+    int64_t start = av_gettime_relative();
+    demux_thread.start();
+    if (audio_sink) audio_sink->start();
+    if (video_sink) video_sink->start();
+    if (audio_thread) audio_thread->start();
+    if (video_thread) video_thread->start();
+
+    // 等待解封装和解码线程全部结束（文件读完），或达到时间上限
+    bool time_limited = false;
+    while (state.running_threads.load() > 0)
+    {
+        if (options.seconds > 0 && (av_gettime_relative() - start) >= options.seconds * AV_TIME_BASE)
+        {
+            time_limited = true;
+            break;
+        }
+        std::unique_lock<std::mutex> lock(state.threads_mutex);
+        state.threads_cv.wait_for(lock, std::chrono::milliseconds(100));
+    }
+
+    if (time_limited)
+    {
+        state.quit = true;
+        state.audio_packet_queue.set_quit(true);
+        state.video_packet_queue.set_quit(true);
+        state.audio_frame_queue.set_quit(true);
+        state.video_frame_queue.set_quit(true);
+        state.packet_space_signal.notify();
+    }
+
+    demux_thread.stop();
+    demux_thread.join();
+    if (audio_thread) { audio_thread->join(); }
+    if (video_thread) { video_thread->join(); }
+    if (audio_sink) { audio_sink->finish(); audio_sink->join(); }
+    if (video_sink) { video_sink->finish(); video_sink->join(); }
+
+    double elapsed = (av_gettime_relative() - start) / (double)AV_TIME_BASE;
+
+    int64_t input_bytes = 0;
+    std::string backend = "ffmpeg";
+    if (state.avio) {
+        input_bytes = state.avio->getStats().bytes_read;
+        backend = state.avio->backendName();
+    } else if (state.fmt_ctx && state.fmt_ctx->pb) {
+        input_bytes = state.fmt_ctx->pb->bytes_read;
+    }
+
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"file\": \"" << jsonEscape(options.filename) << "\",\n";
+    json << "  \"io_backend\": \"" << backend << "\",\n";
+    json << "  \"video_decoder\": \"" << (video_decoder ? video_decoder->backendName() : "none") << "\",\n";
+    json << "  \"completed\": " << (time_limited ? "false" : "true") << ",\n";
+    json << "  \"elapsed_s\": " << elapsed << ",\n";
+    json << "  \"input\": {\"bytes\": " << input_bytes
+         << ", \"mb_s\": " << (elapsed > 0 ? input_bytes / (1024.0 * 1024.0) / elapsed : 0.0) << "},\n";
+    writeStream(json, "video", video_sink.get(), elapsed, false);
+    writeStream(json, "audio", audio_sink.get(), elapsed, false);
+    json << "  \"stages\": {\n";
+    // 渲染相关阶段（sws/上传/呈现）在无头模式下不会产生数据，只输出有记录的阶段
+    for (int i = 0; i < PipelineMetrics::STAGE_COUNT; i++)
+    {
+        MetricStage stage = static_cast<MetricStage>(i);
+        if (state.metrics.histogram(stage).count() > 0) {
+            writeHistogram(json, PipelineMetrics::stageName(stage), state.metrics.histogram(stage), false);
+        }
+    }
+    LatencyHistogram empty;
+    writeHistogram(json, "video_sink_wait", video_sink ? video_sink->waitTiming() : empty, false);
+    writeHistogram(json, "audio_sink_wait", audio_sink ? audio_sink->waitTiming() : empty, true);
+    json << "  },\n";
+    json << "  \"threading\": " << state.threading.toJson() << ",\n";
+    json << "  \"peak_rss_mb\": " << peakRssMB() << "\n";
+    json << "}\n";
+
+    if (options.output.empty()) {
+        std::cout << json.str();
+    } else {
+        std::ofstream file(options.output);
+        if (!file) {
+            std::cerr << "Bench: Cannot write " << options.output << std::endl;
+            return 1;
+        }
+        file << json.str();
+    }
+
+    // 解码线程先于解码器析构；解码器上下文由 PlayerState 释放
+    audio_thread.reset();
+    video_thread.reset();
+    return 0;
+}
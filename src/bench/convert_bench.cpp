@@ -0,0 +1,192 @@
+// convert_bench.cpp
+// 软件像素转换微基准：内置 YUV->RGBA / 平面缩放内核（各 SIMD 级别）对比 sws_scale。
+// 输入是合成的 YUV420P 图像，不需要媒体文件；结果以 JSON 输出。
+//
+// 用法: sdl2_player_convert_bench [--width W] [--height H] [--scale-width W] [--scale-height H] [--iterations N]
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <functional>
+
+#include "../ffmpeg_utils/ffmpeg_headers.hpp"
+#include "../play/yuv_convert.hpp"
+
+extern "C" {
+#include <libavutil/time.h>
+}
+
+namespace {
+
+struct ConvertOptions
+{
+    int width = 3840;
+    int height = 2160;
+    int scale_width = 1920;
+    int scale_height = 1080;
+    int iterations = 50;
+};
+
+bool parseArgs(int argc, char* argv[], ConvertOptions& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        int value = std::atoi(argv[++i]);
+        if (value <= 0) return false;
+
+        if (arg == "--width") options.width = value;
+        else if (arg == "--height") options.height = value;
+        else if (arg == "--scale-width") options.scale_width = value;
+        else if (arg == "--scale-height") options.scale_height = value;
+        else if (arg == "--iterations") options.iterations = value;
+        else return false;
+    }
+    return true;
+}
+
+// 预热一次后计时，返回每帧平均微秒数
+double timeIt(int iterations, const std::function<void()>& body)
+{
+    body();
+    int64_t start = av_gettime_relative();
+    for (int i = 0; i < iterations; i++) body();
+    return (av_gettime_relative() - start) / static_cast<double>(iterations);
+}
+
+void writeResult(std::ostream& out, const std::string& name, double us, int64_t pixels, bool last)
+{
+    out << "    \"" << name << "\": {\"us_per_frame\": " << us
+        << ", \"mpix_s\": " << (us > 0 ? pixels / us : 0.0) << "}" << (last ? "\n" : ",\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    ConvertOptions options;
+    if (!parseArgs(argc, argv, options))
+    {
+        std::cerr << "Usage: sdl2_player_convert_bench [--width W] [--height H] [--scale-width W] "
+                     "[--scale-height H] [--iterations N]" << std::endl;
+        return 2;
+    }
+
+    // 合成的 YUV420P 源：平滑渐变加少量噪声，接近真实画面的数据分布
+    AVFrame* src = av_frame_alloc();
+    src->format = AV_PIX_FMT_YUV420P;
+    src->width = options.width;
+    src->height = options.height;
+    if (av_frame_get_buffer(src, 0) < 0)
+    {
+        std::cerr << "ConvertBench: Cannot allocate source frame" << std::endl;
+        av_frame_free(&src);
+        return 1;
+    }
+    uint32_t seed = 12345;
+    for (int p = 0; p < 3; p++)
+    {
+        int w = p == 0 ? options.width : (options.width + 1) / 2;
+        int h = p == 0 ? options.height : (options.height + 1) / 2;
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                seed = seed * 1664525u + 1013904223u;
+                src->data[p][y * src->linesize[p] + x] = static_cast<uint8_t>((x + y) / 4 + (seed >> 29));
+            }
+        }
+    }
+
+    const int64_t pixels = static_cast<int64_t>(options.width) * options.height;
+    std::vector<uint8_t> rgba(static_cast<size_t>(pixels) * 4);
+    const int rgba_stride = options.width * 4;
+
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"source\": \"" << options.width << "x" << options.height << " yuv420p\",\n";
+    json << "  \"cpu\": \"" << simdLevelName(detectSimdLevel()) << "\",\n";
+    json << "  \"iterations\": " << options.iterations << ",\n";
+
+    // YUV -> RGBA
+    json << "  \"yuv420p_to_rgba\": {\n";
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE41, SimdLevel::AVX2})
+    {
+        if (level > detectSimdLevel()) continue;
+        YuvToRgbaConverter converter;
+        converter.configure(AV_PIX_FMT_YUV420P, options.width, options.height, level);
+        double us = timeIt(options.iterations, [&]() {
+            converter.convertFrame(src, rgba.data(), rgba_stride);
+        });
+        writeResult(json, std::string("builtin_") + simdLevelName(level), us, pixels, false);
+    }
+    for (int flags : {SWS_POINT, SWS_BILINEAR})
+    {
+        SwsContext* sws = sws_getContext(options.width, options.height, AV_PIX_FMT_YUV420P,
+                                         options.width, options.height, AV_PIX_FMT_RGBA,
+                                         flags, nullptr, nullptr, nullptr);
+        if (!sws) continue;
+        uint8_t* dst[4] = {rgba.data(), nullptr, nullptr, nullptr};
+        int dst_stride[4] = {rgba_stride, 0, 0, 0};
+        double us = timeIt(options.iterations, [&]() {
+            sws_scale(sws, src->data, src->linesize, 0, options.height, dst, dst_stride);
+        });
+        writeResult(json, flags == SWS_POINT ? "swscale_point" : "swscale_bilinear", us, pixels,
+                    flags == SWS_BILINEAR);
+        sws_freeContext(sws);
+    }
+    json << "  },\n";
+
+    // YUV420P 三平面缩放
+    const int sw = options.scale_width;
+    const int sh = options.scale_height;
+    const int64_t scaled_pixels = static_cast<int64_t>(sw) * sh;
+    AVFrame* scaled = av_frame_alloc();
+    scaled->format = AV_PIX_FMT_YUV420P;
+    scaled->width = sw;
+    scaled->height = sh;
+    if (av_frame_get_buffer(scaled, 0) < 0)
+    {
+        std::cerr << "ConvertBench: Cannot allocate scaled frame" << std::endl;
+        av_frame_free(&scaled);
+        av_frame_free(&src);
+        return 1;
+    }
+
+    json << "  \"yuv420p_rescale_" << sw << "x" << sh << "\": {\n";
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE41, SimdLevel::AVX2})
+    {
+        if (level > detectSimdLevel()) continue;
+        PlaneScaler luma, chroma;
+        luma.configure(options.width, options.height, sw, sh, level);
+        chroma.configure((options.width + 1) / 2, (options.height + 1) / 2, (sw + 1) / 2, (sh + 1) / 2, level);
+        double us = timeIt(options.iterations, [&]() {
+            luma.scale(src->data[0], src->linesize[0], scaled->data[0], scaled->linesize[0]);
+            chroma.scale(src->data[1], src->linesize[1], scaled->data[1], scaled->linesize[1]);
+            chroma.scale(src->data[2], src->linesize[2], scaled->data[2], scaled->linesize[2]);
+        });
+        writeResult(json, std::string("builtin_") + simdLevelName(level), us, scaled_pixels, false);
+    }
+    {
+        SwsContext* sws = sws_getContext(options.width, options.height, AV_PIX_FMT_YUV420P,
+                                         sw, sh, AV_PIX_FMT_YUV420P, SWS_BILINEAR, nullptr, nullptr, nullptr);
+        double us = 0.0;
+        if (sws) {
+            us = timeIt(options.iterations, [&]() {
+                sws_scale(sws, src->data, src->linesize, 0, options.height, scaled->data, scaled->linesize);
+            });
+            sws_freeContext(sws);
+        }
+        writeResult(json, "swscale_bilinear", us, scaled_pixels, true);
+    }
+    json << "  }\n";
+    json << "}\n";
+
+    std::cout << json.str();
+
+    av_frame_free(&scaled);
+    av_frame_free(&src);
+    return 0;
+}
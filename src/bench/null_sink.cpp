@@ -0,0 +1,57 @@
+#include "null_sink.hpp"
+
+void NullSink::start() 
+{
+    thread_ = std::thread(&NullSink::run, this);
+}
+
+void NullSink::join() 
+{
+    if (thread_.joinable()) 
+        thread_.join();
+}
+
+void NullSink::run() 
+{
+    int64_t wait_start = av_gettime_relative();
+
+    while (!state_->quit) 
+    {
+        AVFrame* frame = nullptr;
+        if (queue_->pop(frame, state_->quit, 100)) 
+        {
+            int64_t now = av_gettime_relative();
+            wait_timing_.record(now - wait_start);
+
+            frames_++;
+            bytes_ += frameBytes(frame);
+            pool_->release(frame);
+
+            wait_start = av_gettime_relative();
+            continue;
+        }
+
+        if (producer_done_ && queue_->empty()) 
+        {
+            break;
+        }
+    }
+}
+
+int64_t NullSink::frameBytes(const AVFrame* frame)
+{
+    if (frame->nb_samples > 0) 
+    {
+        int size = av_samples_get_buffer_size(nullptr, frame->channels, frame->nb_samples,
+                                              static_cast<AVSampleFormat>(frame->format), 1);
+        return size > 0 ? size : 0;
+    }
+
+    if (frame->width > 0 && frame->height > 0) 
+    {
+        int size = av_image_get_buffer_size(static_cast<AVPixelFormat>(frame->format),
+                                            frame->width, frame->height, 1);
+        return size > 0 ? size : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <thread>
+#include <atomic>
+#include <string>
+#include "../player_core/player_state.hpp"
+
+/**
+ * 无头基准测试用的空消费者：从帧队列取帧、计数后立即归还帧池，代替音频回调和渲染。
+ *
+ * 记录取帧等待时间（消费端饥饿程度）和输出的原始帧字节数。
+ */
+class NullSink 
+{
+public:
+    NullSink(PlayerState* state, SpscQueue<AVFrame*>* queue, FramePool* pool, const std::string& name)
+        : state_(state), queue_(queue), pool_(pool), name_(name)
+    {
+    }
+
+    void start();
+    void join();
+    // 生产者（解码线程）已退出，取完队列中剩余的帧后结束
+    void finish() { producer_done_ = true; }
+
+    const std::string& name() const { return name_; }
+    int64_t frames() const { return frames_.load(); }
+    int64_t bytes() const { return bytes_.load(); }
+    const LatencyHistogram& waitTiming() const { return wait_timing_; }
+
+private:
+    void run();
+    static int64_t frameBytes(const AVFrame* frame);
+
+    PlayerState* state_;
+    SpscQueue<AVFrame*>* queue_;
+    FramePool* pool_;
+    std::string name_;
+    std::thread thread_;
+    std::atomic<bool> producer_done_{false};
+    std::atomic<int64_t> frames_{0};
+    std::atomic<int64_t> bytes_{0};
+    LatencyHistogram wait_timing_;
+};
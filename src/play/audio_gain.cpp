@@ -0,0 +1,287 @@
+#include "audio_gain.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if PLAYER_SIMD_X86
+#include <immintrin.h>
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+#if PLAYER_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr int GAIN_SHIFT = 12;
+constexpr int32_t GAIN_ROUND = 1 << (GAIN_SHIFT - 1);
+
+inline int16_t clampS16(int32_t v)
+{
+    return static_cast<int16_t>(v < -32768 ? -32768 : (v > 32767 ? 32767 : v));
+}
+
+inline int16_t scaleSample(int16_t x, int32_t gain_q12)
+{
+    return clampS16((x * gain_q12 + GAIN_ROUND) >> GAIN_SHIFT);
+}
+
+void applyScalar(int16_t* samples, size_t count, int32_t gain_q12)
+{
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = scaleSample(samples[i], gain_q12);
+    }
+}
+
+void mixScalar(int16_t* dst, const int16_t* src, size_t count, int32_t gain_q12)
+{
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = clampS16(dst[i] + scaleSample(src[i], gain_q12));
+    }
+}
+
+void applyF32Scalar(float* samples, size_t count, float gain)
+{
+    for (size_t i = 0; i < count; i++) {
+        samples[i] *= gain;
+    }
+}
+
+#if PLAYER_SIMD_X86
+
+// 16x16 -> 32 位乘积由 mullo/mulhi 交织得到，舍入移位后用 packs 饱和回 16 位
+SIMD_TARGET("sse2")
+inline __m128i scaleSse2(__m128i x, __m128i gain, __m128i round)
+{
+    __m128i lo = _mm_mullo_epi16(x, gain);
+    __m128i hi = _mm_mulhi_epi16(x, gain);
+    __m128i p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), GAIN_SHIFT);
+    __m128i p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), GAIN_SHIFT);
+    return _mm_packs_epi32(p0, p1);
+}
+
+SIMD_TARGET("sse2")
+void applySse2(int16_t* samples, size_t count, int32_t gain_q12)
+{
+    const __m128i gain = _mm_set1_epi16(static_cast<int16_t>(gain_q12));
+    const __m128i round = _mm_set1_epi32(GAIN_ROUND);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(samples + i), scaleSse2(x, gain, round));
+    }
+    applyScalar(samples + i, count - i, gain_q12);
+}
+
+SIMD_TARGET("sse2")
+void mixSse2(int16_t* dst, const int16_t* src, size_t count, int32_t gain_q12)
+{
+    const __m128i gain = _mm_set1_epi16(static_cast<int16_t>(gain_q12));
+    const __m128i round = _mm_set1_epi32(GAIN_ROUND);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epi16(d, scaleSse2(x, gain, round)));
+    }
+    mixScalar(dst + i, src + i, count - i, gain_q12);
+}
+
+SIMD_TARGET("sse2")
+void applyF32Sse2(float* samples, size_t count, float gain)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), g));
+    }
+    applyF32Scalar(samples + i, count - i, gain);
+}
+
+// unpack/packs 都按 128 位通道各自进行，两次交织相互抵消，输出顺序不变
+SIMD_TARGET("avx2")
+inline __m256i scaleAvx2(__m256i x, __m256i gain, __m256i round)
+{
+    __m256i lo = _mm256_mullo_epi16(x, gain);
+    __m256i hi = _mm256_mulhi_epi16(x, gain);
+    __m256i p0 = _mm256_srai_epi32(_mm256_add_epi32(_mm256_unpacklo_epi16(lo, hi), round), GAIN_SHIFT);
+    __m256i p1 = _mm256_srai_epi32(_mm256_add_epi32(_mm256_unpackhi_epi16(lo, hi), round), GAIN_SHIFT);
+    return _mm256_packs_epi32(p0, p1);
+}
+
+SIMD_TARGET("avx2")
+void applyAvx2(int16_t* samples, size_t count, int32_t gain_q12)
+{
+    const __m256i gain = _mm256_set1_epi16(static_cast<int16_t>(gain_q12));
+    const __m256i round = _mm256_set1_epi32(GAIN_ROUND);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(samples + i), scaleAvx2(x, gain, round));
+    }
+    applyScalar(samples + i, count - i, gain_q12);
+}
+
+SIMD_TARGET("avx2")
+void mixAvx2(int16_t* dst, const int16_t* src, size_t count, int32_t gain_q12)
+{
+    const __m256i gain = _mm256_set1_epi16(static_cast<int16_t>(gain_q12));
+    const __m256i round = _mm256_set1_epi32(GAIN_ROUND);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_adds_epi16(d, scaleAvx2(x, gain, round)));
+    }
+    mixScalar(dst + i, src + i, count - i, gain_q12);
+}
+
+SIMD_TARGET("avx2")
+void applyF32Avx2(float* samples, size_t count, float gain)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), g));
+    }
+    applyF32Scalar(samples + i, count - i, gain);
+}
+
+#endif // PLAYER_SIMD_X86
+
+#if PLAYER_SIMD_NEON
+
+// vqrshrn 即舍入右移并饱和收窄，与标量公式一致
+inline int16x8_t scaleNeon(int16x8_t x, int16x4_t gain)
+{
+    int32x4_t p0 = vmull_s16(vget_low_s16(x), gain);
+    int32x4_t p1 = vmull_s16(vget_high_s16(x), gain);
+    return vcombine_s16(vqrshrn_n_s32(p0, GAIN_SHIFT), vqrshrn_n_s32(p1, GAIN_SHIFT));
+}
+
+void applyNeon(int16_t* samples, size_t count, int32_t gain_q12)
+{
+    const int16x4_t gain = vdup_n_s16(static_cast<int16_t>(gain_q12));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        vst1q_s16(samples + i, scaleNeon(vld1q_s16(samples + i), gain));
+    }
+    applyScalar(samples + i, count - i, gain_q12);
+}
+
+void mixNeon(int16_t* dst, const int16_t* src, size_t count, int32_t gain_q12)
+{
+    const int16x4_t gain = vdup_n_s16(static_cast<int16_t>(gain_q12));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), scaleNeon(vld1q_s16(src + i), gain)));
+    }
+    mixScalar(dst + i, src + i, count - i, gain_q12);
+}
+
+void applyF32Neon(float* samples, size_t count, float gain)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(samples + i, vmulq_n_f32(vld1q_f32(samples + i), gain));
+    }
+    applyF32Scalar(samples + i, count - i, gain);
+}
+
+#endif // PLAYER_SIMD_NEON
+
+} // namespace
+
+GainKernel AudioGain::kernelFor(SimdLevel level)
+{
+#if PLAYER_SIMD_X86
+    if (level == SimdLevel::AVX2) return GainKernel::AVX2;
+    if (level == SimdLevel::SSE41) return GainKernel::SSE2;
+#elif PLAYER_SIMD_NEON
+    // 非 x86 平台 detectSimdLevel 总是 SCALAR，这里单独处理强制标量的环境变量
+    const char* forced = std::getenv("SDL2_PLAYER_SIMD");
+    if (!forced || std::strcmp(forced, "scalar") != 0) return GainKernel::NEON;
+#endif
+    (void)level;
+    return GainKernel::SCALAR;
+}
+
+bool AudioGain::isAvailable(GainKernel kernel)
+{
+    switch (kernel) {
+        case GainKernel::SCALAR: return true;
+#if PLAYER_SIMD_X86
+        case GainKernel::SSE2:   return detectSimdLevel() >= SimdLevel::SSE41;
+        case GainKernel::AVX2:   return detectSimdLevel() >= SimdLevel::AVX2;
+#endif
+#if PLAYER_SIMD_NEON
+        case GainKernel::NEON:   return kernelFor(SimdLevel::SCALAR) == GainKernel::NEON;
+#endif
+        default:                 return false;
+    }
+}
+
+const char* AudioGain::kernelName(GainKernel kernel)
+{
+    switch (kernel) {
+        case GainKernel::SSE2: return "sse2";
+        case GainKernel::AVX2: return "avx2";
+        case GainKernel::NEON: return "neon";
+        default:               return "scalar";
+    }
+}
+
+int32_t AudioGain::toFixed(float gain)
+{
+    if (!(gain > 0.0f)) return 0;
+    long q = std::lround(gain * (1 << GAIN_SHIFT));
+    return static_cast<int32_t>(q > 32767 ? 32767 : q);
+}
+
+void AudioGain::configure(GainKernel kernel)
+{
+    if (!isAvailable(kernel)) kernel = GainKernel::SCALAR;
+    kernel_ = kernel;
+    apply_ = applyScalar;
+    mix_ = mixScalar;
+    apply_f32_ = applyF32Scalar;
+    switch (kernel) {
+#if PLAYER_SIMD_X86
+        case GainKernel::SSE2: apply_ = applySse2; mix_ = mixSse2; apply_f32_ = applyF32Sse2; break;
+        case GainKernel::AVX2: apply_ = applyAvx2; mix_ = mixAvx2; apply_f32_ = applyF32Avx2; break;
+#endif
+#if PLAYER_SIMD_NEON
+        case GainKernel::NEON: apply_ = applyNeon; mix_ = mixNeon; apply_f32_ = applyF32Neon; break;
+#endif
+        default: break;
+    }
+}
+
+void AudioGain::apply(int16_t* samples, size_t count, float gain) const
+{
+    int32_t q = toFixed(gain);
+    if (q == (1 << GAIN_SHIFT)) return;     // 单位增益
+    if (q == 0) {
+        std::memset(samples, 0, count * sizeof(int16_t));
+        return;
+    }
+    apply_(samples, count, q);
+}
+
+void AudioGain::mix(int16_t* dst, const int16_t* src, size_t count, float gain) const
+{
+    int32_t q = toFixed(gain);
+    if (q == 0) return;
+    mix_(dst, src, count, q);
+}
+
+void AudioGain::apply(float* samples, size_t count, float gain) const
+{
+    if (gain == 1.0f) return;
+    if (!(gain > 0.0f)) {
+        std::memset(samples, 0, count * sizeof(float));
+        return;
+    }
+    apply_f32_(samples, count, gain);
+}
@@ -0,0 +1,65 @@
+// audio_gain.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "player_core/utils/cpu_features.hpp"
+
+// ARM 上 NEON 是 AArch64 的基础指令集，编译期可用即直接使用
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PLAYER_SIMD_NEON 1
+#else
+#define PLAYER_SIMD_NEON 0
+#endif
+
+/**
+ * S16 音量内核的实现。x86 上 SSE4.1 级别只用到 SSE2 指令。
+ */
+enum class GainKernel
+{
+    SCALAR,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+/**
+ * 交错 PCM 的音量调节与混音。
+ *
+ * S16 的增益量化为 Q12 定点（0 ~ 约 8 倍，1.0 精确对应 4096），乘积舍入后饱和到 int16，
+ * 不会像直接转换 int16_t(sample * gain) 那样溢出回绕；F32 直接相乘，超出 ±1.0 的部分由设备端截断。
+ * 各实现结果逐位一致，
+ * 按 CPU 在运行时选择 AVX2 / SSE2 / NEON / 标量实现，可在实时音频回调中调用（不分配内存）。
+ */
+class AudioGain
+{
+public:
+    using ApplyFunc = void (*)(int16_t* samples, size_t count, int32_t gain_q12);
+    using MixFunc = void (*)(int16_t* dst, const int16_t* src, size_t count, int32_t gain_q12);
+    using ApplyF32Func = void (*)(float* samples, size_t count, float gain);
+
+    static GainKernel kernelFor(SimdLevel level);
+    static bool isAvailable(GainKernel kernel);
+    static const char* kernelName(GainKernel kernel);
+    static int32_t toFixed(float gain);
+
+    AudioGain() { configure(kernelFor(detectSimdLevel())); }
+
+    // 不可用的实现退回标量
+    void configure(GainKernel kernel);
+    GainKernel kernel() const { return kernel_; }
+
+    // samples[i] = sat(samples[i] * gain)，count 为样本数（所有声道合计）
+    void apply(int16_t* samples, size_t count, float gain) const;
+    // dst[i] = sat(dst[i] + sat(src[i] * gain))
+    void mix(int16_t* dst, const int16_t* src, size_t count, float gain) const;
+    // samples[i] *= gain
+    void apply(float* samples, size_t count, float gain) const;
+
+private:
+    GainKernel kernel_ = GainKernel::SCALAR;
+    ApplyFunc apply_ = nullptr;
+    MixFunc mix_ = nullptr;
+    ApplyF32Func apply_f32_ = nullptr;
+};
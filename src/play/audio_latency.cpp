@@ -0,0 +1,37 @@
+#include "audio_latency.hpp"
+#include <algorithm>
+
+void AudioLatencyEstimator::configure(int bytes_per_sec, int buffer_bytes, double extra_seconds)
+{
+    bytes_per_sec_ = bytes_per_sec;
+    buffer_seconds_ = bytes_per_sec > 0 ? static_cast<double>(buffer_bytes) / bytes_per_sec : 0.0;
+    extra_seconds_ = extra_seconds;
+    reset();
+}
+
+void AudioLatencyEstimator::reset()
+{
+    delivered_ = 0;
+    lead_count_ = 0;
+    lead_next_ = 0;
+    latency_.store(2.0 * buffer_seconds_ + extra_seconds_);
+}
+
+double AudioLatencyEstimator::onCallback(double now, int len)
+{
+    if (bytes_per_sec_ <= 0) return extra_seconds_;
+
+    double lead = static_cast<double>(delivered_) / bytes_per_sec_ - now;
+    delivered_ += static_cast<uint64_t>(len);
+
+    leads_[lead_next_] = lead;
+    lead_next_ = (lead_next_ + 1) % AUDIO_LATENCY_WINDOW;
+    lead_count_ = std::min(lead_count_ + 1, AUDIO_LATENCY_WINDOW);
+    double min_lead = *std::min_element(leads_, leads_ + lead_count_);
+
+    // 暂停后重新开始时领先量整体下降，旧的较大值不影响最小值；上限防止时间轴跳变时给出离谱的结果
+    double queued = std::min(lead - min_lead + buffer_seconds_, AUDIO_LATENCY_MAX);
+    double latency = queued + static_cast<double>(len) / bytes_per_sec_ + extra_seconds_;
+    latency_.store(latency);
+    return latency;
+}
@@ -0,0 +1,45 @@
+// audio_latency.hpp
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "../player_core/utils/player_constants.hpp"
+
+/**
+ * 估计已交给音频设备、尚未播放的时长。
+ *
+ * SDL 不报告设备延迟，这里从回调时刻推算：累计交付的时长减去回调时刻得到"领先量"，
+ * 两次回调之间领先量的差就是设备队列的变化。假设窗口内最早被取空的那次回调时设备还剩一个缓冲区，
+ * 设备队列 = 领先量 - 窗口内最小领先量 + 一个缓冲区。回调周期均匀时结果约为两个缓冲区，
+ * 后端成批请求数据或回调被推迟时随之变化。窗口按回调次数滑动，设备时钟与系统时钟的微小偏差不会累积。
+ *
+ * 只在音频回调线程调用 onCallback，latency() 可在任意线程读取。
+ */
+class AudioLatencyEstimator
+{
+public:
+    // extra_seconds 为额外的固定输出延迟（蓝牙、HDMI 功放等，设备端不可见）
+    void configure(int bytes_per_sec, int buffer_bytes, double extra_seconds = 0.0);
+    void reset();
+
+    // 每次回调开始时调用（len 为本次要交付的字节数），返回本次数据末尾距离被听到还有多久（秒）
+    double onCallback(double now, int len);
+
+    // 最近一次估计，回调开始前为两个缓冲区加额外延迟
+    double latency() const { return latency_.load(); }
+    // 其中设备队列里的部分（不含额外延迟）
+    double deviceQueued() const { return latency_.load() - extra_seconds_; }
+
+private:
+    int bytes_per_sec_ = 0;
+    double buffer_seconds_ = 0.0;
+    double extra_seconds_ = 0.0;
+
+    uint64_t delivered_ = 0;                    // 已交付给设备的字节数
+    double leads_[AUDIO_LATENCY_WINDOW] = {};   // 最近各次回调的领先量
+    int lead_count_ = 0;
+    int lead_next_ = 0;
+
+    std::atomic<double> latency_{0.0};
+};
@@ -1,6 +1,55 @@
 #include "audio_player.hpp"
 #include <iostream>
+#include <cstdlib>
 #include <cstring>
+#include <chrono>
+#include <algorithm>
+
+namespace {
+
+// SDL2_PLAYER_AUDIO_FORMAT=s16|f32 强制输出格式，默认（auto）按源格式选择
+AVSampleFormat chooseOutputFormat(AVSampleFormat source)
+{
+    if (const char* forced = std::getenv("SDL2_PLAYER_AUDIO_FORMAT")) {
+        if (std::strcmp(forced, "s16") == 0) return AV_SAMPLE_FMT_S16;
+        if (std::strcmp(forced, "f32") == 0) return AV_SAMPLE_FMT_FLT;
+    }
+    switch (av_get_packed_sample_fmt(source)) {
+        case AV_SAMPLE_FMT_U8:
+        case AV_SAMPLE_FMT_S16:
+            return AV_SAMPLE_FMT_S16;
+        default:
+            return AV_SAMPLE_FMT_FLT;
+    }
+}
+
+// SDL 的多声道交错顺序（见 SDL_audio.h）对应的 FFmpeg 布局；5.1 后两个声道也可以是 BL/BR
+int64_t deviceChannelLayout(int channels, int64_t source_layout)
+{
+    switch (channels) {
+        case 1: return AV_CH_LAYOUT_MONO;
+        case 2: return AV_CH_LAYOUT_STEREO;
+        case 3: return AV_CH_LAYOUT_2POINT1;
+        case 4: return AV_CH_LAYOUT_QUAD;
+        case 5: return AV_CH_LAYOUT_QUAD | AV_CH_LOW_FREQUENCY;
+        case 6: return source_layout == static_cast<int64_t>(AV_CH_LAYOUT_5POINT1_BACK) ? AV_CH_LAYOUT_5POINT1_BACK : AV_CH_LAYOUT_5POINT1;
+        case 7: return AV_CH_LAYOUT_6POINT1;
+        case 8: return AV_CH_LAYOUT_7POINT1;
+        default: return av_get_default_channel_layout(channels);
+    }
+}
+
+// SDL2_PLAYER_AUDIO_LATENCY_MS：设备端不可见的额外输出延迟（蓝牙耳机、功放等），可为负以抵消估计偏大
+double extraOutputLatency()
+{
+    if (const char* text = std::getenv("SDL2_PLAYER_AUDIO_LATENCY_MS")) {
+        double ms = std::atof(text);
+        return std::max(-500.0, std::min(ms, 1000.0)) / 1000.0;
+    }
+    return 0.0;
+}
+
+} // namespace
 
 AudioPlayer::AudioPlayer(PlayerState* state) 
     : state_(state)
@@ -25,32 +74,67 @@ bool AudioPlayer::open()
         return false;
     }
     
+    // 输出格式：浮点/高位深源默认用 F32 输出，避免量化到 16 位；保留源声道数（最多 8 个）
+    AVSampleFormat out_fmt = chooseOutputFormat(state_->audio_ctx->sample_fmt);
+    int channels = std::max(1, std::min(state_->audio_ctx->channels, 8));
+
     SDL_AudioSpec wanted = {}, obtained = {};
     wanted.freq = state_->audio_ctx->sample_rate;
-    wanted.format = AUDIO_S16SYS;
-    wanted.channels = state_->audio_ctx->channels;
+    wanted.format = out_fmt == AV_SAMPLE_FMT_FLT ? AUDIO_F32SYS : AUDIO_S16SYS;
+    wanted.channels = static_cast<Uint8>(channels);
     wanted.silence = 0;
     wanted.samples = SDL_AUDIO_BUFFER_SIZE;
     wanted.callback = audioCallback;
     wanted.userdata = this;
     
-    dev_id_ = SDL_OpenAudioDevice(nullptr, 0, &wanted, &obtained, 0);
+    // 采样率和格式不匹配时由 SDL 转换；声道数允许设备改为它支持的值
+    dev_id_ = SDL_OpenAudioDevice(nullptr, 0, &wanted, &obtained, SDL_AUDIO_ALLOW_CHANNELS_CHANGE);
+    if (dev_id_ == 0 && wanted.channels > 2) 
+    {
+        // 旧版 SDL 不接受 3/5/7 声道
+        std::cerr << "Failed to open " << channels << "-channel audio device (" << SDL_GetError() 
+                  << "), retrying with stereo" << std::endl;
+        wanted.channels = 2;
+        dev_id_ = SDL_OpenAudioDevice(nullptr, 0, &wanted, &obtained, SDL_AUDIO_ALLOW_CHANNELS_CHANGE);
+    }
     if (dev_id_ == 0) 
     {
         std::cerr << "Failed to open audio device: " << SDL_GetError() << std::endl;
         return false;
     }
     
-    // 初始化重采样器
+    // 初始化重采样器；格式、采样率和布局都与解码输出一致时直通
+    int64_t out_layout = deviceChannelLayout(obtained.channels, state_->audio_ctx->channel_layout);
     if (!resampler_.init(state_->audio_ctx, 
-                        AV_SAMPLE_FMT_S16,
+                        out_fmt,
                         obtained.freq, 
-                        obtained.channels)) 
+                        out_layout)) 
     {
         std::cerr << "Failed to initialize audio resampler" << std::endl;
+        SDL_CloseAudioDevice(dev_id_);
+        dev_id_ = 0;
         return false;
     }
     
+    out_fmt_ = out_fmt;
+    bytes_per_sec_ = av_samples_get_buffer_size(nullptr, obtained.channels, obtained.freq, out_fmt_, 1);
+    hw_buf_size_ = obtained.size;
+    frame_bytes_ = obtained.channels * av_get_bytes_per_sample(out_fmt_);
+    stretcher_.configure(obtained.freq, obtained.channels);
+    stretching_ = false;
+    sample_rate_ = obtained.freq;
+    latency_.configure(bytes_per_sec_, hw_buf_size_, extraOutputLatency());
+    state_->sync.setAudioLatency(latency_.latency());
+    std::cout << "AudioPlayer: " << obtained.freq << " Hz, " << static_cast<int>(obtained.channels) << " ch, "
+              << av_get_sample_fmt_name(out_fmt_) << " (" << av_get_sample_fmt_name(state_->audio_ctx->sample_fmt)
+              << " -> " << AudioResampler::modeName(resampler_.mode()) << ")" << std::endl;
+    
+    // 环形缓冲区至少容纳两个设备缓冲区
+    ring_.allocate(std::max<size_t>(static_cast<size_t>(bytes_per_sec_ * AUDIO_RING_SECONDS), 2 * hw_buf_size_));
+    next_pts_ = NAN;
+    publishClock(NAN);
+    flush_serial_ = state_->audio_flush_serial.load();
+    
     return true;
 }
 
@@ -58,6 +142,10 @@ void AudioPlayer::start()
 {
     if (dev_id_ > 0) 
     {
+        if (!feeding_.exchange(true)) 
+        {
+            feeder_thread_ = std::thread(&AudioPlayer::feederLoop, this);
+        }
         SDL_PauseAudioDevice(dev_id_, 0);
         paused_ = false;
     }
@@ -65,6 +153,13 @@ void AudioPlayer::start()
 
 void AudioPlayer::stop() 
 {
+    feeding_ = false;
+    if (feeder_thread_.joinable()) 
+    {
+        feeder_thread_.join();
+    }
+    releaseHeldFrame();
+    
     if (dev_id_ > 0) 
     {
         SDL_PauseAudioDevice(dev_id_, 1);
@@ -82,11 +177,18 @@ void AudioPlayer::pause(bool paused)
     }
 }
 
-double AudioPlayer::getAudioClock() const
+double AudioPlayer::audibleClock() const
 {
     return state_->audio_clock.get();
 }
 
+int64_t AudioPlayer::queuedFrames() const
+{
+    if (frame_bytes_ <= 0) return 0;
+    double device_frames = std::max(0.0, latency_.deviceQueued()) * sample_rate_;
+    return static_cast<int64_t>(ring_.readable() / frame_bytes_) + static_cast<int64_t>(std::lround(device_frames));
+}
+
 void AudioPlayer::audioCallback(void* userdata, Uint8* stream, int len) 
 {
     auto* player = static_cast<AudioPlayer*>(userdata);
@@ -95,141 +197,274 @@ void AudioPlayer::audioCallback(void* userdata, Uint8* stream, int len)
 
 void AudioPlayer::fillAudioBuffer(Uint8* stream, int len) 
 {
+    if (!callback_thread_configured_) 
+    {
+        state_->threading.applyToCurrentThread(PipelineThread::AUDIO_OUTPUT);
+        callback_thread_configured_ = true;
+    }
+
+    // seek 之后环形缓冲区里的旧数据作废；供给线程在此之后写入的新位置数据保留
+    uint64_t flush_until = flush_until_.exchange(UINT64_MAX);
+    if (flush_until != UINT64_MAX) 
+    {
+        ring_.discardUntil(flush_until);
+        primed_ = false;
+    }
+
+    // 暂停时交付的静音同样进入设备队列，每次回调都要计入
+    double callback_time = Clock::now();
+    double output_latency = latency_.onCallback(callback_time, len);
+    state_->sync.setAudioLatency(output_latency);
+
     // 同步全局暂停状态
     paused_ = state_->paused.load();
 
-    if (paused_) 
+    if (paused_ || state_->quit.load()) 
     {
         memset(stream, 0, len);
         return;
     }
 
-    int len1 = 0;
-    int audio_size = 0;
+    size_t got = ring_.read(stream, len);
+    if (got < static_cast<size_t>(len)) 
+    {
+        // 欠载补静音；开始播放/seek 后数据到来之前，以及播放到结尾时不算欠载
+        memset(stream + got, 0, len - got);
+        bool ended = state_->audio_eof.load() && state_->audio_frame_queue.empty();
+        if (primed_ && !ended) 
+        {
+            state_->stats.audio_underruns.fetch_add(1, std::memory_order_relaxed);
+            state_->stats.audio_underrun_bytes.fetch_add(len - got, std::memory_order_relaxed);
+        }
+    }
+    if (got > 0) 
+    {
+        if (!primed_) 
+        {
+            state_->record_first_audio();   // 打开文件后第一次交给设备的数据
+        }
+        primed_ = true;
+    }
 
-    while (len > 0 && !state_->quit.load()) 
+    // --- 音量调节（S16 为饱和定点，按 CPU 选择 SIMD 实现）---
+    float volume = state_->volume.load();
+    if (volume < 0.001f) volume = 0.0f; // 静音
+    if (volume != 1.0f) 
     {
-        if (audio_buf_index_ >= audio_buf_size_) 
+        if (out_fmt_ == AV_SAMPLE_FMT_FLT) 
         {
-            audio_size = audioProcessFrame(audio_buf_, sizeof(audio_buf_));
-            if (audio_size < 0) 
-            {
-                audio_buf_size_ = 1024;
-                memset(audio_buf_, 0, audio_buf_size_);
-            } 
-            else 
-            {
-                audio_buf_size_ = audio_size;
-            }
-            audio_buf_index_ = 0;
+            gain_.apply(reinterpret_cast<float*>(stream), got / sizeof(float), volume);
+        } 
+        else 
+        {
+            gain_.apply(reinterpret_cast<int16_t*>(stream), got / sizeof(int16_t), volume);
         }
-        
-        len1 = audio_buf_size_ - audio_buf_index_;
-        if (len1 > len) 
+    }
+
+    // 听到的位置 = 已发布时间戳 - 其后尚未被听到的部分（环形缓冲区剩余 + 设备延迟估计）
+    if (bytes_per_sec_ <= 0) return;
+    state_->stats.audio_queued_frames.store(queuedFrames());
+    for (int attempt = 0; attempt < 4; attempt++) 
+    {
+        uint32_t seq = clock_seq_.load();
+        if (seq & 1) continue;     // 供给线程正在发布
+        double pts = clock_pts_.load();
+        uint64_t written = clock_written_.load();
+        if (clock_seq_.load() != seq) continue;
+
+        if (!std::isnan(pts)) 
         {
-            len1 = len;
+            // 供给线程写入的数据可能已经超过发布点，此时 pending 为负
+            int64_t pending = static_cast<int64_t>(written - ring_.readTotal());
+            double pending_seconds = (static_cast<double>(pending) / bytes_per_sec_ + output_latency) * state_->sync.speed();
+            state_->audio_clock.set(pts - pending_seconds, callback_time);
+            state_->sync.syncExternalTo(state_->audio_clock);
         }
+        break;
+    }
+}
 
-        // --- 音量调节 ---
-        float volume = state_->volume.load();
-        if (volume < 0.001f) volume = 0.0f; // 静音
+void AudioPlayer::publishClock(double pts)
+{
+    // 序号为奇数期间回调不读取；两个值一起更新，回调不会读到不匹配的组合
+    uint32_t seq = clock_seq_.load();
+    clock_seq_.store(seq + 1);
+    clock_pts_.store(pts);
+    clock_written_.store(ring_.writeTotal());
+    clock_seq_.store(seq + 2);
+}
 
-        // 假设为 AUDIO_S16SYS 格式
-        int16_t* src = (int16_t*)(audio_buf_ + audio_buf_index_);
-        int16_t* dst = (int16_t*)stream;
-        int samples = len1 / 2; // 2字节每采样
+void AudioPlayer::feederLoop()
+{
+    state_->threading.applyToCurrentThread(PipelineThread::AUDIO_FEED);
+    std::cout << "AudioFeeder: Starting" << std::endl;
 
-        for (int i = 0; i < samples; ++i)
+    while (feeding_ && !state_->quit.load()) 
+    {
+        // seek：解码线程已清空帧队列，丢弃这里残留的数据，并让回调丢弃当前写入位置之前的旧数据
+        uint64_t serial = state_->audio_flush_serial.load();
+        if (serial != flush_serial_) 
         {
-            dst[i] = (int16_t)(src[i] * volume);
+            flush_serial_ = serial;
+            stretcher_.reset();
+            next_pts_ = NAN;
+            flush_until_ = ring_.writeTotal();
+            publishClock(NAN);
+        }
+
+        const uint8_t* data = nullptr;
+        int size = audioProcessFrame(&data);
+        if (size <= 0) 
+        {
+            continue; // 超时、无效帧，或变速时积累不足一个窗
+        }
+
+        if (writeToRing(data, size)) 
+        {
+            // 已写入数据的末尾对应的媒体时间（伸缩器里尚未输出的输入不计）
+            double end_pts = next_pts_;
+            if (stretching_) 
+            {
+                end_pts -= stretcher_.bufferedSeconds();
+            }
+            publishClock(end_pts);
         }
+    }
+
+    std::cout << "AudioFeeder: Exiting" << std::endl;
+}
+
+bool AudioPlayer::writeToRing(const uint8_t* data, int size)
+{
+    while (size > 0) 
+    {
+        size_t written = ring_.write(data, size);
+        data += written;
+        size -= static_cast<int>(written);
+        if (size == 0) break;
 
-        len -= len1;
-        stream += len1;
-        audio_buf_index_ += len1;
+        // 环形缓冲区满（设备按实时速度消耗，暂停时不消耗）：短暂休眠后重试
+        if (!feeding_ || state_->quit.load() || state_->audio_flush_serial.load() != flush_serial_) 
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(AUDIO_FEEDER_POLL_MS));
     }
+    return true;
 }
 
-int AudioPlayer::audioProcessFrame(uint8_t* audio_buf, int buf_size) 
+int AudioPlayer::audioProcessFrame(const uint8_t** out_data) 
 {
     if (state_->quit.load()) 
     {
         return -1;
     }
 
+    // 上一帧的数据已经写入环形缓冲区
+    releaseHeldFrame();
+
+    // 供给线程可以阻塞等待帧
     AVFrame* frame = nullptr;
     if (!state_->audio_frame_queue.pop(frame, state_->quit, 10)) 
     {
         return -1; // 超时或退出
     }
     
-    // 添加安全检查 - 确保frame和音频上下文有效
-    if (!frame || !state_->audio_ctx || state_->audio_ctx->sample_rate <= 0) {
-        if (frame) av_frame_free(&frame);
-        memset(audio_buf, 0, buf_size);
-        return buf_size; // 返回静音
-    }
-
-    double pts = NAN;
-    if (frame->pts != AV_NOPTS_VALUE) 
+    // 添加安全检查 - 确保frame有效（帧参数随帧携带，播放列表切换条目后解码器上下文已经换掉）
+    if (!frame || frame->sample_rate <= 0 || frame->nb_samples <= 0) 
     {
-        pts = frame->pts * av_q2d(state_->audio_ctx->time_base);
+        state_->audio_frame_pool.release(frame);
+        return 0;
     }
 
-    // 检查帧是否有有效的样本数
-    if (frame->nb_samples <= 0) 
+    // 播放列表切换到采样率/格式/声道不同的条目：设备不动，只重建重采样器的输入端
+    if (resampler_.inputChanged(frame)) 
     {
-        av_frame_free(&frame);
-        memset(audio_buf, 0, buf_size);
-        return buf_size; // 返回静音
+        if (!resampler_.reinitForFrame(frame)) 
+        {
+            std::cerr << "AudioPlayer: Cannot reconfigure resampler for new source format" << std::endl;
+            state_->audio_frame_pool.release(frame);
+            return 0;
+        }
+        std::cout << "AudioPlayer: Source changed to " << frame->sample_rate << " Hz, " << frame->channels << " ch, "
+                  << av_get_sample_fmt_name(static_cast<AVSampleFormat>(frame->format))
+                  << " (" << AudioResampler::modeName(resampler_.mode()) << ")" << std::endl;
     }
 
-    // 保存样本数，因为frame将在重采样后被释放
+    // 计算音频持续时间，缺少 pts 的帧按上一帧末尾外推（pts 已是微秒时间轴）
     int nb_samples = frame->nb_samples;
+    double duration = (double)nb_samples / (double)frame->sample_rate;
+    if (frame->pts != AV_NOPTS_VALUE) 
+    {
+        next_pts_ = frame->pts / (double)AV_TIME_BASE + duration;
+    } 
+    else if (!std::isnan(next_pts_)) 
+    {
+        next_pts_ += duration;
+    }
     
-    uint8_t* resampled_buf = nullptr;
-    int data_size = resampler_.resample(frame, &resampled_buf);
-    av_frame_free(&frame); // 尽早释放 frame
-
-    if (data_size <= 0) 
+    // 音频不是主时钟时，通过重采样补偿逐步追上主时钟；不需要补偿的帧也要告知，重采样器据此恢复直通
+    int wanted_samples = state_->sync.audioWantedSamples(nb_samples, frame->sample_rate);
+    resampler_.setCompensation(wanted_samples - nb_samples, wanted_samples);
+    
+    const uint8_t* resampled = nullptr;
+    int data_size = resampler_.resample(frame, &resampled);
+    if (resampler_.mode() == AudioResampler::Mode::COPY) 
     {
-        if (resampled_buf) 
-        {
-            av_freep(&resampled_buf);
-        }
-        // 返回静音
-        memset(audio_buf, 0, buf_size);
-        return buf_size;
+        held_frame_ = frame;    // 直通时输出就是帧数据，写入环形缓冲区后才能归还
+    } 
+    else 
+    {
+        state_->audio_frame_pool.release(frame); // 尽早归还 frame
     }
 
-    if (data_size > buf_size) 
+    if (data_size <= 0) 
     {
-        // 日志警告，但尽量拷贝有效部分
-        data_size = buf_size;
+        return 0;
     }
 
-    memcpy(audio_buf, resampled_buf, data_size);
-    av_freep(&resampled_buf);
-
-    // 更新时间戳和统计信息
-    if (!std::isnan(pts)) 
+    double speed = state_->sync.speed();
+    if (std::fabs(speed - 1.0) > 0.001 && stretcher_.isConfigured() && frame_bytes_ > 0) 
     {
-        // 计算音频持续时间 - 使用更精确的计算
-        double duration = 0.0;
-        if (state_->audio_ctx->sample_rate > 0) 
+        // 变速：时间伸缩后输出，音高不变；积累不足一个窗时这次没有输出
+        stretcher_.setSpeed(speed);
+        int max_frames = static_cast<int>(sizeof(audio_buf_)) / frame_bytes_;
+        if (out_fmt_ == AV_SAMPLE_FMT_FLT) 
         {
-            duration = (double)nb_samples / (double)state_->audio_ctx->sample_rate;
+            stretcher_.push(reinterpret_cast<const float*>(resampled), data_size / frame_bytes_);
+            data_size = stretcher_.pull(reinterpret_cast<float*>(audio_buf_), max_frames) * frame_bytes_;
+        } 
+        else 
+        {
+            stretcher_.push(reinterpret_cast<const int16_t*>(resampled), data_size / frame_bytes_);
+            data_size = stretcher_.pull(reinterpret_cast<int16_t*>(audio_buf_), max_frames) * frame_bytes_;
         }
-        
-        // 更新音频时钟 - 使用当前播放位置的时间戳
-        double current_pts = pts + duration;
-        state_->audio_clock.set(current_pts);
-        
-        // 更新统计信息
-        state_->stats.audio_bytes.fetch_add(data_size);
-        
-        // std::cout << "Audio PTS: " << current_pts << "s" << std::endl;
+        *out_data = audio_buf_;
+        stretching_ = true;
+    } 
+    else 
+    {
+        // 回到 1x 时丢弃伸缩器里残留的几十毫秒
+        if (stretching_) 
+        {
+            stretcher_.reset();
+            stretching_ = false;
+        }
+        // 1x 时直接从重采样器的输出（或直通时的帧数据）写入环形缓冲区，不再经过暂存区
+        *out_data = resampled;
     }
+
+    // 更新统计信息
+    state_->stats.audio_bytes.fetch_add(data_size);
     
     return data_size;
-}
\ No newline at end of file
+}
+
+void AudioPlayer::releaseHeldFrame()
+{
+    if (held_frame_) 
+    {
+        state_->audio_frame_pool.release(held_frame_);
+        held_frame_ = nullptr;
+    }
+}
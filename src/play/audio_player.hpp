@@ -2,10 +2,25 @@
 
 #include <SDL2/SDL.h>
 #include <atomic>
+#include <thread>
 #include "../ffmpeg_utils/ffmpeg_headers.hpp"
 #include "../player_core/player_state.hpp"
+#include "../player_core/utils/pcm_ring_buffer.hpp"
 #include "audio_resampler.hpp"
+#include "audio_gain.hpp"
+#include "audio_latency.hpp"
+#include "time_stretch.hpp"
 
+/**
+ * 音频输出。
+ *
+ * 供给线程从帧队列取帧，完成同步补偿、重采样和变速后写入无锁 PCM 环形缓冲区；
+ * SDL 音频回调只从环形缓冲区拷贝数据并调节音量（饱和的 SIMD 定点内核），不加锁、不分配内存、不等待。
+ * 环形缓冲区读空时补静音并计入欠载统计。
+ *
+ * 设备格式按源协商：浮点/高位深源输出 F32，其余 S16，保留源声道数；
+ * 格式、采样率、声道布局都与解码输出一致时不经过 swr。
+ */
 class AudioPlayer {
 public:
     AudioPlayer(PlayerState* state);
@@ -16,25 +31,67 @@ public:
     void stop();
     void pause(bool paused);
     
-    double getAudioClock() const;
+    // 当前听到的媒体时间：已扣除环形缓冲区、设备队列和额外输出延迟（即 audio_clock）
+    double audibleClock() const;
+    // 已解码但尚未被听到的采样帧数（环形缓冲区 + 设备队列估计）
+    int64_t queuedFrames() const;
+    // 输出延迟估计（秒，含 SDL2_PLAYER_AUDIO_LATENCY_MS）
+    double outputLatency() const { return latency_.latency(); }
     
 private:
     static void audioCallback(void* userdata, Uint8* stream, int len);
     void fillAudioBuffer(Uint8* stream, int len);
-    int audioProcessFrame(uint8_t* audio_buf, int buf_size);
+    
+    // 供给线程
+    void feederLoop();
+    // 返回本帧输出的字节数，*out_data 指向重采样器或伸缩器的输出，在处理下一帧前有效
+    int audioProcessFrame(const uint8_t** out_data);
+    bool writeToRing(const uint8_t* data, int size);
+    void releaseHeldFrame();
+    void publishClock(double pts);
     
     PlayerState* state_;
     SDL_AudioDeviceID dev_id_ = 0;
     AudioResampler resampler_;
     
-    // 音频缓冲区管理（类似tutorial04）
-    uint8_t audio_buf_[(MAX_AUDIO_FRAME_SIZE * 3) / 2];
-    unsigned int audio_buf_size_ = 0;
-    unsigned int audio_buf_index_ = 0;
+    // 供给线程的暂存缓冲区（一帧变速后的输出）
+    alignas(16) uint8_t audio_buf_[(MAX_AUDIO_FRAME_SIZE * 3) / 2];
+    AVFrame* held_frame_ = nullptr;         // 直通模式下正在写入环形缓冲区的帧
+    
+    // 供给线程 → 回调
+    PcmRingBuffer ring_;
+    std::thread feeder_thread_;
+    std::atomic<bool> feeding_{false};
+    // seek 时供给线程记下的写入位置，回调只丢弃此前的旧数据；UINT64_MAX 表示没有待处理的清空
+    std::atomic<uint64_t> flush_until_{UINT64_MAX};
+    uint64_t flush_serial_ = 0;             // 供给线程已处理的 seek 序号
+    
+    // 音频时钟：环形缓冲区写到 clock_written_ 字节时对应的媒体时间，以序号锁（seqlock）整体发布
+    std::atomic<uint32_t> clock_seq_{0};
+    std::atomic<double> clock_pts_{NAN};
+    std::atomic<uint64_t> clock_written_{0};
+    double next_pts_ = NAN;                 // 供给线程：下一帧的起始时间（帧缺少 pts 时外推）
     
-    // 音频时钟
-    std::atomic<double> audio_clock_{0};
+    // 设备参数，用于从缓冲区内未播放的数据量反推实际播放位置
+    int sample_rate_ = 0;
+    int bytes_per_sec_ = 0;
+    int hw_buf_size_ = 0;
+    int frame_bytes_ = 0;       // 每个采样帧（所有声道）的字节数
+    AVSampleFormat out_fmt_ = AV_SAMPLE_FMT_S16;    // 设备格式：AV_SAMPLE_FMT_S16 或 AV_SAMPLE_FMT_FLT（交错）
+    
+    // 非 1x 速度时对重采样后的数据做时间伸缩（只在供给线程访问）
+    TimeStretcher stretcher_;
+    bool stretching_ = false;
+    
+    // 回调中的音量调节
+    AudioGain gain_;
+    // 设备延迟估计（回调线程更新）
+    AudioLatencyEstimator latency_;
     
     // 暂停状态
     std::atomic<bool> paused_{false};
-};
\ No newline at end of file
+    
+    // 以下只在回调线程访问
+    bool callback_thread_configured_ = false;   // 回调线程由 SDL 创建，第一次回调时才能对它应用线程策略
+    bool primed_ = false;                       // 开始播放（或 seek）后是否已经收到过数据，之前的空缺不算欠载
+};
@@ -1,5 +1,7 @@
 #include "audio_resampler.hpp"
 #include <iostream>
+#include <climits>
+#include "../player_core/utils/player_constants.hpp"
 
 extern "C" {
     #include <libavformat/avformat.h>
@@ -7,6 +9,23 @@ extern "C" {
     #include <libswresample/swresample.h>
 }
 
+namespace {
+
+// 平面 -> 交错，按样本字节宽度拷贝
+template <typename T>
+void interleave(const uint8_t* const* planes, int channels, int frames, uint8_t* out)
+{
+    T* dst = reinterpret_cast<T*>(out);
+    for (int c = 0; c < channels; c++) {
+        const T* src = reinterpret_cast<const T*>(planes[c]);
+        for (int i = 0; i < frames; i++) {
+            dst[i * channels + c] = src[i];
+        }
+    }
+}
+
+} // namespace
+
 AudioResampler::AudioResampler() = default;
 
 AudioResampler::~AudioResampler() 
@@ -14,27 +33,84 @@ AudioResampler::~AudioResampler()
     close();
 }
 
-bool AudioResampler::init(AVCodecContext* codec_ctx, AVSampleFormat out_fmt, int out_sample_rate, int out_channels) 
+bool AudioResampler::init(AVCodecContext* codec_ctx, AVSampleFormat out_fmt, int out_sample_rate, int64_t out_ch_layout) 
+{
+    // 使用老版 API，直接用 channel_layout
+    return initInput(codec_ctx->sample_fmt, codec_ctx->sample_rate, codec_ctx->channel_layout, codec_ctx->channels,
+                     out_fmt, out_sample_rate, out_ch_layout);
+}
+
+bool AudioResampler::inputChanged(const AVFrame* frame) const
+{
+    if (!frame) return false;
+    bool layout_changed = frame->channel_layout != 0 && static_cast<int64_t>(frame->channel_layout) != in_ch_layout_;
+    return frame->format != in_fmt_ || frame->sample_rate != in_sample_rate_ ||
+           frame->channels != in_channels_ || layout_changed;
+}
+
+bool AudioResampler::reinitForFrame(const AVFrame* frame)
+{
+    if (!frame) return false;
+    return initInput(static_cast<AVSampleFormat>(frame->format), frame->sample_rate, frame->channel_layout,
+                     frame->channels, out_fmt_, out_sample_rate_, out_ch_layout_);
+}
+
+bool AudioResampler::initInput(AVSampleFormat in_fmt, int in_sample_rate, int64_t in_ch_layout, int in_channels,
+                               AVSampleFormat out_fmt, int out_sample_rate, int64_t out_ch_layout)
 {
     close();
 
+    if (av_sample_fmt_is_planar(out_fmt)) 
+    {
+        std::cerr << "AudioResampler: Planar output format is not supported" << std::endl;
+        return false;
+    }
+
     out_fmt_ = out_fmt;
     out_sample_rate_ = out_sample_rate;
-    out_channels_ = out_channels;
+    out_ch_layout_ = out_ch_layout;
+    out_channels_ = av_get_channel_layout_nb_channels(out_ch_layout);
+    in_fmt_ = in_fmt;
+    in_sample_rate_ = in_sample_rate;
+    in_channels_ = in_channels;
 
-    // 使用老版 API，直接用 channel_layout
-    int64_t in_ch_layout = codec_ctx->channel_layout;
-    if (in_ch_layout == 0) 
+    in_ch_layout_ = in_ch_layout;
+    idle_frames_ = 0;
+    restore_pending_ = false;
+    switch_logged_ = false;
+    bool layout_known = in_ch_layout_ != 0;
+    if (!layout_known) 
     {
         // 如果未指定，使用默认布局
-        in_ch_layout = av_get_default_channel_layout(codec_ctx->channels);
+        in_ch_layout_ = av_get_default_channel_layout(in_channels);
     }
-    int64_t out_ch_layout = av_get_default_channel_layout(out_channels);
 
+    // 未标注布局时认为解码器的声道顺序就是设备顺序
+    bool same_layout = layout_known ? in_ch_layout_ == out_ch_layout_ : in_channels == out_channels_;
+    if (same_layout && in_sample_rate_ == out_sample_rate_ && out_channels_ > 0) 
+    {
+        if (in_fmt_ == out_fmt_) 
+        {
+            mode_ = passthrough_mode_ = Mode::COPY;
+            return true;
+        }
+        if (av_sample_fmt_is_planar(in_fmt_) && av_get_packed_sample_fmt(in_fmt_) == out_fmt_) 
+        {
+            mode_ = passthrough_mode_ = Mode::INTERLEAVE;
+            return true;
+        }
+    }
+
+    mode_ = passthrough_mode_ = Mode::CONVERT;
+    return openSwr();
+}
+
+bool AudioResampler::openSwr()
+{
     swr_ctx_ = swr_alloc_set_opts(
         nullptr,
-        out_ch_layout, out_fmt, out_sample_rate,
-        in_ch_layout, codec_ctx->sample_fmt, codec_ctx->sample_rate,
+        out_ch_layout_, out_fmt_, out_sample_rate_,
+        in_ch_layout_, in_fmt_, in_sample_rate_,
         0, nullptr
     );
     if (!swr_ctx_ || swr_init(swr_ctx_) < 0) 
@@ -45,9 +121,51 @@ bool AudioResampler::init(AVCodecContext* codec_ctx, AVSampleFormat out_fmt, int
     return true;
 }
 
-int AudioResampler::resample(AVFrame* frame, uint8_t** out_buf) 
+const char* AudioResampler::modeName(Mode mode)
+{
+    switch (mode) {
+        case Mode::COPY:       return "passthrough";
+        case Mode::INTERLEAVE: return "interleave";
+        default:               return "swr";
+    }
+}
+
+int AudioResampler::resample(AVFrame* frame, const uint8_t** out_data) 
 {
-    if (!swr_ctx_ || !frame) return -1;
+    if (!frame) return -1;
+    if (restore_pending_) return restorePassthrough(frame, out_data);
+
+    if (mode_ != Mode::CONVERT) 
+    {
+        // 直通模式不做任何转换，帧参数必须与初始化时一致
+        if (frame->format != in_fmt_ || frame->sample_rate != in_sample_rate_ || frame->channels != out_channels_) 
+        {
+            std::cerr << "AudioResampler: Frame format changed, dropping frame" << std::endl;
+            return -1;
+        }
+        int bytes_per_sample = av_get_bytes_per_sample(out_fmt_);
+        int data_size = frame->nb_samples * out_channels_ * bytes_per_sample;
+        if (mode_ == Mode::COPY) 
+        {
+            *out_data = frame->data[0];
+            return data_size;
+        }
+
+        if (out_buf_.size() < static_cast<size_t>(data_size)) 
+        {
+            out_buf_.resize(data_size);
+        }
+        switch (bytes_per_sample) {
+            case 1: interleave<uint8_t>(frame->extended_data, out_channels_, frame->nb_samples, out_buf_.data()); break;
+            case 2: interleave<uint16_t>(frame->extended_data, out_channels_, frame->nb_samples, out_buf_.data()); break;
+            case 4: interleave<uint32_t>(frame->extended_data, out_channels_, frame->nb_samples, out_buf_.data()); break;
+            default: interleave<uint64_t>(frame->extended_data, out_channels_, frame->nb_samples, out_buf_.data()); break;
+        }
+        *out_data = out_buf_.data();
+        return data_size;
+    }
+
+    if (!swr_ctx_) return -1;
 
     // 计算输出样本数
     int64_t delay = swr_get_delay(swr_ctx_, frame->sample_rate);
@@ -55,45 +173,126 @@ int AudioResampler::resample(AVFrame* frame, uint8_t** out_buf)
                                         out_sample_rate_,
                                         frame->sample_rate,
                                         AV_ROUND_UP);
+    // 同步补偿可能让输出比按采样率换算的多出一部分
+    out_samples += out_samples * SYNC_SAMPLE_CORRECTION_PERCENT_MAX / 100;
 
-    if (out_samples <= 0) 
+    if (out_samples <= 0 || out_samples > INT_MAX / 2) 
     {
         std::cerr << "Invalid output samples: " << out_samples << std::endl;
         return -1;
     }
 
-    int out_linesize = 0;
-    int ret = av_samples_alloc(out_buf, &out_linesize, out_channels_, 
-                             out_samples, out_fmt_, 0);
-    if (ret < 0) 
+    int needed = av_samples_get_buffer_size(nullptr, out_channels_, static_cast<int>(out_samples), out_fmt_, 1);
+    if (needed < 0) 
     {
-        std::cerr << "Failed to allocate samples: " << ret << std::endl;
+        std::cerr << "Failed to get buffer size: " << needed << std::endl;
         return -1;
     }
+    // 只增不减，帧长稳定后不再分配
+    if (out_buf_.size() < static_cast<size_t>(needed)) 
+    {
+        out_buf_.resize(needed);
+    }
 
     // 执行重采样
+    uint8_t* out_planes[1] = {out_buf_.data()};
     int converted_samples = swr_convert(swr_ctx_, 
-                                       out_buf, out_samples,
-                                       (const uint8_t**)frame->data, frame->nb_samples);
+                                       out_planes, static_cast<int>(out_samples),
+                                       (const uint8_t**)frame->extended_data, frame->nb_samples);
     
     if (converted_samples < 0) 
     {
         std::cerr << "swr_convert failed: " << converted_samples << std::endl;
-        av_freep(out_buf);
         return -1;
     }
 
-    // 计算实际数据大小
-    int data_size = av_samples_get_buffer_size(&out_linesize, out_channels_, 
-                                             converted_samples, out_fmt_, 1);
-    if (data_size < 0) 
+    *out_data = out_buf_.data();
+    return converted_samples * out_channels_ * av_get_bytes_per_sample(out_fmt_);
+}
+
+bool AudioResampler::setCompensation(int in_delta, int in_distance)
+{
+    if (in_distance <= 0 || in_sample_rate_ <= 0) return false;
+
+    if (in_delta == 0) 
+    {
+        // 只是为补偿才切到 swr 的，持续一段时间不需要补偿后恢复直通
+        if (mode_ == Mode::CONVERT && passthrough_mode_ != Mode::CONVERT &&
+            ++idle_frames_ >= SYNC_PASSTHROUGH_RESTORE_FRAMES) 
+        {
+            restore_pending_ = true;
+        }
+        return true;
+    }
+    idle_frames_ = 0;
+    restore_pending_ = false;
+
+    if (mode_ != Mode::CONVERT) 
     {
-        std::cerr << "Failed to get buffer size: " << data_size << std::endl;
-        av_freep(out_buf);
-        return -1;
+        // swr 创建成功后才切换模式，失败时继续直通输出
+        if (!openSwr()) 
+        {
+            std::cerr << "AudioResampler: Cannot create swr context" << std::endl;
+            return false;
+        }
+        if (!switch_logged_) 
+        {
+            std::cout << "AudioResampler: Switching from " << modeName(mode_) << " to swr for sync compensation" << std::endl;
+        }
+        mode_ = Mode::CONVERT;
+    }
+    if (!swr_ctx_) return false;
+
+    // swr_set_compensation 的参数以输出采样率计
+    int delta = static_cast<int>(static_cast<int64_t>(in_delta) * out_sample_rate_ / in_sample_rate_);
+    int distance = static_cast<int>(static_cast<int64_t>(in_distance) * out_sample_rate_ / in_sample_rate_);
+    if (swr_set_compensation(swr_ctx_, delta, distance) < 0) 
+    {
+        std::cerr << "swr_set_compensation failed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int AudioResampler::restorePassthrough(AVFrame* frame, const uint8_t** out_data)
+{
+    restore_pending_ = false;
+    idle_frames_ = 0;
+
+    // 补偿滤波在 swr 中积压的少量样本
+    std::vector<uint8_t> pending;
+    int bytes_per_frame = out_channels_ * av_get_bytes_per_sample(out_fmt_);
+    if (swr_ctx_ && bytes_per_frame > 0) 
+    {
+        int capacity = static_cast<int>(swr_get_delay(swr_ctx_, out_sample_rate_)) + 64;
+        pending.resize(static_cast<size_t>(capacity) * bytes_per_frame);
+        uint8_t* out_planes[1] = {pending.data()};
+        int drained = swr_convert(swr_ctx_, out_planes, capacity, nullptr, 0);
+        pending.resize(drained > 0 ? static_cast<size_t>(drained) * bytes_per_frame : 0);
+        swr_free(&swr_ctx_);
+        swr_ctx_ = nullptr;
+    }
+
+    if (!switch_logged_) 
+    {
+        std::cout << "AudioResampler: Sync compensation finished, back to " << modeName(passthrough_mode_) << std::endl;
+        switch_logged_ = true;
+    }
+    mode_ = passthrough_mode_;
+
+    const uint8_t* data = nullptr;
+    int size = resample(frame, &data);
+    if (size < 0 || pending.empty()) 
+    {
+        *out_data = data;
+        return size;
     }
 
-    return data_size;
+    // 积压样本在前，本帧在后；COPY 模式下调用方照常保留帧，不影响结果
+    pending.insert(pending.end(), data, data + size);
+    out_buf_.swap(pending);
+    *out_data = out_buf_.data();
+    return static_cast<int>(out_buf_.size());
 }
 
 void AudioResampler::close() 
@@ -103,4 +302,6 @@ void AudioResampler::close()
         swr_free(&swr_ctx_);
         swr_ctx_ = nullptr;
     }
+    out_buf_.clear();
+    out_buf_.shrink_to_fit();
 }
\ No newline at end of file
@@ -2,21 +2,66 @@
 
 #pragma once
 
+#include <vector>
 #include "../ffmpeg_utils/ffmpeg_headers.hpp"
 
+/**
+ * 解码输出到设备格式的转换。
+ *
+ * 采样率和声道布局一致时不经过 swr：格式也一致直接引用帧数据（COPY），
+ * 只是平面/交错不同时逐声道交织（INTERLEAVE）；其余情况或需要同步补偿时使用 swr（CONVERT）。
+ */
 class AudioResampler 
 {
 public:
+    enum class Mode
+    {
+        COPY,
+        INTERLEAVE,
+        CONVERT
+    };
+
     AudioResampler();
     ~AudioResampler();
     
-    bool init(AVCodecContext* codec_ctx, AVSampleFormat out_fmt, int out_sample_rate, int out_channels);
-    int resample(AVFrame* frame, uint8_t** out_buf);
+    // out_fmt 必须是交错格式，out_ch_layout 为输出声道布局
+    bool init(AVCodecContext* codec_ctx, AVSampleFormat out_fmt, int out_sample_rate, int64_t out_ch_layout);
+    // 帧的格式、采样率或声道与当前输入不同（播放列表切换到参数不同的条目）
+    bool inputChanged(const AVFrame* frame) const;
+    // 按帧的参数重新初始化输入端，输出格式保持不变
+    bool reinitForFrame(const AVFrame* frame);
+    // 输出为交错格式，返回字节数。COPY 模式下 *out_data 指向帧本身的数据，调用方需在使用完之前保留帧；
+    // 其余模式写入内部缓冲区（按需增长、重复使用），*out_data 在下次 resample/close 前有效
+    int resample(AVFrame* frame, const uint8_t** out_data);
+    // 在接下来 in_distance 个输入样本内多输出（正）或少输出（负）in_delta 个样本，用于音画同步微调，每帧调用一次。
+    // 只有 swr 支持补偿，直通模式下需要补偿时切换到 CONVERT（此时 swr 内部没有积压数据，切换无缝）；
+    // 之后连续 SYNC_PASSTHROUGH_RESTORE_FRAMES 帧 in_delta 为 0 时释放 swr，恢复协商出的直通模式
+    bool setCompensation(int in_delta, int in_distance);
     void close();
+
+    Mode mode() const { return mode_; }
+    static const char* modeName(Mode mode);
     
 private:
+    bool initInput(AVSampleFormat in_fmt, int in_sample_rate, int64_t in_ch_layout, int in_channels,
+                   AVSampleFormat out_fmt, int out_sample_rate, int64_t out_ch_layout);
+    bool openSwr();
+    // 补偿结束后回到直通：先输出 swr 中积压的样本，再接上本帧的直通数据
+    int restorePassthrough(AVFrame* frame, const uint8_t** out_data);
+
     SwrContext* swr_ctx_ = nullptr;
+    Mode mode_ = Mode::CONVERT;
+    Mode passthrough_mode_ = Mode::CONVERT;   // initInput 协商出的模式，补偿结束后恢复
+    int idle_frames_ = 0;                     // 为补偿切到 swr 后连续不需要补偿的帧数
+    bool restore_pending_ = false;            // 下一次 resample 时恢复直通
+    bool switch_logged_ = false;              // 模式切换每个流只打印一次
     int out_channels_ = 0;
     int out_sample_rate_ = 0;
+    int64_t out_ch_layout_ = 0;
     AVSampleFormat out_fmt_ = AV_SAMPLE_FMT_NONE;
-};
\ No newline at end of file
+    int in_sample_rate_ = 0;
+    int64_t in_ch_layout_ = 0;
+    AVSampleFormat in_fmt_ = AV_SAMPLE_FMT_NONE;
+    int in_channels_ = 0;
+    std::vector<uint8_t> out_buf_;
+};
@@ -6,6 +6,9 @@ extern "C" {
     #include "libavutil/time.h"
 }
 
+/**
+ * 播放时钟：记录最近一次更新的 pts 和时刻，读取时按流逝时间乘以速度外推；暂停时停在暂停时的值。
+ */
 class Clock {
 public:
     Clock() = default;
@@ -18,48 +21,68 @@ public:
     
     void set(double pts) 
     {
-        set(pts, currentTime());
+        set(pts, now());
     }
     
     double get() const 
     {
-        double time = currentTime();
-        return pts_.load() + (time - last_updated_.load());
+        if (paused_.load()) {
+            return pts_.load();
+        }
+        double time = now();
+        return pts_.load() + (time - last_updated_.load()) * speed_.load();
     }
     
     double pts() const { return pts_.load(); }
     double lastUpdated() const { return last_updated_.load(); }
     
+    // 改变速度前先按旧速度结算当前值，之后的外推按新速度进行
+    void setSpeed(double speed) 
+    {
+        set(get());
+        speed_.store(speed);
+    }
+    double speed() const { return speed_.load(); }
+    
+    void setPaused(bool paused) 
+    {
+        if (paused_.load() == paused) return;
+        set(get());
+        paused_.store(paused);
+    }
+    bool paused() const { return paused_.load(); }
+    
     void setPrePts(double pre_pts) { pre_pts_.store(pre_pts); }
     void setPreFrameDelay(double delay) { pre_frame_delay_.store(delay); }
     
     double getPrePts() const { return pre_pts_.load(); }
     double getPreFrameDelay() const { return pre_frame_delay_.load(); }
 
-    // 新增：重置时钟 - 用于seek和重新加载文件
+    // 新增：重置时钟 - 用于seek和重新加载文件（速度保持不变）
     void reset() {
         pts_.store(0.0);
-        last_updated_.store(currentTime());
+        last_updated_.store(now());
         pre_pts_.store(0.0);
         pre_frame_delay_.store(0.0);
+        paused_.store(false);
     }
     
     // 新增：暂停时钟 - 用于暂停播放
     void pause() {
-        // 记录当前的PTS，停止时间更新
-        double current_pts = get();
-        set(current_pts, currentTime());
+        setPaused(true);
     }
 
-private:
-    static double currentTime() 
+    // 时钟使用的时间基准（系统时间，单位秒）
+    static double now() 
     {
-        // 使用系统时间，单位秒
         return static_cast<double>(av_gettime()) / 1000000.0;
     }
-    
+
+private:
     std::atomic<double> pts_{0};          // 当前时钟值（秒）
     std::atomic<double> last_updated_{0}; // 最后更新时间（秒）
+    std::atomic<double> speed_{1.0};      // 播放速度
+    std::atomic<bool> paused_{false};
     std::atomic<double> pre_pts_{0};      // 上一帧的PTS
     std::atomic<double> pre_frame_delay_{0}; // 上一帧的延迟
 };
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "frame_scheduler.hpp"
+#include <thread>
+#include <algorithm>
+#include <iostream>
+
+FrameScheduler::FrameScheduler(PlayerState* state)
+    : state_(state)
+{
+    publishStats();
+}
+
+void FrameScheduler::setRefreshRate(double hz)
+{
+    if (hz <= 0.0) hz = PRESENT_DEFAULT_REFRESH_HZ;
+    double period = 1.0 / hz;
+    if (std::fabs(period - nominal_period_) < 1e-6) return;
+
+    std::cout << "FrameScheduler: Display refresh " << hz << " Hz" << std::endl;
+    nominal_period_ = period;
+    period_ = period;
+    publishStats();
+}
+
+void FrameScheduler::setVsyncEnabled(bool enabled)
+{
+    vsync_enabled_ = enabled;
+    vsync_locked_ = enabled;
+    fast_swaps_ = 0;
+    publishStats();
+}
+
+double FrameScheduler::nextVsync(double now) const
+{
+    // 交换在 last_present_ 之后的第一个 vblank 完成；主循环慢于一个周期时顺延到 now 之后
+    double vsync = last_present_ + period_;
+    if (vsync < now) {
+        vsync += std::ceil((now - vsync) / period_) * period_;
+    }
+    return vsync;
+}
+
+FrameScheduler::Selection FrameScheduler::selectFrame()
+{
+    Selection selection;
+    double now = Clock::now();
+    selection.vsync_time = nextVsync(now);
+
+    // 主时钟外推到上屏时刻；半个刷新周期（按播放速度换算成媒体时间）内到期的帧在这个 vsync 显示
+    double speed = state_->sync.speed();
+    double media_at_vsync = state_->get_master_clock() + (selection.vsync_time - now) * speed;
+    double half_period = 0.5 * period_ * speed;
+    bool seeking = state_->seeking.load();
+    bool video_master = state_->sync.master() == SyncMaster::VIDEO;
+
+    AVFrame* frame = nullptr;
+    while (state_->video_frame_queue.front(frame) && frame)
+    {
+        double pts = state_->get_video_frame_pts(frame);
+        double diff = pts - media_at_vsync;
+        bool comparable = !std::isnan(diff) && !seeking;
+        // 打开文件后的第一帧（海报帧）解码出来就显示，不等主时钟启动
+        bool poster = !shown_any_;
+        // 视频/外部时钟为主时钟时，时间轴跳变（起始 pts 偏移、不连续流）直接显示并让时钟跟上
+        bool jump = comparable && state_->sync.master() != SyncMaster::AUDIO
+                    && std::fabs(diff) >= SYNC_NOSYNC_THRESHOLD;
+
+        if (comparable && !jump && !poster && diff > half_period) {
+            // 未到期：留在队列里等后面的 vsync
+            break;
+        }
+
+        state_->video_frame_queue.try_pop(frame);
+        if (selection.frame) {
+            // 同一个 vsync 内有更新的帧到期，前一帧已经来不及显示
+            state_->video_frame_pool.release(selection.frame);
+            state_->metrics.add(MetricCounter::FRAMES_DROPPED_LATE);
+        }
+        selection.frame = frame;
+        selection.pts = pts;
+        selection.drift = comparable && !poster ? diff : NAN;
+
+        if (!comparable || jump || poster) {
+            // 无法与主时钟比较的帧每个 vsync 只取一帧
+            selection.resync = true;
+            break;
+        }
+    }
+
+    if (selection.frame) {
+        // 以视频为主时钟时时钟自由运行，只在跳变或落后时重新对齐，避免按 vsync 量化后累积误差
+        if (video_master && !std::isnan(selection.drift) && selection.drift < -half_period) {
+            selection.resync = true;
+        }
+        shown_any_ = true;
+    } else if (shown_any_ && !state_->paused.load()) {
+        state_->metrics.add(MetricCounter::FRAMES_REPEATED);
+    }
+    return selection;
+}
+
+void FrameScheduler::framePresented(double swap_start, double swap_end)
+{
+    double interval = swap_end - last_present_;
+    double swap_time = swap_end - swap_start;
+    bool first = last_present_ <= 0.0;
+    last_present_ = swap_end;
+    if (first || !vsync_enabled_) return;
+
+    if (vsync_locked_) {
+        // 交换接连很快返回说明没有等待 vblank（窗口被遮挡、驱动强制关闭垂直同步）
+        if (interval < 0.5 * nominal_period_) {
+            if (++fast_swaps_ >= PRESENT_FAST_SWAP_LIMIT) {
+                vsync_locked_ = false;
+                fast_swaps_ = 0;
+                std::cout << "FrameScheduler: Swap is not waiting for vblank, pacing in software" << std::endl;
+                publishStats();
+            }
+        } else {
+            fast_swaps_ = 0;
+        }
+
+        if (interval > 1.5 * period_) {
+            state_->metrics.add(MetricCounter::VSYNC_MISSED);
+        } else if (std::fabs(interval - nominal_period_) < 0.25 * nominal_period_) {
+            // 跟踪实际刷新周期（59.94Hz 之类与标称值的细微差别）
+            period_ += (interval - period_) * 0.05;
+            state_->stats.display_refresh_hz.store(1.0 / period_);
+        }
+    } else if (swap_time > 0.5 * period_) {
+        // 自行定拍时交换又开始阻塞，恢复以 vblank 为准
+        vsync_locked_ = true;
+        std::cout << "FrameScheduler: Swap is waiting for vblank again" << std::endl;
+        publishStats();
+    }
+}
+
+void FrameScheduler::waitForNextVsync() const
+{
+    if (vsync_locked_ || last_present_ <= 0.0) return;
+    preciseWaitUntil(last_present_ + period_);
+}
+
+void FrameScheduler::reset()
+{
+    shown_any_ = false;
+}
+
+void FrameScheduler::preciseWaitUntil(double deadline)
+{
+    const double spin_threshold = PRESENT_SPIN_THRESHOLD_MS / 1000.0;
+    for (;;)
+    {
+        double remaining = deadline - Clock::now();
+        if (remaining <= 0.0) return;
+        if (remaining > spin_threshold) {
+            SDL_Delay(static_cast<Uint32>((remaining - spin_threshold) * 1000.0));
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void FrameScheduler::publishStats()
+{
+    state_->stats.display_refresh_hz.store(1.0 / period_);
+    state_->stats.vsync_locked.store(vsync_locked_);
+}
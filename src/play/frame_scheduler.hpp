@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cmath>
+#include "../player_core/player_state.hpp"
+
+/**
+ * 按显示器刷新节奏安排视频帧的呈现，在主线程（GL 线程）使用。
+ *
+ * 每次交换缓冲区之前调用 selectFrame：预测这次交换上屏的 vsync 时刻，把主时钟外推到该时刻，
+ * 选出 pts 距离它最近的帧。尚未到期的帧留在队列里等下一个 vsync，已被更新帧取代的帧丢弃，
+ * 没有新帧到期时重复上一帧——24p 在 60Hz 上因此得到稳定的 3:2 节奏。
+ * 交换之后调用 framePresented 校准 vsync 相位和实际周期；交换不阻塞时（垂直同步被关闭、
+ * 窗口被遮挡）由 waitForNextVsync 用高精度等待按刷新周期自行定拍。
+ */
+class FrameScheduler
+{
+public:
+    struct Selection
+    {
+        AVFrame* frame = nullptr;   // nullptr 表示这个 vsync 重复上一帧
+        double pts = NAN;
+        double vsync_time = 0.0;    // 预计上屏时刻（Clock::now 时间基）
+        double drift = NAN;         // 帧 pts - 上屏时刻的主时钟
+        bool resync = false;        // 时间轴跳变、seek 或打开文件后的第一帧，视频时钟需要重新对齐
+    };
+
+    explicit FrameScheduler(PlayerState* state);
+
+    // 显示器标称刷新率，窗口移动到其他显示器后重新设置
+    void setRefreshRate(double hz);
+    // 交换缓冲区是否等待 vblank（SDL_GL_GetSwapInterval）
+    void setVsyncEnabled(bool enabled);
+
+    double refreshPeriod() const { return period_; }
+    bool vsyncLocked() const { return vsync_locked_; }
+    // 打开文件后是否已经显示过帧（第一帧作为海报帧，暂停时也显示）
+    bool shownAny() const { return shown_any_; }
+
+    // 本次交换预计上屏的时刻
+    double nextVsync(double now) const;
+
+    Selection selectFrame();
+
+    // 交换缓冲区前后的时刻，用于估计 vsync 相位、周期和是否真的在等待 vblank
+    void framePresented(double swap_start, double swap_end);
+
+    // 垂直同步不可用时等到下一个刷新周期；可用时由交换缓冲区阻塞，直接返回
+    void waitForNextVsync() const;
+
+    // 回到开始播放的状态（打开新文件）
+    void reset();
+
+    // 先粗粒度休眠，剩余不到 PRESENT_SPIN_THRESHOLD_MS 时让出 CPU 轮询，误差在几十微秒内
+    static void preciseWaitUntil(double deadline);
+
+private:
+    void publishStats();
+
+    PlayerState* state_;
+    double nominal_period_ = 1.0 / PRESENT_DEFAULT_REFRESH_HZ;
+    double period_ = 1.0 / PRESENT_DEFAULT_REFRESH_HZ;   // 按实测交换间隔微调（如 59.94Hz）
+    double last_present_ = 0.0;
+    bool vsync_enabled_ = true;
+    bool vsync_locked_ = true;
+    int fast_swaps_ = 0;
+    bool shown_any_ = false;
+};
@@ -1,5 +1,8 @@
 #include "opengl_renderer.hpp"
 #include <iostream>
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -68,8 +71,12 @@ bool OpenGLRenderer::init(int video_width, int video_height, AVPixelFormat pix_f
     // 设置垂直同步
     SDL_GL_SetSwapInterval(1);
     
-    // 创建纹理
+    // 选择直接采样或转换路径，再按平面布局创建纹理
+    if (!setupPixelFormat(video_width_, video_height_, pix_fmt)) {
+        return false;
+    }
     createTextures(video_width_, video_height_);
+    pbo_ring_.init();
     
     // 设置顶点数据
     setupVertexData();
@@ -88,19 +95,6 @@ bool OpenGLRenderer::init(int video_width, int video_height, AVPixelFormat pix_f
         return false;
     }
     
-    // 如果需要格式转换，创建sws上下文
-    if (pix_fmt != AV_PIX_FMT_YUV420P) {
-        sws_ctx_ = sws_getContext(
-            video_width_, video_height_, pix_fmt,
-            video_width_, video_height_, AV_PIX_FMT_YUV420P,
-            SWS_BILINEAR, nullptr, nullptr, nullptr
-        );
-        
-        if (!sws_ctx_) {
-            std::cerr << "Failed to create sws context" << std::endl;
-        }
-    }
-
     // 初始化 UI 层
     if (!ui_layer_->Init(window_, gl_context_)) {
         std::cerr << "Failed to initialize UI layer" << std::endl;
@@ -116,45 +110,106 @@ bool OpenGLRenderer::init(int video_width, int video_height, AVPixelFormat pix_f
     return true;
 }
 
+bool OpenGLRenderer::setupPixelFormat(int width, int height, AVPixelFormat pix_fmt)
+{
+    color_key_ = -1;
+    direct_sampling_ = describeVideoFormat(pix_fmt, layout_);
+    if (direct_sampling_) {
+        std::cout << "Sampling " << av_get_pix_fmt_name(pix_fmt) << " directly on GPU ("
+                  << layout_.plane_count << " planes, " << layout_.bit_depth << "-bit)" << std::endl;
+        return true;
+    }
+    
+    // GPU 无法直接采样的格式（RGB、调色板等）逐帧经 sws_cache_ 转换为 YUV420P，纹理按 YUV420P 布局创建
+    if (width <= 0 || height <= 0) {
+        std::cerr << "Invalid video size for conversion" << std::endl;
+        return false;
+    }
+    layout_ = VideoFormatLayout();
+    std::cout << "Converting " << av_get_pix_fmt_name(pix_fmt) << " to yuv420p on CPU" << std::endl;
+    return true;
+}
+
+bool OpenGLRenderer::reconfigureForFrame(const AVFrame* frame)
+{
+    std::cout << "Stream changed: " << video_width_ << "x" << video_height_ << " "
+              << av_get_pix_fmt_name(pix_fmt_) << " -> " << frame->width << "x" << frame->height << " "
+              << av_get_pix_fmt_name(static_cast<AVPixelFormat>(frame->format)) << std::endl;
+    
+    video_width_ = frame->width;
+    video_height_ = frame->height;
+    pix_fmt_ = static_cast<AVPixelFormat>(frame->format);
+    
+    // 纹理和 FBO 按新的平面布局和尺寸重建；着色器、顶点数据和 PBO 环不依赖尺寸，保持不变
+    if (y_texture_) { glDeleteTextures(1, &y_texture_); y_texture_ = 0; }
+    if (u_texture_) { glDeleteTextures(1, &u_texture_); u_texture_ = 0; }
+    if (v_texture_) { glDeleteTextures(1, &v_texture_); v_texture_ = 0; }
+    if (!setupPixelFormat(video_width_, video_height_, pix_fmt_)) {
+        return false;
+    }
+    createTextures(video_width_, video_height_);
+    
+    deleteFramebuffer();
+    createFramebuffer(video_width_, video_height_);
+    
+    if (ui_layer_) ui_layer_->SetVideoSize(video_width_, video_height_);
+    return true;
+}
+
 void OpenGLRenderer::createTextures(int width, int height) 
 {
     std::cout << "Creating textures: " << width << "x" << height << std::endl;
     
-    // 创建YUV纹理
-    glGenTextures(1, &y_texture_);
-    glGenTextures(1, &u_texture_);
-    glGenTextures(1, &v_texture_);
+    // 16 位纹理用于高位深格式，采样值按 65535 归一化
+    bool wide = layout_.bytes_per_sample == 2;
+    GLenum type = wide ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
+    int chroma_w = layout_.chromaWidth(width);
+    int chroma_h = layout_.chromaHeight(height);
+    
+    auto createPlane = [type](GLuint& texture, GLint internal_format, GLenum format, int w, int h) {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, w, h, 0, format, type, NULL);
+    };
     
     // 设置Y纹理（全分辨率）
-    glBindTexture(GL_TEXTURE_2D, y_texture_);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+    createPlane(y_texture_, wide ? GL_R16 : GL_R8, GL_RED, width, height);
     
-    // 设置U纹理（1/4分辨率）
-    glBindTexture(GL_TEXTURE_2D, u_texture_);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, width/2, height/2, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
-    
-    // 设置V纹理（1/4分辨率）
-    glBindTexture(GL_TEXTURE_2D, v_texture_);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, width/2, height/2, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+    if (layout_.plane_count == 2) {
+        // 半平面：UV 交错在一张双通道纹理中；V 纹理只占位，着色器不采样
+        createPlane(u_texture_, wide ? GL_RG16 : GL_RG8, GL_RG, chroma_w, chroma_h);
+        createPlane(v_texture_, wide ? GL_R16 : GL_R8, GL_RED, 1, 1);
+    } else {
+        // 设置U/V纹理（按色度抽样缩小）
+        createPlane(u_texture_, wide ? GL_R16 : GL_R8, GL_RED, chroma_w, chroma_h);
+        createPlane(v_texture_, wide ? GL_R16 : GL_R8, GL_RED, chroma_w, chroma_h);
+    }
     
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+void OpenGLRenderer::applyColorMatrix(const AVFrame* frame)
+{
+    // 色彩空间/范围变化时（或新文件的第一帧）才重新计算并设置 uniform
+    int key = frame->colorspace * 16 + frame->color_range;
+    if (key == color_key_) return;
+    color_key_ = key;
+    
+    YuvColorMatrix m = computeYuvColorMatrix(layout_, frame->colorspace, frame->color_range, frame->height);
+    glUniformMatrix3fv(glGetUniformLocation(shader_->ID, "yuv_matrix"), 1, GL_FALSE, m.matrix);
+    glUniform3fv(glGetUniformLocation(shader_->ID, "yuv_offset"), 1, m.offset);
+    shader_->setInt("uv_interleaved", layout_.plane_count == 2 ? 1 : 0);
+    
+    std::cout << "Video color: " << colorSpaceName(frame->colorspace, frame->height)
+              << (layout_.full_range || frame->color_range == AVCOL_RANGE_JPEG ? " full" : " limited")
+              << " range" << std::endl;
+}
+
 void OpenGLRenderer::setupVertexData()
 {
     // 全屏四边形顶点数据 (位置, 纹理坐标)
@@ -203,14 +258,25 @@ void OpenGLRenderer::renderFrame(const AVFrame* frame)
         return;
     }
     
-    // 验证数据
-    uint8_t* y_data = frame->data[0];
-    uint8_t* u_data = frame->data[1];
-    uint8_t* v_data = frame->data[2];
+    // 纹理按当前像素格式和尺寸创建，中途变化（自适应码流、拼接文件）时先按新参数重建
+    if (frame->format != pix_fmt_ || frame->width != video_width_ || frame->height != video_height_) {
+        if (!reconfigureForFrame(frame)) return;
+    }
     
-    if (!y_data || !u_data || !v_data) {
-        std::cerr << "Invalid frame data pointers" << std::endl;
-        return;
+    // 不能直接采样的格式先转换为 YUV420P（上下文和目标帧按格式/尺寸缓存）
+    if (!direct_sampling_) {
+        int64_t convert_start = av_gettime_relative();
+        frame = sws_cache_.convert(frame, video_width_, video_height_, AV_PIX_FMT_YUV420P);
+        if (state_) state_->metrics.record(MetricStage::SWS_CONVERT, av_gettime_relative() - convert_start);
+        if (!frame) return;
+    }
+    
+    // 验证数据
+    for (int i = 0; i < layout_.plane_count; i++) {
+        if (!frame->data[i]) {
+            std::cerr << "Invalid frame data pointers" << std::endl;
+            return;
+        }
     }
     
     // std::cout << "Y data samples: " << (int)y_data[0] << " " << (int)y_data[100] << " " << (int)y_data[1000] << std::endl;
@@ -219,6 +285,7 @@ void OpenGLRenderer::renderFrame(const AVFrame* frame)
     GLint program_id = 0;
     GLint vao_binding = 0;
     GLenum error = GL_NO_ERROR;
+    int64_t upload_start = 0;
     
     // 1. 绑定FBO并设置视口
     glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
@@ -228,31 +295,10 @@ void OpenGLRenderer::renderFrame(const AVFrame* frame)
     glClearColor(0.2f, 0.3f, 0.8f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
     
-    // 2. 上传纹理数据（简化版）
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, y_texture_);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    for (int y = 0; y < frame->height; y++) {
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, frame->width, 1,
-                       GL_RED, GL_UNSIGNED_BYTE, 
-                       frame->data[0] + y * frame->linesize[0]);
-    }
-    
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, u_texture_);
-    for (int y = 0; y < frame->height/2; y++) {
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, frame->width/2, 1,
-                       GL_RED, GL_UNSIGNED_BYTE, 
-                       frame->data[1] + y * frame->linesize[1]);
-    }
-    
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, v_texture_);
-    for (int y = 0; y < frame->height/2; y++) {
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, frame->width/2, 1,
-                       GL_RED, GL_UNSIGNED_BYTE, 
-                       frame->data[2] + y * frame->linesize[2]);
-    }
+    // 2. 上传纹理数据（经 PBO 环异步上传；计时的是映射、拷贝和提交的耗时）
+    upload_start = av_gettime_relative();
+    uploadPlanes(frame);
+    if (state_) state_->metrics.record(MetricStage::TEXTURE_UPLOAD, av_gettime_relative() - upload_start);
     
     // 3. 使用着色器程序
     if (shader_->ID == 0) {
@@ -275,6 +321,7 @@ void OpenGLRenderer::renderFrame(const AVFrame* frame)
     shader_->setInt("y_texture", 0);
     shader_->setInt("u_texture", 1);
     shader_->setInt("v_texture", 2);
+    applyColorMatrix(frame);
     
     // 4. 检查VAO状态
     if (vao_ == 0) {
@@ -335,6 +382,7 @@ void OpenGLRenderer::clear()
     if (y_texture_) glDeleteTextures(1, &y_texture_);
     if (u_texture_) glDeleteTextures(1, &u_texture_);
     if (v_texture_) glDeleteTextures(1, &v_texture_);
+    if (gl_context_) pbo_ring_.release();
     
     if (vao_) glDeleteVertexArrays(1, &vao_);
     if (vbo_) glDeleteBuffers(1, &vbo_);
@@ -343,7 +391,7 @@ void OpenGLRenderer::clear()
     // 清理FBO
     deleteFramebuffer();
     
-    if (sws_ctx_) { sws_freeContext(sws_ctx_); sws_ctx_ = nullptr; }
+    sws_cache_.clear();
     
     if (gl_context_) { SDL_GL_DeleteContext(gl_context_); gl_context_ = nullptr; }
     if (window_) { SDL_DestroyWindow(window_); window_ = nullptr; }
@@ -466,6 +514,11 @@ void OpenGLRenderer::handleSDLEvent(const SDL_Event& event)
                         ui_layer_->SetVisible(!ui_layer_->IsVisible());
                     }
                     break;
+                case SDLK_F3:
+                    if (ui_layer_) {
+                        ui_layer_->SetMetricsVisible(!ui_layer_->IsMetricsVisible());
+                    }
+                    break;
                 default:
                     break;
             }
@@ -488,27 +541,52 @@ void OpenGLRenderer::renderUI()
     
     // 结束ImGui帧并交换缓冲区
     ui_layer_->EndFrame();
+    // 开启垂直同步时交换缓冲区包含等待 vblank 的时间
+    int64_t present_start = av_gettime_relative();
     SDL_GL_SwapWindow(window_);
+    if (state_) state_->metrics.record(MetricStage::PRESENT, av_gettime_relative() - present_start);
 }
+
+double OpenGLRenderer::displayRefreshRate() const
+{
+    SDL_DisplayMode mode;
+    if (!window_ || SDL_GetWindowDisplayMode(window_, &mode) != 0) return 0.0;
+    return mode.refresh_rate;
+}
+
+bool OpenGLRenderer::vsyncEnabled() const
+{
+    return gl_context_ != nullptr && SDL_GL_GetSwapInterval() != 0;
+}
+
+void OpenGLRenderer::uploadPlanes(const AVFrame* frame)
+{
+    // 平面尺寸与 createTextures 一致
+    int bytes = layout_.bytes_per_sample;
+    GLenum type = bytes == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
+    int chroma_w = layout_.chromaWidth(frame->width);
+    int chroma_h = layout_.chromaHeight(frame->height);
+    
+    PboUploadRing::Plane planes[3] = {
+        {y_texture_, frame->width, frame->height, GL_RED, type, bytes},
+        {u_texture_, chroma_w, chroma_h, GL_RED, type, bytes},
+        {v_texture_, chroma_w, chroma_h, GL_RED, type, bytes},
+    };
+    if (layout_.plane_count == 2) {
+        planes[1] = {u_texture_, chroma_w, chroma_h, GL_RG, type, 2 * bytes};
+    }
+    
+    if (!pbo_ring_.upload(frame, planes, layout_.plane_count)) {
+        PboUploadRing::uploadDirect(frame, planes, layout_.plane_count);
+    }
+}
+
 // 添加新的辅助函数
 void OpenGLRenderer::renderVideoToFBO(const AVFrame* frame) {
     if (!frame) return;
     
     // 上传纹理数据
-    glBindTexture(GL_TEXTURE_2D, y_texture_);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 
-                   frame->width, frame->height,
-                   GL_RED, GL_UNSIGNED_BYTE, frame->data[0]);
-    
-    glBindTexture(GL_TEXTURE_2D, u_texture_);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 
-                   frame->width/2, frame->height/2,
-                   GL_RED, GL_UNSIGNED_BYTE, frame->data[1]);
-    
-    glBindTexture(GL_TEXTURE_2D, v_texture_);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 
-                   frame->width/2, frame->height/2,
-                   GL_RED, GL_UNSIGNED_BYTE, frame->data[2]);
+    uploadPlanes(frame);
     
     // 使用着色器渲染
     shader_->use();
@@ -609,6 +687,7 @@ void OpenGLRenderer::clearVideoResources() {
     if (y_texture_) { glDeleteTextures(1, &y_texture_); y_texture_ = 0; }
     if (u_texture_) { glDeleteTextures(1, &u_texture_); u_texture_ = 0; }
     if (v_texture_) { glDeleteTextures(1, &v_texture_); v_texture_ = 0; }
+    pbo_ring_.release();
     
     if (vao_) { glDeleteVertexArrays(1, &vao_); vao_ = 0; }
     if (vbo_) { glDeleteBuffers(1, &vbo_); vbo_ = 0; }
@@ -618,12 +697,16 @@ void OpenGLRenderer::clearVideoResources() {
     
     deleteFramebuffer();
     
-    if (sws_ctx_) { sws_freeContext(sws_ctx_); sws_ctx_ = nullptr; }
+    sws_cache_.clear();
 }
 
 bool OpenGLRenderer::createVideoResources(int width, int height, AVPixelFormat pix_fmt) {
-    // 创建纹理
+    // 选择直接采样或转换路径，再按平面布局创建纹理
+    if (!setupPixelFormat(width, height, pix_fmt)) {
+        return false;
+    }
     createTextures(width, height);
+    pbo_ring_.init();
     
     // 设置顶点数据
     setupVertexData();
@@ -642,19 +725,5 @@ bool OpenGLRenderer::createVideoResources(int width, int height, AVPixelFormat p
         return false;
     }
     
-    // 如果需要格式转换，创建sws上下文
-    if (pix_fmt != AV_PIX_FMT_YUV420P) {
-        sws_ctx_ = sws_getContext(
-            width, height, pix_fmt,
-            width, height, AV_PIX_FMT_YUV420P,
-            SWS_BILINEAR, nullptr, nullptr, nullptr
-        );
-        
-        if (!sws_ctx_) {
-            std::cerr << "Failed to create sws context" << std::endl;
-            return false;
-        }
-    }
-    
     return true;
 }
\ No newline at end of file
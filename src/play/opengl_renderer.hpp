@@ -12,6 +12,9 @@ extern "C" {
 
 #include "player_core/player_state.hpp"
 #include "shader_utils/shader.hpp"
+#include "pbo_upload_ring.hpp"
+#include "video_format.hpp"
+#include "sws_cache.hpp"
 #include "ui/ui_layer.hpp"
 
 class OpenGLRenderer {
@@ -51,12 +54,20 @@ public:
     void handleSDLEvent(const SDL_Event& event);
     void renderUI();
     
+    // 窗口所在显示器的刷新率（查询不到时为 0）和交换缓冲区是否等待 vblank
+    double displayRefreshRate() const;
+    bool vsyncEnabled() const;
+    
 private:
+    bool setupPixelFormat(int width, int height, AVPixelFormat pix_fmt);
     void createTextures(int width, int height);
+    void applyColorMatrix(const AVFrame* frame);
+    bool reconfigureForFrame(const AVFrame* frame);  // 流中途分辨率/格式变化时重建纹理和 FBO
     void setupVertexData();
     void createFramebuffer(int width, int height);
     void deleteFramebuffer();
     void renderVideoToFBO(const AVFrame* frame);
+    void uploadPlanes(const AVFrame* frame);    // 上传 YUV 平面到 y/u/v 纹理
 
     // 分离创建窗口和创建视频相关资源
     void clearVideoResources();
@@ -74,6 +85,7 @@ private:
     GLuint u_texture_ = 0;
     GLuint v_texture_ = 0;
     Shader* shader_ = nullptr;
+    PboUploadRing pbo_ring_;
     
     // 帧缓冲对象
     GLuint m_fbo = 0;
@@ -89,8 +101,11 @@ private:
     int window_height_ = 720;
     bool fullscreen_ = false;
     
-    // 格式转换
-    SwsContext* sws_ctx_ = nullptr;
+    // 像素格式：能直接采样时按 layout_ 上传原始平面，否则经 sws 转换为 YUV420P
+    VideoFormatLayout layout_;
+    bool direct_sampling_ = true;
+    int color_key_ = -1;                  // 当前 uniform 对应的 colorspace/range
+    SwsContextCache sws_cache_;
 
     // UI 层
     std::unique_ptr<UiLayer> ui_layer_;
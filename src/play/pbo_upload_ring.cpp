@@ -0,0 +1,140 @@
+#include "pbo_upload_ring.hpp"
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// 平面在源帧中占用的字节数（最后一行不含填充，避免读越界）
+size_t planeBytes(const AVFrame* frame, int index, const PboUploadRing::Plane& plane)
+{
+    return static_cast<size_t>(frame->linesize[index]) * (plane.height - 1) +
+           static_cast<size_t>(plane.width) * plane.bytes_per_pixel;
+}
+
+} // namespace
+
+bool PboUploadRing::init()
+{
+    release();
+    glGenBuffers(PBO_RING_SIZE, buffers_);
+    for (int i = 0; i < PBO_RING_SIZE; i++) {
+        if (buffers_[i] == 0) {
+            std::cerr << "PboUploadRing: Failed to create pixel buffers" << std::endl;
+            release();
+            return false;
+        }
+    }
+    next_ = 0;
+    stalls_ = 0;
+    return true;
+}
+
+void PboUploadRing::release()
+{
+    for (int i = 0; i < PBO_RING_SIZE; i++) {
+        if (fences_[i]) { glDeleteSync(fences_[i]); fences_[i] = nullptr; }
+        capacity_[i] = 0;
+    }
+    if (buffers_[0]) {
+        glDeleteBuffers(PBO_RING_SIZE, buffers_);
+        for (GLuint& buffer : buffers_) buffer = 0;
+    }
+}
+
+bool PboUploadRing::upload(const AVFrame* frame, const Plane* planes, int plane_count)
+{
+    if (!isReady() || !frame || plane_count > MAX_PLANES) return false;
+
+    // 负 linesize（上下翻转的帧）无法用 ROW_LENGTH 描述，交给直接上传
+    size_t offsets[MAX_PLANES];
+    size_t total = 0;
+    for (int i = 0; i < plane_count; i++) {
+        if (!frame->data[i] || frame->linesize[i] <= 0 ||
+            frame->linesize[i] % planes[i].bytes_per_pixel != 0) {
+            return false;
+        }
+        offsets[i] = total;
+        total += (planeBytes(frame, i, planes[i]) + 63) & ~size_t(63);   // 平面起点按 64 字节对齐
+    }
+
+    int slot = next_;
+    next_ = (next_ + 1) % PBO_RING_SIZE;
+
+    // 检查 GPU 是否已读完该缓冲区的上一次内容（不等待）
+    bool in_flight = false;
+    if (fences_[slot]) {
+        GLenum result = glClientWaitSync(fences_[slot], 0, 0);
+        in_flight = result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED;
+        glDeleteSync(fences_[slot]);
+        fences_[slot] = nullptr;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers_[slot]);
+    if (capacity_[slot] < total) {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, total, nullptr, GL_STREAM_DRAW);
+        capacity_[slot] = total;
+    }
+
+    // 仍在使用时 INVALIDATE 让驱动分配新存储；已读完则可跳过同步
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+    if (in_flight) {
+        stalls_++;
+    } else {
+        access |= GL_MAP_UNSYNCHRONIZED_BIT;
+    }
+
+    uint8_t* mapped = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total, access));
+    if (!mapped) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    for (int i = 0; i < plane_count; i++) {
+        std::memcpy(mapped + offsets[i], frame->data[i], planeBytes(frame, i, planes[i]));
+    }
+
+    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) != GL_TRUE) {
+        // 映射期间存储被破坏（如显示模式切换），本帧改用直接上传
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int i = 0; i < plane_count; i++) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, planes[i].texture);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, frame->linesize[i] / planes[i].bytes_per_pixel);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, planes[i].width, planes[i].height,
+                        planes[i].format, planes[i].type,
+                        reinterpret_cast<const void*>(offsets[i]));
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    fences_[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+void PboUploadRing::uploadDirect(const AVFrame* frame, const Plane* planes, int plane_count)
+{
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int i = 0; i < plane_count && i < MAX_PLANES; i++) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, planes[i].texture);
+
+        if (frame->linesize[i] > 0 && frame->linesize[i] % planes[i].bytes_per_pixel == 0) {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, frame->linesize[i] / planes[i].bytes_per_pixel);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, planes[i].width, planes[i].height,
+                            planes[i].format, planes[i].type, frame->data[i]);
+        } else {
+            // 负 linesize 只能逐行上传
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            for (int y = 0; y < planes[i].height; y++) {
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, planes[i].width, 1,
+                                planes[i].format, planes[i].type, frame->data[i] + y * frame->linesize[i]);
+            }
+        }
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
@@ -0,0 +1,60 @@
+// pbo_upload_ring.hpp
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+#include "player_core/utils/player_constants.hpp"
+
+/**
+ * 像素缓冲对象（PBO）环，用于异步上传视频平面到纹理。
+ *
+ * 每帧写入环中的下一个 PBO：整平面（含 linesize 填充）一次 memcpy 到映射内存，
+ * 再以 GL_UNPACK_ROW_LENGTH 跳过填充，每个平面只需一次 glTexSubImage2D。
+ * 源数据已在 PBO 中，glTexSubImage2D 立即返回，实际传输由驱动异步完成；
+ * 每个 PBO 附带一个 fence，复用前确认 GPU 已读完，未读完时让驱动换新存储（orphan）而不是等待。
+ */
+class PboUploadRing
+{
+public:
+    struct Plane
+    {
+        GLuint texture;
+        int width;          // 纹理宽高（像素）
+        int height;
+        GLenum format;      // GL_RED / GL_RG
+        GLenum type;        // GL_UNSIGNED_BYTE / GL_UNSIGNED_SHORT
+        int bytes_per_pixel;
+    };
+
+    static constexpr int MAX_PLANES = 3;
+
+    PboUploadRing() = default;
+    ~PboUploadRing() = default;   // GL 对象需在上下文有效时调用 release()
+
+    PboUploadRing(const PboUploadRing&) = delete;
+    PboUploadRing& operator=(const PboUploadRing&) = delete;
+
+    bool init();
+    void release();
+    bool isReady() const { return buffers_[0] != 0; }
+
+    // 上传 frame 的前 plane_count 个平面；失败时返回 false，调用方改用直接上传
+    bool upload(const AVFrame* frame, const Plane* planes, int plane_count);
+
+    // 不经过 PBO 的直接上传（每个平面一次调用，同样用 GL_UNPACK_ROW_LENGTH 处理填充）
+    static void uploadDirect(const AVFrame* frame, const Plane* planes, int plane_count);
+
+    int64_t stalls() const { return stalls_; }   // 复用时 GPU 尚未读完的次数
+
+private:
+    GLuint buffers_[PBO_RING_SIZE] = {};
+    GLsync fences_[PBO_RING_SIZE] = {};
+    size_t capacity_[PBO_RING_SIZE] = {};
+    int next_ = 0;
+    int64_t stalls_ = 0;
+};
@@ -1,5 +1,9 @@
 #include "renderer.hpp"
 #include <iostream>
+#include <cstring>
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
 
 Renderer::Renderer(PlayerState* state) : state_(state) {}
 
@@ -66,6 +70,7 @@ bool Renderer::init(int video_width, int video_height, AVPixelFormat pix_fmt)
 void Renderer::createTexture(int width, int height, AVPixelFormat pix_fmt) 
 {
     Uint32 sdl_format;
+    texture_fmt_ = pix_fmt;
     switch (pix_fmt) 
     {
         case AV_PIX_FMT_YUV420P:
@@ -78,7 +83,17 @@ void Renderer::createTexture(int width, int height, AVPixelFormat pix_fmt)
             sdl_format = SDL_PIXELFORMAT_YUY2;
             break;
         default:
-            sdl_format = SDL_PIXELFORMAT_YV12;
+            // SDL 没有对应纹理格式的 8 位平面 YUV（422P/444P 等）用内置 SIMD 内核直接转换为 RGBA
+            if (rgba_converter_.configure(pix_fmt, width, height)) {
+                sdl_format = SDL_PIXELFORMAT_RGBA32;
+                texture_fmt_ = AV_PIX_FMT_RGBA;
+                std::cout << "Renderer: Converting " << av_get_pix_fmt_name(pix_fmt) << " to RGBA ("
+                          << simdLevelName(rgba_converter_.level()) << ")" << std::endl;
+            } else {
+                // 其余格式每帧经 sws_cache_ 转换为 yuv420p
+                sdl_format = SDL_PIXELFORMAT_YV12;
+                texture_fmt_ = AV_PIX_FMT_YUV420P;
+            }
             break;
     }
     
@@ -86,20 +101,40 @@ void Renderer::createTexture(int width, int height, AVPixelFormat pix_fmt)
         renderer_, sdl_format,
         SDL_TEXTUREACCESS_STREAMING, width, height
     );
-    
-    // 需要格式转换时才创建 sws_ctx
-    if (sdl_format == SDL_PIXELFORMAT_YV12 && pix_fmt != AV_PIX_FMT_YUV420P) 
+}
+
+void Renderer::uploadTexture(const AVFrame* frame) 
+{
+    switch (texture_fmt_) 
     {
-        sws_ctx_ = sws_getContext(
-            width, height, pix_fmt,
-            width, height, AV_PIX_FMT_YUV420P,
-            SWS_BILINEAR, nullptr, nullptr, nullptr
-        );
-        
-        if (!sws_ctx_) 
+        case AV_PIX_FMT_YUV420P:
+            SDL_UpdateYUVTexture(texture_, nullptr,
+                                frame->data[0], frame->linesize[0],
+                                frame->data[1], frame->linesize[1],
+                                frame->data[2], frame->linesize[2]);
+            break;
+        case AV_PIX_FMT_NV12: 
         {
-            std::cerr << "Failed to create sws context" << std::endl;
+            // NV12 两个平面在 FFmpeg 帧里不连续，按纹理的 pitch 逐行拷贝
+            void* pixels = nullptr;
+            int pitch = 0;
+            if (SDL_LockTexture(texture_, nullptr, &pixels, &pitch) != 0) break;
+            uint8_t* dst = static_cast<uint8_t*>(pixels);
+            for (int y = 0; y < frame->height; y++) {
+                memcpy(dst + y * pitch, frame->data[0] + y * frame->linesize[0], frame->width);
+            }
+            uint8_t* dst_uv = dst + pitch * frame->height;
+            int uv_bytes = ((frame->width + 1) / 2) * 2;
+            for (int y = 0; y < (frame->height + 1) / 2; y++) {
+                memcpy(dst_uv + y * pitch, frame->data[1] + y * frame->linesize[1], uv_bytes);
+            }
+            SDL_UnlockTexture(texture_);
+            break;
         }
+        default:
+            // YUY2 / RGBA 都是单平面
+            SDL_UpdateTexture(texture_, nullptr, frame->data[0], frame->linesize[0]);
+            break;
     }
 }
 
@@ -132,16 +167,7 @@ void Renderer::renderFrame(const AVFrame* frame)
     if (!renderer_ || !texture_ || !frame) return;
     
     // 获取PTS（秒）
-    double pts = NAN;
-    if (frame->opaque) 
-    {
-        pts = *((double*)frame->opaque);
-    } 
-    else if (frame->pts != AV_NOPTS_VALUE) 
-    {
-        AVStream* stream = state_->fmt_ctx->streams[state_->video_stream];
-        pts = frame->pts * av_q2d(stream->time_base);
-    }
+    double pts = state_->get_video_frame_pts(frame);
     
     // 更新视频时钟 - 使用 Clock 类
     if (!std::isnan(pts)) 
@@ -149,39 +175,46 @@ void Renderer::renderFrame(const AVFrame* frame)
         state_->video_clock.set(pts);
     }
     
-    if (sws_ctx_) 
+    // 流中途分辨率或格式变化（自适应码流、拼接文件）：按新参数重建纹理
+    if (frame->width != video_width_ || frame->height != video_height_ || frame->format != pix_fmt_) 
     {
-        // 需要格式转换
-        AVFrame* converted_frame = av_frame_alloc();
-        converted_frame->format = AV_PIX_FMT_YUV420P;
-        converted_frame->width = frame->width;
-        converted_frame->height = frame->height;
-        converted_frame->pts = frame->pts; // 保持时间戳
-        
-        if (av_frame_get_buffer(converted_frame, 0) < 0) 
+        std::cout << "Renderer: Stream changed to " << frame->width << "x" << frame->height << " "
+                  << av_get_pix_fmt_name(static_cast<AVPixelFormat>(frame->format)) << std::endl;
+        if (texture_) { SDL_DestroyTexture(texture_); texture_ = nullptr; }
+        video_width_ = frame->width;
+        video_height_ = frame->height;
+        pix_fmt_ = static_cast<AVPixelFormat>(frame->format);
+        createTexture(video_width_, video_height_, pix_fmt_);
+        if (!texture_) return;
+    }
+    
+    if (rgba_converter_.isConfigured() && texture_fmt_ == AV_PIX_FMT_RGBA) 
+    {
+        // 直接写入纹理内存，不经过中间缓冲
+        void* pixels = nullptr;
+        int pitch = 0;
+        if (SDL_LockTexture(texture_, nullptr, &pixels, &pitch) == 0) 
         {
-            av_frame_free(&converted_frame);
-            return;
+            int64_t convert_start = av_gettime_relative();
+            rgba_converter_.convertFrame(frame, static_cast<uint8_t*>(pixels), pitch);
+            state_->metrics.record(MetricStage::SWS_CONVERT, av_gettime_relative() - convert_start);
+            SDL_UnlockTexture(texture_);
         }
+    } 
+    else if (texture_fmt_ != pix_fmt_) 
+    {
+        // 需要格式转换（上下文和目标帧按格式/尺寸缓存，逐帧复用）
+        int64_t convert_start = av_gettime_relative();
+        const AVFrame* converted = sws_cache_.convert(frame, video_width_, video_height_, texture_fmt_);
+        state_->metrics.record(MetricStage::SWS_CONVERT, av_gettime_relative() - convert_start);
+        if (!converted) return;
         
-        sws_scale(sws_ctx_,
-                 frame->data, frame->linesize, 0, frame->height,
-                 converted_frame->data, converted_frame->linesize);
-        
-        SDL_UpdateYUVTexture(texture_, nullptr,
-                            converted_frame->data[0], converted_frame->linesize[0],
-                            converted_frame->data[1], converted_frame->linesize[1],
-                            converted_frame->data[2], converted_frame->linesize[2]);
-        
-        av_frame_free(&converted_frame);
+        uploadTexture(converted);
     } 
     else 
     {
         // 直接更新纹理
-        SDL_UpdateYUVTexture(texture_, nullptr,
-                            frame->data[0], frame->linesize[0],
-                            frame->data[1], frame->linesize[1],
-                            frame->data[2], frame->linesize[2]);
+        uploadTexture(frame);
     }
     
     SDL_RenderClear(renderer_);
@@ -200,7 +233,7 @@ void Renderer::clear()
     if (texture_) { SDL_DestroyTexture(texture_); texture_ = nullptr; }
     if (renderer_) { SDL_DestroyRenderer(renderer_); renderer_ = nullptr; }
     if (window_) { SDL_DestroyWindow(window_); window_ = nullptr; }
-    if (sws_ctx_) { sws_freeContext(sws_ctx_); sws_ctx_ = nullptr; }
+    sws_cache_.clear();
 }
 
 void Renderer::handleResize(int width, int height) 
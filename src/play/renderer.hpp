@@ -2,6 +2,8 @@
 #include <SDL2/SDL.h>
 #include "../ffmpeg_utils/ffmpeg_headers.hpp"
 #include "../player_core/player_state.hpp"
+#include "yuv_convert.hpp"
+#include "sws_cache.hpp"
 
 /**
  * Renderer 封装 SDL 渲染器、纹理和像素格式转换。
@@ -32,14 +34,17 @@ private:
     SDL_Window* window_ = nullptr;
     SDL_Renderer* renderer_ = nullptr;
     SDL_Texture* texture_ = nullptr;
-    SwsContext* sws_ctx_ = nullptr;
+    SwsContextCache sws_cache_;            // SDL 不支持的格式经 sws 转换，上下文和目标帧按格式/尺寸缓存
+    YuvToRgbaConverter rgba_converter_;    // 8 位平面 YUV 的软件转换（不经过 sws）
     int window_width_ = 1280;  // 固定窗口宽度
     int window_height_ = 720;  // 固定窗口高度
     int video_width_ = 0;      // 视频原始宽度
     int video_height_ = 0;     // 视频原始高度
     AVPixelFormat pix_fmt_ = AV_PIX_FMT_NONE;
+    AVPixelFormat texture_fmt_ = AV_PIX_FMT_NONE;  // 纹理实际接收的像素格式
     bool fullscreen_ = false;
     
     void createTexture(int width, int height, AVPixelFormat pix_fmt);
+    void uploadTexture(const AVFrame* frame);
     void calculateDisplayRect(SDL_Rect* rect) const;
 };
\ No newline at end of file
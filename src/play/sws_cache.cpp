@@ -0,0 +1,112 @@
+#include "sws_cache.hpp"
+#include "video_format.hpp"
+#include <iostream>
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+// YUV 源帧是否为全范围；未标注时按 yuvj 格式推断
+static bool isFullRange(const AVFrame* frame)
+{
+    if (frame->color_range != AVCOL_RANGE_UNSPECIFIED) return frame->color_range == AVCOL_RANGE_JPEG;
+    switch (frame->format) {
+        case AV_PIX_FMT_YUVJ420P:
+        case AV_PIX_FMT_YUVJ422P:
+        case AV_PIX_FMT_YUVJ444P:
+        case AV_PIX_FMT_YUVJ440P:
+        case AV_PIX_FMT_YUVJ411P:
+            return true;
+        default:
+            return false;
+    }
+}
+
+SwsContextCache::Entry* SwsContextCache::find(const Key& key)
+{
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->key == key) {
+            // 移到头部（splice 不使迭代器失效，也不复制条目）
+            entries_.splice(entries_.begin(), entries_, it);
+            return &entries_.front();
+        }
+    }
+    return nullptr;
+}
+
+AVFrame* SwsContextCache::convert(const AVFrame* src, int dst_width, int dst_height,
+                                  AVPixelFormat dst_format, int flags)
+{
+    if (!src || src->width <= 0 || src->height <= 0 || dst_width <= 0 || dst_height <= 0) {
+        return nullptr;
+    }
+
+    // 输出使用的矩阵和范围：YUV 源保持不变，RGB 源转为有限范围的 YUV
+    const AVPixFmtDescriptor* src_desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(src->format));
+    bool src_rgb = src_desc && (src_desc->flags & AV_PIX_FMT_FLAG_RGB);
+    bool src_full = src_rgb || isFullRange(src);
+    bool dst_full = src_full && !src_rgb;
+    AVColorSpace colorspace = resolveColorSpace(src->colorspace, src->height);
+
+    Key key{src->width, src->height, src->format, colorspace, src_full ? 1 : 0,
+            dst_width, dst_height, dst_format, flags};
+    Entry* entry = find(key);
+    if (entry) {
+        hits_++;
+    } else {
+        misses_++;
+
+        SwsContext* ctx = sws_getContext(src->width, src->height, static_cast<AVPixelFormat>(src->format),
+                                         dst_width, dst_height, dst_format, flags, nullptr, nullptr, nullptr);
+        AVFrame* frame = av_frame_alloc();
+        if (frame) {
+            frame->format = dst_format;
+            frame->width = dst_width;
+            frame->height = dst_height;
+        }
+        if (ctx) {
+            // sws 默认按 BT.601 有限范围输出；显式指定矩阵和范围，使下面的标注与数据相符
+            const int* coeffs = sws_getCoefficients(colorspace);
+            sws_setColorspaceDetails(ctx, coeffs, src_full ? 1 : 0, coeffs, dst_full ? 1 : 0,
+                                     0, 1 << 16, 1 << 16);
+        }
+        if (!ctx || !frame || av_frame_get_buffer(frame, 0) < 0) {
+            std::cerr << "SwsContextCache: Cannot convert "
+                      << av_get_pix_fmt_name(static_cast<AVPixelFormat>(src->format)) << " "
+                      << src->width << "x" << src->height << " to "
+                      << av_get_pix_fmt_name(dst_format) << " " << dst_width << "x" << dst_height << std::endl;
+            sws_freeContext(ctx);
+            av_frame_free(&frame);
+            return nullptr;
+        }
+
+        // 超出容量时淘汰最久未用的条目
+        while (!entries_.empty() && static_cast<int>(entries_.size()) >= capacity_) {
+            Entry& victim = entries_.back();
+            sws_freeContext(victim.ctx);
+            av_frame_free(&victim.frame);
+            entries_.pop_back();
+        }
+
+        entries_.push_front(Entry{key, ctx, frame});
+        entry = &entries_.front();
+    }
+
+    sws_scale(entry->ctx, src->data, src->linesize, 0, src->height,
+              entry->frame->data, entry->frame->linesize);
+
+    // 标注转换实际使用的矩阵和范围；时间戳随帧传递，后续同步仍按源帧处理
+    entry->frame->colorspace = colorspace;
+    entry->frame->color_range = dst_full ? AVCOL_RANGE_JPEG : AVCOL_RANGE_MPEG;
+    entry->frame->pts = src->pts;
+    return entry->frame;
+}
+
+void SwsContextCache::clear()
+{
+    for (Entry& entry : entries_) {
+        sws_freeContext(entry.ctx);
+        av_frame_free(&entry.frame);
+    }
+    entries_.clear();
+}
@@ -0,0 +1,70 @@
+// sws_cache.hpp
+#pragma once
+
+#include <list>
+#include <cstdint>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+#include "player_core/utils/player_constants.hpp"
+
+/**
+ * 按 (源宽高/格式/色彩标注, 目标宽高/格式, flags) 缓存 SwsContext 和对应的目标帧（LRU）。
+ *
+ * 每帧查找一次：参数与最近使用的条目相同时直接命中，分辨率/格式在几种之间来回切换
+ * （自适应码流、拼接文件）也不会重建上下文或重新分配目标帧。
+ * YUV 源沿用自身的色彩空间和范围，输出帧按转换实际使用的矩阵和范围标注。
+ */
+class SwsContextCache
+{
+public:
+    explicit SwsContextCache(int capacity = SWS_CACHE_CAPACITY) : capacity_(capacity) {}
+    ~SwsContextCache() { clear(); }
+
+    SwsContextCache(const SwsContextCache&) = delete;
+    SwsContextCache& operator=(const SwsContextCache&) = delete;
+
+    // 转换到缓存的目标帧并返回它（由缓存持有，下次转换到同一参数前有效）；失败返回 nullptr
+    AVFrame* convert(const AVFrame* src, int dst_width, int dst_height, AVPixelFormat dst_format,
+                     int flags = SWS_BILINEAR);
+
+    void clear();
+
+    int64_t hits() const { return hits_; }
+    int64_t misses() const { return misses_; }
+
+private:
+    struct Key
+    {
+        int src_width, src_height, src_format;
+        int src_colorspace, src_full_range;
+        int dst_width, dst_height, dst_format;
+        int flags;
+
+        bool operator==(const Key& other) const
+        {
+            return src_width == other.src_width && src_height == other.src_height &&
+                   src_format == other.src_format && src_colorspace == other.src_colorspace &&
+                   src_full_range == other.src_full_range && dst_width == other.dst_width &&
+                   dst_height == other.dst_height && dst_format == other.dst_format &&
+                   flags == other.flags;
+        }
+    };
+
+    struct Entry
+    {
+        Key key;
+        SwsContext* ctx;
+        AVFrame* frame;
+    };
+
+    Entry* find(const Key& key);
+
+    std::list<Entry> entries_;   // 头部为最近使用
+    int capacity_;
+    int64_t hits_ = 0;
+    int64_t misses_ = 0;
+};
@@ -0,0 +1,181 @@
+#include "sync_engine.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+
+DriftEstimator::DriftEstimator(int window)
+    : window_(window), coef_(std::exp(std::log(0.01) / window))
+{
+}
+
+void DriftEstimator::add(double diff)
+{
+    cum_ = diff + coef_ * cum_;
+    if (count_ < window_) count_++;
+}
+
+void DriftEstimator::reset()
+{
+    cum_ = 0.0;
+    count_ = 0;
+}
+
+SyncEngine::SyncEngine(Clock& audio, Clock& video, Clock& external)
+    : audio_(audio), video_(video), external_(external)
+{
+    if (const char* sync = std::getenv("SDL2_PLAYER_SYNC")) {
+        SyncMaster master;
+        if (parseMaster(sync, master)) {
+            preferred_.store(master);
+            master_.store(master);
+        } else {
+            std::cerr << "Unknown SDL2_PLAYER_SYNC value: " << sync << std::endl;
+        }
+    }
+    external_.set(NAN);
+}
+
+const char* SyncEngine::masterName(SyncMaster master)
+{
+    switch (master) {
+        case SyncMaster::VIDEO:    return "video";
+        case SyncMaster::EXTERNAL: return "external";
+        default:                   return "audio";
+    }
+}
+
+bool SyncEngine::parseMaster(const std::string& text, SyncMaster& master)
+{
+    if (text == "audio") master = SyncMaster::AUDIO;
+    else if (text == "video") master = SyncMaster::VIDEO;
+    else if (text == "external") master = SyncMaster::EXTERNAL;
+    else return false;
+    return true;
+}
+
+void SyncEngine::configureStreams(bool has_audio, bool has_video)
+{
+    SyncMaster master = preferred_.load();
+    if (master == SyncMaster::AUDIO && !has_audio) {
+        // 纯视频文件没有声卡时钟，按系统时钟匀速播放
+        master = SyncMaster::EXTERNAL;
+    } else if (master == SyncMaster::VIDEO && !has_video) {
+        master = has_audio ? SyncMaster::AUDIO : SyncMaster::EXTERNAL;
+    }
+
+    if (master != preferred_.load()) {
+        std::cout << "Sync: " << masterName(preferred_.load()) << " clock unavailable, using "
+                  << masterName(master) << std::endl;
+    }
+    master_.store(master);
+}
+
+double SyncEngine::masterClock() const
+{
+    switch (master_.load()) {
+        case SyncMaster::VIDEO:
+            return video_.get();
+        case SyncMaster::EXTERNAL: {
+            // 外部时钟尚未启动（第一帧之前）时以视频时钟代替
+            double external = external_.get();
+            return std::isnan(external) ? video_.get() : external;
+        }
+        default:
+            return audio_.get();
+    }
+}
+
+void SyncEngine::setSpeed(double speed)
+{
+    audio_.setSpeed(speed);
+    video_.setSpeed(speed);
+    external_.setSpeed(speed);
+}
+
+void SyncEngine::setPaused(bool paused)
+{
+    audio_.setPaused(paused);
+    video_.setPaused(paused);
+    external_.setPaused(paused);
+}
+
+void SyncEngine::resetTo(double pts)
+{
+    audio_.set(pts);
+    video_.set(pts);
+    external_.set(pts);
+    audio_drift_stale_.store(true);
+    video_drift_stale_.store(true);
+}
+
+void SyncEngine::reset()
+{
+    audio_.reset();
+    video_.reset();
+    external_.reset();
+    external_.set(NAN);
+    audio_drift_stale_.store(true);
+    video_drift_stale_.store(true);
+    audio_drift_avg_.store(0.0);
+    video_drift_avg_.store(0.0);
+}
+
+void SyncEngine::syncExternalTo(const Clock& clock)
+{
+    double external = external_.get();
+    double slave = clock.get();
+    if (std::isnan(slave)) return;
+    if (std::isnan(external) || std::fabs(external - slave) > SYNC_NOSYNC_THRESHOLD) {
+        external_.set(slave);
+    }
+}
+
+int SyncEngine::audioWantedSamples(int nb_samples, int sample_rate)
+{
+    if (audio_drift_stale_.exchange(false)) {
+        audio_drift_.reset();
+        audio_drift_avg_.store(0.0);
+    }
+    if (master_.load() == SyncMaster::AUDIO || sample_rate <= 0) {
+        return nb_samples;
+    }
+
+    double diff = audio_.get() - masterClock();
+    if (std::isnan(diff) || std::fabs(diff) >= SYNC_NOSYNC_THRESHOLD) {
+        // 时间轴跳变（seek、主时钟刚启动），重新开始估计
+        audio_drift_.reset();
+        return nb_samples;
+    }
+
+    audio_drift_.add(diff);
+    if (!audio_drift_.valid()) {
+        return nb_samples;
+    }
+
+    double average = audio_drift_.average();
+    audio_drift_avg_.store(average);
+    if (std::fabs(average) < SYNC_AUDIO_DRIFT_THRESHOLD) {
+        return nb_samples;
+    }
+
+    // 音频超前（diff > 0）时少输出样本，落后时多输出，单帧调整幅度有上限
+    int wanted = nb_samples - static_cast<int>(diff * sample_rate);
+    int min_samples = nb_samples * (100 - SYNC_SAMPLE_CORRECTION_PERCENT_MAX) / 100;
+    int max_samples = nb_samples * (100 + SYNC_SAMPLE_CORRECTION_PERCENT_MAX) / 100;
+    return std::max(min_samples, std::min(max_samples, wanted));
+}
+
+void SyncEngine::reportVideoDrift(double diff)
+{
+    if (video_drift_stale_.exchange(false)) {
+        video_drift_.reset();
+        video_drift_avg_.store(0.0);
+    }
+    if (std::isnan(diff) || std::fabs(diff) >= SYNC_NOSYNC_THRESHOLD) {
+        return;
+    }
+    video_drift_.add(diff);
+    if (video_drift_.valid()) {
+        video_drift_avg_.store(video_drift_.average());
+    }
+}
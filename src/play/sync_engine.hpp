@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include "clock.hpp"
+#include "../player_core/utils/player_constants.hpp"
+
+/**
+ * 主时钟来源。
+ */
+enum class SyncMaster
+{
+    AUDIO,      // 以声卡实际播放位置为准（默认）
+    VIDEO,      // 以显示的视频帧为准，音频增删样本跟随
+    EXTERNAL    // 独立的系统时钟，音视频都跟随
+};
+
+/**
+ * 时钟偏差的指数平滑（窗口内权重衰减到 1%），积累满一个窗口后 average 才有效。
+ * 单线程使用。
+ */
+class DriftEstimator
+{
+public:
+    explicit DriftEstimator(int window = SYNC_DRIFT_WINDOW);
+
+    void add(double diff);
+    bool valid() const { return count_ >= window_; }
+    double average() const { return cum_ * (1.0 - coef_); }
+    void reset();
+
+private:
+    int window_;
+    double coef_;
+    double cum_ = 0.0;
+    int count_ = 0;
+};
+
+/**
+ * 音视频同步引擎：选择主时钟，管理三个时钟的速度/暂停，估计从时钟相对主时钟的漂移。
+ *
+ * 优先的主时钟由环境变量 SDL2_PLAYER_SYNC=audio|video|external 指定；打开文件后按实际存在的流
+ * 确定生效的主时钟（例如纯视频文件退回外部时钟）。外部时钟在第一次被从时钟更新时启动。
+ */
+class SyncEngine
+{
+public:
+    SyncEngine(Clock& audio, Clock& video, Clock& external);
+
+    static const char* masterName(SyncMaster master);
+    static bool parseMaster(const std::string& text, SyncMaster& master);
+
+    void setPreferredMaster(SyncMaster master) { preferred_.store(master); }
+    SyncMaster preferredMaster() const { return preferred_.load(); }
+
+    // 找到音视频流之后调用，决定生效的主时钟
+    void configureStreams(bool has_audio, bool has_video);
+    SyncMaster master() const { return master_.load(); }
+    double masterClock() const;
+
+    // 速度和暂停同时作用于三个时钟
+    void setSpeed(double speed);
+    double speed() const { return audio_.speed(); }
+    void setPaused(bool paused);
+
+    // 三个时钟跳到同一位置（seek），并清空漂移估计
+    void resetTo(double pts);
+    // 新文件：外部时钟回到未启动状态
+    void reset();
+
+    // 从时钟更新后调用：外部时钟未启动或与该时钟相差过大时跟随它
+    void syncExternalTo(const Clock& clock);
+
+    // 音频不是主时钟时，按平滑后的漂移计算这一帧期望的样本数（限制在 ±SYNC_SAMPLE_CORRECTION_PERCENT_MAX）
+    int audioWantedSamples(int nb_samples, int sample_rate);
+
+    // 视频帧显示时记录其 pts 与主时钟的偏差
+    void reportVideoDrift(double diff);
+
+    // 声卡延迟（设备缓冲区内尚未播放的时长）
+    void setAudioLatency(double seconds) { audio_latency_.store(seconds); }
+    double audioLatency() const { return audio_latency_.load(); }
+
+    // 平滑后的偏差（从时钟 - 主时钟，秒），未积累满窗口时为 0
+    double audioDrift() const { return audio_drift_avg_.load(); }
+    double videoDrift() const { return video_drift_avg_.load(); }
+
+private:
+    Clock& audio_;
+    Clock& video_;
+    Clock& external_;
+
+    std::atomic<SyncMaster> preferred_{SyncMaster::AUDIO};
+    std::atomic<SyncMaster> master_{SyncMaster::AUDIO};
+
+    // 估计器只在各自的线程使用（音频回调 / 主线程），平均值经原子变量给 UI 读取
+    DriftEstimator audio_drift_;
+    DriftEstimator video_drift_;
+    std::atomic<bool> audio_drift_stale_{false};   // seek 后由所属线程自行清空估计器
+    std::atomic<bool> video_drift_stale_{false};
+    std::atomic<double> audio_drift_avg_{0.0};
+    std::atomic<double> video_drift_avg_{0.0};
+    std::atomic<double> audio_latency_{0.0};
+};
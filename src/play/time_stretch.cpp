@@ -0,0 +1,197 @@
+#include "time_stretch.hpp"
+#include "../player_core/utils/player_constants.hpp"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+bool TimeStretcher::configure(int sample_rate, int channels)
+{
+    if (sample_rate <= 0 || channels <= 0) return false;
+
+    sample_rate_ = sample_rate;
+    channels_ = channels;
+    hop_ = std::max(1, static_cast<int>(sample_rate * TIME_STRETCH_WINDOW_MS / 2000.0));
+    window_ = hop_ * 2;
+    seek_ = std::max(1, static_cast<int>(sample_rate * TIME_STRETCH_SEEK_MS / 1000.0));
+
+    // 周期 Hann 窗：50% 重叠相加后增益恒为 1
+    const double two_pi = 2.0 * std::acos(-1.0);
+    hann_.resize(window_);
+    for (int i = 0; i < window_; i++) {
+        hann_[i] = static_cast<float>(0.5 - 0.5 * std::cos(two_pi * i / window_));
+    }
+
+    reset();
+    return true;
+}
+
+void TimeStretcher::reset()
+{
+    input_.clear();
+    mono_.clear();
+    input_frames_ = 0;
+    in_pos_ = 0.0;
+    prev_pos_ = 0;
+    started_ = false;
+    overlap_.assign(static_cast<size_t>(hop_) * channels_, 0.0f);
+    output_.clear();
+    output_read_ = 0;
+}
+
+template <typename T>
+void TimeStretcher::pushSamples(const T* samples, int frames, float scale)
+{
+    if (!isConfigured() || !samples || frames <= 0) return;
+
+    input_.reserve(input_.size() + static_cast<size_t>(frames) * channels_);
+    mono_.reserve(mono_.size() + frames);
+    const float mono_scale = 1.0f / channels_;
+    for (int i = 0; i < frames; i++) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels_; c++) {
+            float v = samples[i * channels_ + c] * scale;
+            input_.push_back(v);
+            sum += v;
+        }
+        mono_.push_back(sum * mono_scale);
+    }
+    input_frames_ += frames;
+
+    while (processStep()) {
+    }
+}
+
+void TimeStretcher::push(const int16_t* samples, int frames)
+{
+    pushSamples(samples, frames, 1.0f);
+}
+
+void TimeStretcher::push(const float* samples, int frames)
+{
+    pushSamples(samples, frames, 32768.0f);
+}
+
+size_t TimeStretcher::availableOutput(int max_frames) const
+{
+    size_t available = (output_.size() - output_read_) / channels_;
+    return std::min<size_t>(available, max_frames > 0 ? max_frames : 0);
+}
+
+void TimeStretcher::advanceOutput(size_t frames)
+{
+    output_read_ += frames * channels_;
+    if (output_read_ == output_.size()) {
+        output_.clear();
+        output_read_ = 0;
+    }
+}
+
+int TimeStretcher::pull(int16_t* out, int max_frames)
+{
+    size_t frames = availableOutput(max_frames);
+    const float* src = output_.data() + output_read_;
+    for (size_t i = 0; i < frames * channels_; i++) {
+        out[i] = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, std::round(src[i]))));
+    }
+    advanceOutput(frames);
+    return static_cast<int>(frames);
+}
+
+int TimeStretcher::pull(float* out, int max_frames)
+{
+    size_t frames = availableOutput(max_frames);
+    const float* src = output_.data() + output_read_;
+    for (size_t i = 0; i < frames * channels_; i++) {
+        out[i] = src[i] * (1.0f / 32768.0f);
+    }
+    advanceOutput(frames);
+    return static_cast<int>(frames);
+}
+
+double TimeStretcher::bufferedSeconds() const
+{
+    if (!isConfigured()) return 0.0;
+    // 已输出的部分对应到名义输入位置 in_pos_ 为止；等待取走的输出按速度折算成媒体时长
+    double pending_output = static_cast<double>(output_.size() - output_read_) / channels_;
+    return (std::max(0.0, input_frames_ - in_pos_) + pending_output * speed_) / sample_rate_;
+}
+
+bool TimeStretcher::processStep()
+{
+    int nominal = static_cast<int>(std::lround(in_pos_));
+    int pos = nominal;
+    if (!started_) {
+        if (input_frames_ < nominal + window_) return false;
+        started_ = true;
+    } else {
+        // 上一段的自然延续用于比较，候选位置需要完整的一个窗
+        int natural = prev_pos_ + hop_;
+        if (input_frames_ < std::max(nominal + seek_ + window_, natural + hop_)) return false;
+        pos = bestOffset(natural, nominal);
+    }
+
+    // 前半窗与上一段的后半窗相加后输出，后半窗留给下一段
+    size_t out_start = output_.size();
+    output_.resize(out_start + static_cast<size_t>(hop_) * channels_);
+    const float* seg = input_.data() + static_cast<size_t>(pos) * channels_;
+    for (int i = 0; i < hop_; i++) {
+        for (int c = 0; c < channels_; c++) {
+            size_t k = static_cast<size_t>(i) * channels_ + c;
+            float v = overlap_[k] + seg[k] * hann_[i];
+            output_[out_start + k] = v;
+            overlap_[k] = seg[static_cast<size_t>(hop_) * channels_ + k] * hann_[hop_ + i];
+        }
+    }
+
+    prev_pos_ = pos;
+    in_pos_ += hop_ * speed_;
+
+    // 下一步只会用到自然延续位置和名义位置 - seek_ 之后的输入，之前的丢弃
+    int discard = std::min(prev_pos_ + hop_, static_cast<int>(std::lround(in_pos_)) - seek_);
+    if (discard > 0) {
+        input_.erase(input_.begin(), input_.begin() + static_cast<size_t>(discard) * channels_);
+        mono_.erase(mono_.begin(), mono_.begin() + discard);
+        input_frames_ -= discard;
+        in_pos_ -= discard;
+        prev_pos_ -= discard;
+    }
+    return true;
+}
+
+int TimeStretcher::bestOffset(int natural, int nominal) const
+{
+    int lo = std::max(0, nominal - seek_);
+    int hi = nominal + seek_;
+
+    // 隔点粗搜，再在最优点两侧细搜
+    int best = nominal;
+    double best_score = -1e300;
+    for (int cand = lo; cand <= hi; cand += 2) {
+        double score = similarity(natural, cand);
+        if (score > best_score) {
+            best_score = score;
+            best = cand;
+        }
+    }
+    for (int cand = std::max(lo, best - 1); cand <= std::min(hi, best + 1); cand++) {
+        double score = similarity(natural, cand);
+        if (score > best_score) {
+            best_score = score;
+            best = cand;
+        }
+    }
+    return best;
+}
+
+double TimeStretcher::similarity(int a, int b) const
+{
+    // 归一化互相关，只按候选段能量归一（自然延续段对所有候选相同）
+    const float* x = mono_.data() + a;
+    const float* y = mono_.data() + b;
+    double corr = 0.0, energy = 0.0;
+    for (int i = 0; i < hop_; i += 2) {
+        corr += x[i] * y[i];
+        energy += y[i] * y[i];
+    }
+    return corr / std::sqrt(energy + 1.0);
+}
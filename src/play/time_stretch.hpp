@@ -0,0 +1,64 @@
+// 变速不变调（WSOLA）
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * WSOLA 时间伸缩：改变播放速度而不改变音高，处理交错 S16 或 F32 PCM（内部统一按 S16 的量程计算）。
+ *
+ * 输出按固定步长（半个窗长）用 Hann 窗重叠相加；每一步的输入位置按速度前进，并在 ±TIME_STRETCH_SEEK_MS
+ * 内选择与上一段自然延续最相似（归一化互相关最大）的位置，避免拼接处相位抵消产生的"回声"感。
+ * 相似度在下混的单声道上计算，先隔点粗搜再在最优点附近细搜。只在音频供给线程使用（AudioPlayer::feederLoop）。
+ */
+class TimeStretcher
+{
+public:
+    bool configure(int sample_rate, int channels);
+    bool isConfigured() const { return window_ > 0; }
+
+    void setSpeed(double speed) { speed_ = speed; }
+    double speed() const { return speed_; }
+
+    // 送入 frames 个采样帧（每帧 channels 个样本）
+    void push(const int16_t* samples, int frames);
+    void push(const float* samples, int frames);
+    // 取出最多 max_frames 个采样帧，返回实际帧数；输入不足时可能为 0
+    int pull(int16_t* out, int max_frames);
+    int pull(float* out, int max_frames);
+
+    // 已送入但尚未体现在输出中的媒体时长（秒），用于修正音频时钟
+    double bufferedSeconds() const;
+
+    // 丢弃所有缓冲（seek、速度回到 1x）
+    void reset();
+
+private:
+    template <typename T>
+    void pushSamples(const T* samples, int frames, float scale);
+    size_t availableOutput(int max_frames) const;
+    void advanceOutput(size_t frames);
+    bool processStep();
+    int bestOffset(int natural, int nominal) const;
+    double similarity(int a, int b) const;
+
+    int sample_rate_ = 0;
+    int channels_ = 0;
+    int window_ = 0;        // 窗长（帧）
+    int hop_ = 0;           // 合成步长 = 窗长 / 2
+    int seek_ = 0;          // 搜索范围（帧）
+    double speed_ = 1.0;
+
+    std::vector<float> hann_;
+    std::vector<float> input_;      // 交错浮点输入
+    std::vector<float> mono_;       // 下混单声道，用于相似度搜索
+    int input_frames_ = 0;
+    double in_pos_ = 0.0;           // 下一段的名义输入位置（相对 input_ 起点）
+    int prev_pos_ = 0;              // 上一段实际采用的输入位置（丢弃已用输入后可能为负）
+    bool started_ = false;          // 是否已经输出过第一段
+    std::vector<float> overlap_;    // 上一段后半窗，与下一段前半窗相加
+    std::vector<float> output_;     // 已完成、等待取走的输出
+    size_t output_read_ = 0;
+};
@@ -0,0 +1,139 @@
+#include "video_format.hpp"
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+namespace {
+
+struct LumaCoefficients
+{
+    double kr;
+    double kb;
+};
+
+LumaCoefficients coefficientsOf(AVColorSpace colorspace)
+{
+    switch (colorspace) {
+        case AVCOL_SPC_BT709:      return {0.2126, 0.0722};
+        case AVCOL_SPC_SMPTE240M:  return {0.212, 0.087};
+        case AVCOL_SPC_FCC:        return {0.30, 0.11};
+        case AVCOL_SPC_BT2020_NCL:
+        case AVCOL_SPC_BT2020_CL:  return {0.2627, 0.0593};   // CL 按 NCL 近似
+        default:                   return {0.299, 0.114};     // BT.601
+    }
+}
+
+} // namespace
+
+AVColorSpace resolveColorSpace(AVColorSpace colorspace, int height)
+{
+    switch (colorspace) {
+        case AVCOL_SPC_BT709:
+        case AVCOL_SPC_BT470BG:
+        case AVCOL_SPC_SMPTE170M:
+        case AVCOL_SPC_SMPTE240M:
+        case AVCOL_SPC_FCC:
+        case AVCOL_SPC_BT2020_NCL:
+        case AVCOL_SPC_BT2020_CL:
+            return colorspace;
+        default:
+            // 未标注：高清按 BT.709，标清按 BT.601（与 FFmpeg/mpv 的默认推断一致）
+            return height >= 720 ? AVCOL_SPC_BT709 : AVCOL_SPC_SMPTE170M;
+    }
+}
+
+bool describeVideoFormat(AVPixelFormat pix_fmt, VideoFormatLayout& layout)
+{
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(pix_fmt);
+    if (!desc) return false;
+
+    const uint64_t unsupported = AV_PIX_FMT_FLAG_BE | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM |
+                                 AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_BAYER |
+                                 AV_PIX_FMT_FLAG_FLOAT;
+    if ((desc->flags & unsupported) || !(desc->flags & AV_PIX_FMT_FLAG_PLANAR) || desc->nb_components < 3) {
+        return false;
+    }
+
+    int depth = desc->comp[0].depth;
+    if (depth > 16 || desc->comp[1].depth != depth || desc->comp[2].depth != depth) return false;
+
+    int bytes = depth > 8 ? 2 : 1;
+    if (desc->comp[0].plane != 0 || desc->comp[0].step != bytes) return false;
+
+    if (desc->comp[1].plane == desc->comp[2].plane) {
+        // 半平面：只接受 U 在前的交错顺序（NV12/P010/P016），NV21 等交给转换
+        if (desc->comp[1].plane != 1 || desc->comp[1].step != 2 * bytes ||
+            desc->comp[1].offset != 0 || desc->comp[2].offset != bytes) {
+            return false;
+        }
+        layout.plane_count = 2;
+    } else {
+        if (desc->comp[1].plane != 1 || desc->comp[2].plane != 2 ||
+            desc->comp[1].step != bytes || desc->comp[2].step != bytes) {
+            return false;
+        }
+        layout.plane_count = 3;
+    }
+
+    layout.chroma_shift_x = desc->log2_chroma_w;
+    layout.chroma_shift_y = desc->log2_chroma_h;
+    layout.bytes_per_sample = bytes;
+    layout.bit_depth = depth;
+    layout.sample_shift = desc->comp[0].shift;
+    layout.full_range = pix_fmt == AV_PIX_FMT_YUVJ420P || pix_fmt == AV_PIX_FMT_YUVJ422P ||
+                        pix_fmt == AV_PIX_FMT_YUVJ444P;
+    return true;
+}
+
+YuvColorMatrix computeYuvColorMatrix(const VideoFormatLayout& layout, AVColorSpace colorspace,
+                                     AVColorRange range, int height)
+{
+    LumaCoefficients k = coefficientsOf(resolveColorSpace(colorspace, height));
+    double kg = 1.0 - k.kr - k.kb;
+
+    // 行 = R/G/B，列 = Y/Cb/Cr（均为 [0,1] / [-0.5,0.5] 的理想值）
+    const double rgb[3][3] = {
+        {1.0, 0.0,                                2.0 * (1.0 - k.kr)},
+        {1.0, -2.0 * k.kb * (1.0 - k.kb) / kg,    -2.0 * k.kr * (1.0 - k.kr) / kg},
+        {1.0, 2.0 * (1.0 - k.kb),                 0.0},
+    };
+
+    // 纹理采样值 -> 码值：8 位纹理乘 255；16 位纹理乘 65535 后去掉容器中的左移
+    double code_scale = layout.bytes_per_sample == 2 ? 65535.0 / (1 << layout.sample_shift) : 255.0;
+
+    int depth_shift = layout.bit_depth - 8;
+    double max_code = (1 << layout.bit_depth) - 1;
+    bool full = layout.full_range || range == AVCOL_RANGE_JPEG;
+
+    double y_off = full ? 0.0 : 16 << depth_shift;
+    double y_range = full ? max_code : 219 << depth_shift;
+    double c_off = 1 << (layout.bit_depth - 1);
+    double c_range = full ? max_code : 224 << depth_shift;
+
+    const double off[3] = {y_off, c_off, c_off};
+    const double scale[3] = {code_scale / y_range, code_scale / c_range, code_scale / c_range};
+
+    YuvColorMatrix out;
+    for (int row = 0; row < 3; row++) {
+        double bias = 0.0;
+        for (int col = 0; col < 3; col++) {
+            out.matrix[col * 3 + row] = static_cast<float>(rgb[row][col] * scale[col]);
+            bias -= rgb[row][col] * off[col] / (col == 0 ? y_range : c_range);
+        }
+        out.offset[row] = static_cast<float>(bias);
+    }
+    return out;
+}
+
+const char* colorSpaceName(AVColorSpace colorspace, int height)
+{
+    switch (resolveColorSpace(colorspace, height)) {
+        case AVCOL_SPC_BT709:      return "BT.709";
+        case AVCOL_SPC_SMPTE240M:  return "SMPTE 240M";
+        case AVCOL_SPC_FCC:        return "FCC";
+        case AVCOL_SPC_BT2020_NCL:
+        case AVCOL_SPC_BT2020_CL:  return "BT.2020";
+        default:                   return "BT.601";
+    }
+}
@@ -0,0 +1,49 @@
+// video_format.hpp
+#pragma once
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+/**
+ * GPU 可直接采样的 YUV 像素格式描述。
+ *
+ * 三平面（yuv420p/422p/444p 及其高位深版本）每个平面一张单通道纹理；
+ * 半平面（NV12/P010/P016）的 UV 交错在一张双通道纹理中。
+ */
+struct VideoFormatLayout
+{
+    int plane_count = 3;        // 2 = 半平面，3 = 三平面
+    int chroma_shift_x = 1;     // 色度平面相对亮度的宽/高缩小位数
+    int chroma_shift_y = 1;
+    int bytes_per_sample = 1;   // 1 或 2（高位深用 16 位纹理）
+    int bit_depth = 8;
+    int sample_shift = 0;       // 有效位在 16 位容器中左移的位数（P010 为 6）
+    bool full_range = false;    // yuvj* 格式隐含全范围
+
+    int chromaWidth(int width) const { return -((-width) >> chroma_shift_x); }
+    int chromaHeight(int height) const { return -((-height) >> chroma_shift_y); }
+};
+
+/**
+ * YUV 到 RGB 的变换：rgb = matrix * tex + offset，tex 是纹理采样得到的归一化值。
+ * 位深、存储对齐和有限/全范围都已折算进矩阵和偏移。matrix 按列主序存放，可直接传给 glUniformMatrix3fv。
+ */
+struct YuvColorMatrix
+{
+    float matrix[9];
+    float offset[3];
+};
+
+// 返回 false 表示该格式不能直接采样（RGB、大端、调色板、硬件帧等），需要先转换
+bool describeVideoFormat(AVPixelFormat pix_fmt, VideoFormatLayout& layout);
+
+// 未标注或非 YUV 矩阵时按分辨率推断：>= 720 行用 BT.709，否则 BT.601
+AVColorSpace resolveColorSpace(AVColorSpace colorspace, int height);
+
+// 按帧的 colorspace / color_range 计算变换；未标注时按分辨率推断（>= 720 行用 BT.709，否则 BT.601）
+YuvColorMatrix computeYuvColorMatrix(const VideoFormatLayout& layout, AVColorSpace colorspace,
+                                     AVColorRange range, int height);
+
+const char* colorSpaceName(AVColorSpace colorspace, int height);
@@ -0,0 +1,358 @@
+#include "yuv_convert.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if PLAYER_SIMD_X86
+#include <immintrin.h>
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace {
+
+inline uint8_t clampByte(int32_t v)
+{
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// ---------------------------------------------------------------------------
+// YUV -> RGBA 行内核。SHIFT_X = 1 时相邻两个亮度像素共用一个色度样本（4:2:0 / 4:2:2）
+
+template <int SHIFT_X>
+void yuvRowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                  uint8_t* dst, int width, const YuvToRgbaConverter::Coefficients& c)
+{
+    for (int x = 0; x < width; x++) {
+        int32_t Y = y[x];
+        int32_t U = u[x >> SHIFT_X];
+        int32_t V = v[x >> SHIFT_X];
+        dst[4 * x + 0] = clampByte((c.k[0][0] * Y + c.k[0][1] * U + c.k[0][2] * V + c.bias[0]) >> 16);
+        dst[4 * x + 1] = clampByte((c.k[1][0] * Y + c.k[1][1] * U + c.k[1][2] * V + c.bias[1]) >> 16);
+        dst[4 * x + 2] = clampByte((c.k[2][0] * Y + c.k[2][1] * U + c.k[2][2] * V + c.bias[2]) >> 16);
+        dst[4 * x + 3] = 255;
+    }
+}
+
+#if PLAYER_SIMD_X86
+
+template <int SHIFT_X>
+SIMD_TARGET("sse4.1")
+void yuvRowSse41(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                 uint8_t* dst, int width, const YuvToRgbaConverter::Coefficients& c)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max = _mm_set1_epi32(255);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int32_t>(0xFF000000u));
+
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        int32_t y4, u4, v4;
+        std::memcpy(&y4, y + x, 4);
+        __m128i Y = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(y4));
+        __m128i U, V;
+        if (SHIFT_X) {
+            uint16_t u2, v2;
+            std::memcpy(&u2, u + (x >> 1), 2);
+            std::memcpy(&v2, v + (x >> 1), 2);
+            U = _mm_shuffle_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(u2)), _MM_SHUFFLE(1, 1, 0, 0));
+            V = _mm_shuffle_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(v2)), _MM_SHUFFLE(1, 1, 0, 0));
+        } else {
+            std::memcpy(&u4, u + x, 4);
+            std::memcpy(&v4, v + x, 4);
+            U = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(u4));
+            V = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(v4));
+        }
+
+        __m128i out = alpha;
+        for (int ch = 0; ch < 3; ch++) {
+            __m128i acc = _mm_add_epi32(_mm_mullo_epi32(Y, _mm_set1_epi32(c.k[ch][0])),
+                                        _mm_mullo_epi32(U, _mm_set1_epi32(c.k[ch][1])));
+            acc = _mm_add_epi32(acc, _mm_mullo_epi32(V, _mm_set1_epi32(c.k[ch][2])));
+            acc = _mm_srai_epi32(_mm_add_epi32(acc, _mm_set1_epi32(c.bias[ch])), 16);
+            acc = _mm_min_epi32(_mm_max_epi32(acc, zero), max);
+            out = _mm_or_si128(out, _mm_slli_epi32(acc, 8 * ch));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * x), out);
+    }
+
+    if (x < width) {
+        yuvRowScalar<SHIFT_X>(y + x, u + (x >> SHIFT_X), v + (x >> SHIFT_X), dst + 4 * x, width - x, c);
+    }
+}
+
+template <int SHIFT_X>
+SIMD_TARGET("avx2")
+void yuvRowAvx2(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                uint8_t* dst, int width, const YuvToRgbaConverter::Coefficients& c)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi32(255);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int32_t>(0xFF000000u));
+    const __m256i dup = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m256i Y = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x)));
+        __m256i U, V;
+        if (SHIFT_X) {
+            int32_t u4, v4;
+            std::memcpy(&u4, u + (x >> 1), 4);
+            std::memcpy(&v4, v + (x >> 1), 4);
+            U = _mm256_permutevar8x32_epi32(_mm256_cvtepu8_epi32(_mm_cvtsi32_si128(u4)), dup);
+            V = _mm256_permutevar8x32_epi32(_mm256_cvtepu8_epi32(_mm_cvtsi32_si128(v4)), dup);
+        } else {
+            U = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x)));
+            V = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x)));
+        }
+
+        __m256i out = alpha;
+        for (int ch = 0; ch < 3; ch++) {
+            __m256i acc = _mm256_add_epi32(_mm256_mullo_epi32(Y, _mm256_set1_epi32(c.k[ch][0])),
+                                           _mm256_mullo_epi32(U, _mm256_set1_epi32(c.k[ch][1])));
+            acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(V, _mm256_set1_epi32(c.k[ch][2])));
+            acc = _mm256_srai_epi32(_mm256_add_epi32(acc, _mm256_set1_epi32(c.bias[ch])), 16);
+            acc = _mm256_min_epi32(_mm256_max_epi32(acc, zero), max);
+            out = _mm256_or_si256(out, _mm256_slli_epi32(acc, 8 * ch));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 4 * x), out);
+    }
+
+    if (x < width) {
+        yuvRowScalar<SHIFT_X>(y + x, u + (x >> SHIFT_X), v + (x >> SHIFT_X), dst + 4 * x, width - x, c);
+    }
+}
+
+#endif // PLAYER_SIMD_X86
+
+// ---------------------------------------------------------------------------
+// 垂直混合：out = (a * (256 - f) + b * f + 128) >> 8，16 位无符号运算不会溢出（最大 65408）
+
+void blendRowScalar(const uint8_t* a, const uint8_t* b, uint8_t* dst, int width, int frac)
+{
+    int inv = 256 - frac;
+    for (int x = 0; x < width; x++) {
+        dst[x] = static_cast<uint8_t>((a[x] * inv + b[x] * frac + 128) >> 8);
+    }
+}
+
+#if PLAYER_SIMD_X86
+
+SIMD_TARGET("sse4.1")
+void blendRowSse41(const uint8_t* a, const uint8_t* b, uint8_t* dst, int width, int frac)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wa = _mm_set1_epi16(static_cast<int16_t>(256 - frac));
+    const __m128i wb = _mm_set1_epi16(static_cast<int16_t>(frac));
+    const __m128i round = _mm_set1_epi16(128);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + x));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + x));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(lo, hi));
+    }
+    if (x < width) blendRowScalar(a + x, b + x, dst + x, width - x, frac);
+}
+
+SIMD_TARGET("avx2")
+void blendRowAvx2(const uint8_t* a, const uint8_t* b, uint8_t* dst, int width, int frac)
+{
+    const __m256i wa = _mm256_set1_epi16(static_cast<int16_t>(256 - frac));
+    const __m256i wb = _mm256_set1_epi16(static_cast<int16_t>(frac));
+    const __m256i round = _mm256_set1_epi16(128);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m256i va = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + x)));
+        __m256i vb = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + x)));
+        __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(va, wa), _mm256_mullo_epi16(vb, wb));
+        sum = _mm256_srli_epi16(_mm256_add_epi16(sum, round), 8);
+        // packus 按 128 位通道打包，先把高半部分移到低通道
+        __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), packed);
+    }
+    if (x < width) blendRowScalar(a + x, b + x, dst + x, width - x, frac);
+}
+
+#endif // PLAYER_SIMD_X86
+
+using BlendFunc = void (*)(const uint8_t*, const uint8_t*, uint8_t*, int, int);
+
+BlendFunc blendFuncFor(SimdLevel level)
+{
+#if PLAYER_SIMD_X86
+    if (level == SimdLevel::AVX2) return blendRowAvx2;
+    if (level == SimdLevel::SSE41) return blendRowSse41;
+#endif
+    (void)level;
+    return blendRowScalar;
+}
+
+// 像素中心对齐的源坐标，拆成整数部分和 8 位小数权重
+void buildAxis(int src_size, int dst_size, std::vector<int32_t>& index, std::vector<uint16_t>& frac)
+{
+    index.resize(dst_size);
+    frac.resize(dst_size);
+    double ratio = static_cast<double>(src_size) / dst_size;
+    for (int i = 0; i < dst_size; i++) {
+        double pos = (i + 0.5) * ratio - 0.5;
+        pos = std::max(0.0, std::min(pos, static_cast<double>(src_size - 1)));
+        int base = static_cast<int>(pos);
+        int weight = static_cast<int>(std::lround((pos - base) * 256.0));
+        if (base >= src_size - 1) { base = src_size - 1; weight = 0; }
+        if (weight == 256) { base++; weight = 0; }
+        index[i] = base;
+        frac[i] = static_cast<uint16_t>(weight);
+    }
+}
+
+} // namespace
+
+bool YuvToRgbaConverter::supports(AVPixelFormat pix_fmt)
+{
+    VideoFormatLayout layout;
+    return describeVideoFormat(pix_fmt, layout) && layout.plane_count == 3 &&
+           layout.bit_depth == 8 && layout.chroma_shift_x <= 1 && layout.chroma_shift_y <= 1;
+}
+
+bool YuvToRgbaConverter::configure(AVPixelFormat pix_fmt, int width, int height, SimdLevel level)
+{
+    row_ = nullptr;
+    if (!supports(pix_fmt) || width <= 0 || height <= 0) return false;
+
+    describeVideoFormat(pix_fmt, layout_);
+    pix_fmt_ = pix_fmt;
+    width_ = width;
+    height_ = height;
+    level_ = level;
+    color_key_ = -1;
+
+    bool shared = layout_.chroma_shift_x == 1;
+#if PLAYER_SIMD_X86
+    if (level == SimdLevel::AVX2) {
+        row_ = shared ? yuvRowAvx2<1> : yuvRowAvx2<0>;
+    } else if (level == SimdLevel::SSE41) {
+        row_ = shared ? yuvRowSse41<1> : yuvRowSse41<0>;
+    }
+#endif
+    if (!row_) {
+        level_ = SimdLevel::SCALAR;
+        row_ = shared ? yuvRowScalar<1> : yuvRowScalar<0>;
+    }
+
+    setColorspace(AVCOL_SPC_UNSPECIFIED, AVCOL_RANGE_UNSPECIFIED);
+    return true;
+}
+
+void YuvToRgbaConverter::setColorspace(AVColorSpace colorspace, AVColorRange range)
+{
+    int key = colorspace * 16 + range;
+    if (key == color_key_) return;
+    color_key_ = key;
+
+    // GPU 路径的矩阵作用于 code/255 的归一化值，输出 [0,1]；这里输入是码值、输出 0~255：
+    // out = 255 * (M * code / 255 + o) = M * code + 255 * o
+    YuvColorMatrix m = computeYuvColorMatrix(layout_, colorspace, range, height_);
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            coeffs_.k[row][col] = static_cast<int32_t>(std::lround(m.matrix[col * 3 + row] * 65536.0));
+        }
+        coeffs_.bias[row] = static_cast<int32_t>(std::lround(m.offset[row] * 255.0 * 65536.0)) + (1 << 15);
+    }
+}
+
+void YuvToRgbaConverter::convert(const uint8_t* const src[3], const int src_stride[3],
+                                 uint8_t* dst, int dst_stride) const
+{
+    if (!row_) return;
+    for (int y = 0; y < height_; y++) {
+        int cy = y >> layout_.chroma_shift_y;
+        row_(src[0] + static_cast<ptrdiff_t>(y) * src_stride[0],
+             src[1] + static_cast<ptrdiff_t>(cy) * src_stride[1],
+             src[2] + static_cast<ptrdiff_t>(cy) * src_stride[2],
+             dst + static_cast<ptrdiff_t>(y) * dst_stride, width_, coeffs_);
+    }
+}
+
+bool YuvToRgbaConverter::convertFrame(const AVFrame* frame, uint8_t* dst, int dst_stride)
+{
+    if (!row_ || !frame || frame->format != pix_fmt_ ||
+        frame->width != width_ || frame->height != height_) {
+        return false;
+    }
+    setColorspace(frame->colorspace, frame->color_range);
+    const uint8_t* const src[3] = {frame->data[0], frame->data[1], frame->data[2]};
+    const int stride[3] = {frame->linesize[0], frame->linesize[1], frame->linesize[2]};
+    convert(src, stride, dst, dst_stride);
+    return true;
+}
+
+bool PlaneScaler::configure(int src_width, int src_height, int dst_width, int dst_height, SimdLevel level)
+{
+    if (src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0) return false;
+
+    src_width_ = src_width;
+    src_height_ = src_height;
+    dst_width_ = dst_width;
+    dst_height_ = dst_height;
+    level_ = PLAYER_SIMD_X86 ? level : SimdLevel::SCALAR;
+
+    buildAxis(src_width, dst_width, x_index_, x_frac_);
+    buildAxis(src_height, dst_height, y_index_, y_frac_);
+    for (auto& row : rows_) row.resize(dst_width);
+    cached_row_[0] = cached_row_[1] = -1;
+    return true;
+}
+
+const uint8_t* PlaneScaler::horizontalRow(const uint8_t* src, int src_stride, int row, int slot)
+{
+    // 另一个槽位已缓存该行时直接复用（放大时相邻输出行常落在同一对源行之间）
+    for (int i = 0; i < 2; i++) {
+        if (cached_row_[i] == row) return rows_[i].data();
+    }
+
+    const uint8_t* line = src + static_cast<ptrdiff_t>(row) * src_stride;
+    uint8_t* out = rows_[slot].data();
+    int last = src_width_ - 1;
+    for (int x = 0; x < dst_width_; x++) {
+        int i = x_index_[x];
+        int f = x_frac_[x];
+        int right = i < last ? i + 1 : last;
+        out[x] = static_cast<uint8_t>((line[i] * (256 - f) + line[right] * f + 128) >> 8);
+    }
+    cached_row_[slot] = row;
+    return out;
+}
+
+void PlaneScaler::scale(const uint8_t* src, int src_stride, uint8_t* dst, int dst_stride)
+{
+    if (dst_width_ <= 0) return;
+
+    // 每次调用都是新的源图像，行缓存失效
+    cached_row_[0] = cached_row_[1] = -1;
+    BlendFunc blend = blendFuncFor(level_);
+    int last = src_height_ - 1;
+
+    for (int y = 0; y < dst_height_; y++) {
+        int top = y_index_[y];
+        int bottom = top < last ? top + 1 : last;
+        int frac = y_frac_[y];
+
+        // 上下两行放在不同槽位，避免互相覆盖
+        int top_slot = cached_row_[1] == top ? 1 : 0;
+        const uint8_t* a = horizontalRow(src, src_stride, top, top_slot);
+        uint8_t* out = dst + static_cast<ptrdiff_t>(y) * dst_stride;
+        if (frac == 0) {
+            std::memcpy(out, a, dst_width_);
+            continue;
+        }
+        const uint8_t* b = horizontalRow(src, src_stride, bottom, 1 - top_slot);
+        blend(a, b, out, dst_width_, frac);
+    }
+}
@@ -0,0 +1,90 @@
+// yuv_convert.hpp
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+#include "player_core/utils/cpu_features.hpp"
+#include "video_format.hpp"
+
+/**
+ * 8 位平面 YUV（4:2:0 / 4:2:2 / 4:4:4 / 4:4:0）到 RGBA 的转换，输出写入调用方提供的缓冲区。
+ *
+ * 按 CPU 在运行时选择 AVX2 / SSE4.1 / 标量实现，三者都是 16 位定点整数运算，结果逐位一致。
+ * 色彩矩阵与 GPU 路径共用 computeYuvColorMatrix，按帧的 colorspace/range 在变化时重算。
+ * 输出字节序为 R,G,B,A（对应 SDL_PIXELFORMAT_RGBA32）。
+ */
+class YuvToRgbaConverter
+{
+public:
+    struct Coefficients
+    {
+        int32_t k[3][3];    // 行 = R/G/B，列 = Y/U/V，16 位小数
+        int32_t bias[3];    // 含舍入
+    };
+
+    using RowFunc = void (*)(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                             uint8_t* dst, int width, const Coefficients& c);
+
+    // 是否能处理该格式（否则调用方应退回 sws_scale）
+    static bool supports(AVPixelFormat pix_fmt);
+
+    bool configure(AVPixelFormat pix_fmt, int width, int height, SimdLevel level = detectSimdLevel());
+    bool isConfigured() const { return row_ != nullptr; }
+    SimdLevel level() const { return level_; }
+
+    void setColorspace(AVColorSpace colorspace, AVColorRange range);
+
+    // dst 至少 height 行，每行 width * 4 字节
+    void convert(const uint8_t* const src[3], const int src_stride[3], uint8_t* dst, int dst_stride) const;
+
+    // 按帧的色彩标注更新矩阵后转换；格式或尺寸与 configure 不一致时返回 false
+    bool convertFrame(const AVFrame* frame, uint8_t* dst, int dst_stride);
+
+private:
+    VideoFormatLayout layout_;
+    AVPixelFormat pix_fmt_ = AV_PIX_FMT_NONE;
+    int width_ = 0;
+    int height_ = 0;
+    SimdLevel level_ = SimdLevel::SCALAR;
+    RowFunc row_ = nullptr;
+    Coefficients coeffs_{};
+    int color_key_ = -1;
+};
+
+/**
+ * 单平面 8 位双线性缩放（像素中心对齐，与 SWS_BILINEAR 的取样位置一致）。
+ *
+ * configure 时预计算每列的源坐标和权重，水平插值结果按源行缓存，相邻输出行共用；
+ * 垂直混合按 CPU 选择 AVX2 / SSE4.1 / 标量实现。用于色度/亮度平面各自缩放。
+ */
+class PlaneScaler
+{
+public:
+    bool configure(int src_width, int src_height, int dst_width, int dst_height,
+                   SimdLevel level = detectSimdLevel());
+    SimdLevel level() const { return level_; }
+
+    void scale(const uint8_t* src, int src_stride, uint8_t* dst, int dst_stride);
+
+private:
+    const uint8_t* horizontalRow(const uint8_t* src, int src_stride, int row, int slot);
+
+    int src_width_ = 0;
+    int src_height_ = 0;
+    int dst_width_ = 0;
+    int dst_height_ = 0;
+    SimdLevel level_ = SimdLevel::SCALAR;
+
+    std::vector<int32_t> x_index_;     // 每个输出列的左侧源列
+    std::vector<uint16_t> x_frac_;     // 右侧源列的权重（0~256）
+    std::vector<int32_t> y_index_;
+    std::vector<uint16_t> y_frac_;
+    std::vector<uint8_t> rows_[2];     // 两个水平插值后的源行
+    int cached_row_[2] = {-1, -1};
+};
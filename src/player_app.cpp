@@ -3,6 +3,7 @@
 #include "play/opengl_renderer.hpp"
 #include <iostream>
 #include <memory>
+#include <cmath>
 
 extern "C" {
     #include <libavformat/avformat.h>
@@ -16,6 +17,15 @@ PlayerApp::PlayerApp(const std::string& filename)
 {
     state_.filename = filename;
     // 即使没有文件名也可以启动
+    if (!filename.empty()) {
+        playlist_.assign({filename});
+    }
+}
+
+PlayerApp::PlayerApp(const Playlist& playlist)
+    : playlist_(playlist)
+{
+    state_.filename = playlist_.current();
 }
 
 PlayerApp::~PlayerApp() 
@@ -44,8 +54,7 @@ bool PlayerApp::init()
     }
 
     // 初始化时钟
-    state_.audio_clock.set(0);
-    state_.video_clock.set(0);
+    state_.sync.resetTo(0);
 
     // 如果没有文件名，直接创建渲染器用于显示UI
     if (state_.filename.empty()) {
@@ -65,15 +74,15 @@ bool PlayerApp::init()
         return true;
     }
     
-    // 创建解封装线程
-    demux_thread_ = std::make_unique<DemuxThread>(&state_);
-    // 启动解封装线程
-    demux_thread_->start();
+    // 创建并启动解封装线程
+    startDemux();
     
-    // 等待解封装线程准备好
+    // 等待解封装线程准备好（启动时窗口按视频尺寸创建，只能等探测完成）
     {
         std::unique_lock<std::mutex> lock(state_.demux_ready_mutex);
-        state_.demux_ready_cv.wait(lock, [this]() { return state_.demux_ready.load(); });
+        state_.demux_ready_cv.wait(lock, [this]() {
+            return state_.demux_ready.load() || state_.error.load() != PlayerError::NONE;
+        });
     }
     
     // 检查是否有错误
@@ -83,23 +92,10 @@ bool PlayerApp::init()
         return false;
     }
     
-    // 设置音频和视频解码器
-    if (state_.audio_stream >= 0 && !setupAudio()) 
-    {
-        std::cerr << "Failed to setup audio" << std::endl;
-        return false;
-    }
-    
-    if (state_.video_stream >= 0 && !setupVideo()) 
-    {
-        std::cerr << "Failed to setup video" << std::endl;
-        return false;
-    }
-    
-    // 创建解码线程和刷新定时器
-    if (!createThreads()) 
+    // 接管打开的输入，打开解码器，创建解码线程
+    demux_thread_->publishInput();
+    if (!finishOpen()) 
     {
-        std::cerr << "Failed to create threads" << std::endl;
         return false;
     }
 
@@ -119,35 +115,21 @@ bool PlayerApp::setupAudio()
     AVStream* audio_stream = state_.fmt_ctx->streams[state_.audio_stream];
     AVCodecParameters* codecpar = audio_stream->codecpar;
     
-    // 查找解码器
-    AVCodec* codec = avcodec_find_decoder(codecpar->codec_id);
-    if (!codec) 
+    // 按配置选择解码后端并打开；上下文交给 PlayerState 统一释放
+    DecoderConfig config = DecoderConfig::fromEnvironment(AVMEDIA_TYPE_AUDIO);
+    state_.threading.configureDecoder(config, AVMEDIA_TYPE_AUDIO);
+    audio_decoder_ = std::make_unique<AudioDecode>();
     {
-        std::cerr << "不支持的音频编解码器" << std::endl;
-        return false;
-    }
-    
-    // 分配解码器上下文
-    state_.audio_ctx = avcodec_alloc_context3(codec);
-    if (!state_.audio_ctx) 
-    {
-        std::cerr << "无法分配音频解码器上下文" << std::endl;
-        return false;
-    }
-    
-    // 复制参数到解码器上下文
-    if (avcodec_parameters_to_context(state_.audio_ctx, codecpar) < 0) 
-    {
-        std::cerr << "无法复制参数到音频解码器上下文" << std::endl;
-        return false;
-    }
-    
-    // 打开解码器
-    if (avcodec_open2(state_.audio_ctx, codec, nullptr) < 0) 
-    {
-        std::cerr << "无法打开音频编解码器" << std::endl;
-        return false;
+        // FFmpeg 在打开时创建解码工作线程，让它们继承解码线程的绑核
+        AffinityScope affinity(state_.threading, PipelineThread::AUDIO_DECODE);
+        if (!audio_decoder_->open(codecpar, config)) 
+        {
+            std::cerr << "无法打开音频编解码器" << std::endl;
+            return false;
+        }
     }
+    state_.audio_ctx = audio_decoder_->detachCodecCtx();
+    state_.threading.recordDecoder(AVMEDIA_TYPE_AUDIO, state_.audio_ctx);
 
     // 在创建音频播放器之前，确保音频上下文有效
     if (!state_.audio_ctx || state_.audio_ctx->sample_rate <= 0) 
@@ -172,35 +154,21 @@ bool PlayerApp::setupVideo()
     AVStream* video_stream = state_.fmt_ctx->streams[state_.video_stream];
     AVCodecParameters* codecpar = video_stream->codecpar;
     
-    // 查找解码器
-    AVCodec* codec = avcodec_find_decoder(codecpar->codec_id);
-    if (!codec) 
-    {
-        std::cerr << "不支持的视频编解码器" << std::endl;
-        return false;
-    }
-    
-    // 分配解码器上下文
-    state_.video_ctx = avcodec_alloc_context3(codec);
-    if (!state_.video_ctx) 
-    {
-        std::cerr << "无法分配视频解码器上下文" << std::endl;
-        return false;
-    }
-    
-    // 复制参数到解码器上下文
-    if (avcodec_parameters_to_context(state_.video_ctx, codecpar) < 0) 
+    // 按配置选择解码后端（软件 / 硬件）并打开；上下文交给 PlayerState 统一释放
+    DecoderConfig config = DecoderConfig::fromEnvironment(AVMEDIA_TYPE_VIDEO);
+    state_.threading.configureDecoder(config, AVMEDIA_TYPE_VIDEO);
+    video_decoder_ = std::make_unique<VideoDecode>();
     {
-        std::cerr << "无法复制参数到视频解码器上下文" << std::endl;
-        return false;
-    }
-    
-    // 打开解码器
-    if (avcodec_open2(state_.video_ctx, codec, nullptr) < 0) 
-    {
-        std::cerr << "无法打开视频编解码器" << std::endl;
-        return false;
+        // FFmpeg 在打开时创建解码工作线程，让它们继承解码线程的绑核
+        AffinityScope affinity(state_.threading, PipelineThread::VIDEO_DECODE);
+        if (!video_decoder_->open(codecpar, config)) 
+        {
+            std::cerr << "无法打开视频编解码器" << std::endl;
+            return false;
+        }
     }
+    state_.video_ctx = video_decoder_->detachCodecCtx();
+    state_.threading.recordDecoder(AVMEDIA_TYPE_VIDEO, state_.video_ctx);
     
     // 修改：不重新创建渲染器，而是更新现有渲染器
     if (!renderer_) {
@@ -237,12 +205,13 @@ bool PlayerApp::setupVideo()
 
 bool PlayerApp::createThreads() 
 {
+    // 只为已经打开的解码器创建，已创建的不重复（打开文件时视频解码线程先创建）
+    
     // 创建音频解码线程
-    if (state_.audio_stream >= 0) 
+    if (audio_decoder_ && !audio_decode_thread_) 
     {
-        auto audio_decoder = std::make_unique<AudioDecode>(state_.audio_ctx);
         audio_decode_thread_ = std::make_unique<AudioDecodeThread>(
-            audio_decoder.release(), 
+            audio_decoder_.get(), 
             &state_.audio_packet_queue, 
             &state_.audio_frame_queue, 
             &state_,
@@ -251,19 +220,15 @@ bool PlayerApp::createThreads()
     }
     
     // 创建视频解码线程
-    if (state_.video_stream >= 0) 
+    if (video_decoder_ && !video_decode_thread_) 
     {
-        auto video_decoder = std::make_unique<VideoDecode>(state_.video_ctx);
         video_decode_thread_ = std::make_unique<VideoDecodeThread>(
-            video_decoder.release(), 
+            video_decoder_.get(), 
             &state_.video_packet_queue, 
             &state_.video_frame_queue, 
             &state_,
             "VideoDecodeThread"
         );
-        
-        // 创建视频刷新定时器
-        refresh_timer_ = std::make_unique<VideoRefreshTimer>(&state_);
     }
     
     return true;
@@ -287,6 +252,7 @@ void PlayerApp::run()
     // 有文件时启动播放
     std::cout << "Starting playback for: " << state_.filename << std::endl;
     startPlayback();
+    preloadNext();
     
     handleEvents();
     stop();
@@ -295,49 +261,79 @@ void PlayerApp::run()
 void PlayerApp::stop() 
 {
     state_.quit = true;
+    preloader_.cancel();
+    opening_ = false;
     
     // 停止所有线程
+    stopThreads();
+    
+    // 停止音频播放
+    if (audio_player_) 
+    {
+        audio_player_->stop();
+    }
+    
+    // 等待所有线程真正结束
+    state_.wait_for_threads(5000);  // 等待5秒
+    
+    cleanUp();
+    initialized_ = false;
+}
+
+void PlayerApp::stopThreads()
+{
     if (demux_thread_) 
     {
         demux_thread_->stop();
         demux_thread_->join();
     }
     
-    if (audio_decode_thread_) 
+    if (keyframe_indexer_) 
     {
-        audio_decode_thread_->stop();
-        audio_decode_thread_->join();
+        keyframe_indexer_->stop();
+        keyframe_indexer_->join();
     }
     
-    if (video_decode_thread_) 
+    if (stream_info_prober_) 
     {
-        video_decode_thread_->stop();
-        video_decode_thread_->join();
+        stream_info_prober_->stop();
+        stream_info_prober_->join();
     }
     
-    if (refresh_timer_) 
+    if (audio_decode_thread_) 
     {
-        refresh_timer_->stop();
-        refresh_timer_->join();
+        audio_decode_thread_->stop();
+        audio_decode_thread_->join();
     }
     
-    // 停止音频播放
-    if (audio_player_) 
+    if (video_decode_thread_) 
     {
-        audio_player_->stop();
+        video_decode_thread_->stop();
+        video_decode_thread_->join();
     }
-    
-    // 等待所有线程真正结束
-    state_.wait_for_threads(5000);  // 等待5秒
-    
-    cleanUp();
-    initialized_ = false;
 }
 
 void PlayerApp::handleEvents() {
     SDL_Event event;
     
+    // 主线程负责呈现，按刷新线程的策略设置优先级/绑核
+    state_.threading.applyToCurrentThread(PipelineThread::REFRESH);
+    if (renderer_) {
+        scheduler_.setRefreshRate(renderer_->displayRefreshRate());
+        scheduler_.setVsyncEnabled(renderer_->vsyncEnabled());
+    }
+    
     while (!state_.quit) {
+        // 暂停状态和播放速度由 UI 修改，时钟在这里跟随（重复设置无副作用）
+        state_.sync.setPaused(state_.paused.load());
+        double speed = state_.playback_speed.load();
+        if (speed != state_.sync.speed()) {
+            state_.sync.setSpeed(speed);
+        }
+        
+        // 后台打开的文件探测完成后开始播放
+        pollOpen();
+        
         while (SDL_PollEvent(&event)) {
             // 传递事件给渲染器（用于 UI 处理）
             if (renderer_) {
@@ -345,10 +341,6 @@ void PlayerApp::handleEvents() {
             }
             
             switch (event.type) {
-                case FF_REFRESH_EVENT:
-                    videoRefresh();
-                    break;
-                    
                 case SDL_QUIT:
                     state_.quit = true;
                     break;
@@ -361,6 +353,10 @@ void PlayerApp::handleEvents() {
                     if (event.window.event == SDL_WINDOWEVENT_RESIZED && renderer_) {
                         renderer_->handleResize(event.window.data1, event.window.data2);
                     }
+                    // 窗口可能被拖到刷新率不同的显示器上
+                    if (event.window.event == SDL_WINDOWEVENT_MOVED && renderer_) {
+                        scheduler_.setRefreshRate(renderer_->displayRefreshRate());
+                    }
                     break;
                     
                 default:
@@ -368,12 +364,22 @@ void PlayerApp::handleEvents() {
             }
         }
         
-        // 渲染
+        // 垂直同步可用时由交换缓冲区定拍，否则在这里等到下一个刷新周期
+        scheduler_.waitForNextVsync();
+        
+        // 为即将到来的 vsync 选帧，然后渲染 UI 并交换缓冲区（每个循环只交换一次）
+        videoRefresh();
         if (renderer_) {
+            double swap_start = Clock::now();
             renderer_->renderUI();
+            scheduler_.framePresented(swap_start, Clock::now());
         }
         
-        SDL_Delay(1);
+        // 当前条目解码完毕且下一条目已预加载时切换
+        updatePlaylist();
+        
+        // 按间隔输出流水线统计（未设置 SDL2_PLAYER_METRICS_FILE 时不做任何事）
+        metrics_dumper_.tick();
     }
 }
 
@@ -400,6 +406,11 @@ void PlayerApp::handleKeyPress(SDL_Keycode key) {
                 renderer_->toggleFullscreen();
             }
             break;
+        case SDLK_a:
+            // 切换 seek 模式：关键帧（快速）/ 精确到帧
+            state_.seek_mode.store(state_.seek_mode.load() == SeekMode::ACCURATE ? SeekMode::KEYFRAME : SeekMode::ACCURATE);
+            printf("Seek mode: %s\n", state_.seek_mode.load() == SeekMode::ACCURATE ? "accurate" : "keyframe");
+            break;
         default:
             break;
     }
@@ -407,74 +418,40 @@ void PlayerApp::handleKeyPress(SDL_Keycode key) {
 
 void PlayerApp::videoRefresh()
 {
-    if (!renderer_) return;
+    if (!renderer_ || state_.video_stream < 0) return;
 
-    // 暂停时不渲染新帧
-    if (state_.paused.load()) {
-        renderer_->renderUI(); // 只刷新UI，不渲染视频
-        return;
-    }
-    
-    AVFrame* frame = nullptr;
-    if (!state_.video_frame_queue.try_pop(frame) || !frame) {
-        return;
-    }
-    
-    // 如果正在 seeking，直接渲染不进行时间同步
-    if (state_.seeking.load()) {
-        std::cout << "Seeking in progress, rendering frame without sync" << std::endl;
-        renderer_->renderFrame(frame);
-        av_frame_free(&frame);
-        renderer_->renderUI();
-        return;
-    }
-    
-    // 计算视频PTS
-    double video_pts = 0.0;
-    bool has_pts = false;
-    
-    if (frame->opaque) {
-        video_pts = *((double*)frame->opaque);
-        has_pts = true;
-    }
-    
-    if (has_pts) {
-        // 获取音频时钟作为主时钟
-        double master_clock = state_.get_master_clock();
-        double diff = video_pts - master_clock;
-        
-        // 同步阈值
-        const double sync_threshold = 0.04; // 40ms
-        
-        if (diff < -sync_threshold) {
-            // 视频落后太多，跳过这一帧
-            // std::cout << "Video lagging, skipping frame. Diff: " << diff << "s" << std::endl;
-            av_frame_free(&frame);
-            return;
-        } else if (diff > sync_threshold) {
-            // 视频超前，暂时不处理这一帧，放回队列
-            // std::cout << "Video ahead, delaying frame. Diff: " << diff << "s" << std::endl;
-            av_frame_free(&frame);
-            return;
+    // 暂停时不取新帧，画面停在当前帧（刚打开的文件仍显示第一帧作为海报帧）
+    if (state_.paused.load() && scheduler_.shownAny()) return;
+    
+    // 早到的帧留在队列里，落后的帧在调度器内丢弃；没有帧到期时沿用上一帧
+    FrameScheduler::Selection selection = scheduler_.selectFrame();
+    if (!selection.frame) return;
+    
+    state_.record_seek_display(selection.pts);
+    renderer_->renderFrame(selection.frame);
+    state_.record_first_video_frame();
+    state_.metrics.add(MetricCounter::FRAMES_PRESENTED);
+    state_.video_frame_pool.release(selection.frame);
+    
+    if (!std::isnan(selection.pts)) {
+        // 视频时钟对齐到上屏时刻；以视频为主时钟时只在跳变后对齐，平时按速度自由运行
+        if (state_.sync.master() != SyncMaster::VIDEO || selection.resync) {
+            state_.video_clock.set(selection.pts, selection.vsync_time);
         }
-        
-        // 更新视频时钟
-        state_.video_clock.set(video_pts);
-        
-        // std::cout << "Rendering frame - Video PTS: " << video_pts 
-        //           << "s, Audio Clock: " << master_clock 
-        //           << "s, Diff: " << diff << "s" << std::endl;
+        state_.sync.syncExternalTo(state_.video_clock);
+        state_.sync.reportVideoDrift(selection.drift);
     }
-    
-    // 渲染视频帧
-    renderer_->renderFrame(frame);
-    av_frame_free(&frame);
-    
-    // 强制渲染UI以更新ImGui
-    renderer_->renderUI();
 }
 
 void PlayerApp::openVideo(const std::string& filename)
+{
+    // 从界面打开的文件替换播放列表（保留循环设置）
+    preloader_.cancel();
+    playlist_.assign({filename});
+    reopen(filename);
+}
+
+void PlayerApp::reopen(const std::string& filename)
 {
     std::cout << "Opening video file: " << filename << std::endl;
     
@@ -486,26 +463,8 @@ void PlayerApp::openVideo(const std::string& filename)
         renderer_->getUiLayer()->ClearVideoInfo();
     }
     
-    // 手动清理但不设置quit标志，也不重置渲染器
-    if (demux_thread_) {
-        demux_thread_->stop();
-        demux_thread_->join();
-    }
-    
-    if (audio_decode_thread_) {
-        audio_decode_thread_->stop();
-        audio_decode_thread_->join();
-    }
-    
-    if (video_decode_thread_) {
-        video_decode_thread_->stop();
-        video_decode_thread_->join();
-    }
-    
-    if (refresh_timer_) {
-        refresh_timer_->stop();
-        refresh_timer_->join();
-    }
+    // 手动清理但不设置quit标志，也不重置渲染器（上一个文件可能还在打开，停止时中断探测）
+    stopThreads();
     
     if (audio_player_) {
         audio_player_->stop();
@@ -517,91 +476,81 @@ void PlayerApp::openVideo(const std::string& filename)
     
     // 清理之前的线程对象，但保留渲染器
     demux_thread_.reset();
+    keyframe_indexer_.reset();
+    stream_info_prober_.reset();
     audio_decode_thread_.reset();
     video_decode_thread_.reset();
+    audio_decoder_.reset();
+    video_decoder_.reset();
     audio_player_.reset();
-    refresh_timer_.reset();
     
-    // 重新初始化
-    bool old_initialized = initialized_;
+    // 在后台打开：探测期间主循环照常渲染界面、响应操作，探测完成后由 pollOpen 继续
     initialized_ = false;
-    if (initWithFile()) {
-        std::cout << "Video file loaded successfully, starting playback..." << std::endl;
-        startPlayback();
-        initialized_ = true;
-        state_.loading.store(false); // 加载完成
-    } else {
-        std::cerr << "Failed to load video file: " << filename << std::endl;
-        state_.filename.clear();
-        state_.loading.store(false); // 加载失败
-        
-        // 失败时清理UI
-        if (renderer_ && renderer_->getUiLayer()) {
-            renderer_->getUiLayer()->ClearVideoInfo();
-        }
-        
-        initialized_ = old_initialized;
-    }
+    startDemux();
+    opening_ = true;
 }
 
-// 专门的播放启动方法
-void PlayerApp::startPlayback() {
-    if (audio_decode_thread_) {
-        audio_decode_thread_->start();
-    }
-    
-    if (video_decode_thread_) {
-        video_decode_thread_->start();
-    }
-    
-    if (audio_player_) {
-        audio_player_->start();
-    }
-    
-    if (refresh_timer_) {
-        refresh_timer_->start();
-    }
+void PlayerApp::startDemux()
+{
+    state_.stats.open_start_us.store(av_gettime_relative());
+    scheduler_.reset();   // 新文件的第一帧作为海报帧立即显示
+    demux_thread_ = std::make_unique<DemuxThread>(&state_);
+    demux_thread_->start();
 }
 
-bool PlayerApp::initWithFile() {
-    // 创建解封装线程但不启动
-    demux_thread_ = std::make_unique<DemuxThread>(&state_);
+void PlayerApp::pollOpen()
+{
+    if (!opening_) return;
     
-    // 启动解封装线程
-    demux_thread_->start();
+    // 解封装线程还在打开/探测
+    if (!state_.demux_ready.load() && state_.error.load() == PlayerError::NONE) return;
+    opening_ = false;
     
-    // 等待解封装准备就绪
-    {
-        std::unique_lock<std::mutex> lock(state_.demux_ready_mutex);
-        state_.demux_ready_cv.wait_for(lock, std::chrono::seconds(10), 
-            [this]() { return state_.demux_ready.load() || state_.quit.load(); });
+    if (state_.error.load() != PlayerError::NONE) {
+        std::cerr << "DemuxThread error: " << state_.error_message << std::endl;
+        failOpen();
+        return;
     }
     
-    if (state_.quit.load()) {
-        std::cerr << "解封装失败或被取消" << std::endl;
-        return false;
+    // 输入在这里（主线程）才交给 PlayerState：打开期间界面看到的 fmt_ctx 为空，
+    // 不会读到半写的流信息，也不能 seek 或切换暂停
+    demux_thread_->publishInput();
+    if (!finishOpen()) {
+        failOpen();
+        return;
     }
     
-    // 检查解封装是否成功
-    if (state_.error.load() != PlayerError::NONE) {
-        std::cerr << "DemuxThread error: " << state_.error_message << std::endl;
-        return false;
+    std::cout << "Video file loaded successfully, starting playback..." << std::endl;
+    startPlayback();
+    initialized_ = true;
+    state_.loading.store(false); // 加载完成
+    preloadNext();
+}
+
+bool PlayerApp::finishOpen()
+{
+    // 先打开视频解码器并开始解码：打开音频设备期间第一帧（海报帧）已经在解码
+    if (state_.video_stream >= 0) 
+    {
+        if (!setupVideo()) 
+        {
+            std::cerr << "Failed to setup video" << std::endl;
+            return false;
+        }
+        createThreads();
+        video_decode_thread_->start();
     }
     
-    // 设置音频和视频解码器
     if (state_.audio_stream >= 0 && !setupAudio()) 
     {
         std::cerr << "Failed to setup audio" << std::endl;
         return false;
     }
     
-    if (state_.video_stream >= 0 && !setupVideo()) 
-    {
-        std::cerr << "Failed to setup video" << std::endl;
-        return false;
-    }
+    // 按实际存在的流确定主时钟
+    state_.sync.configureStreams(state_.audio_stream >= 0, state_.video_stream >= 0);
     
-    // 创建解码线程和刷新定时器（但不启动）
+    // 创建其余的解码线程（在 startPlayback 中启动）
     if (!createThreads()) 
     {
         std::cerr << "Failed to create threads" << std::endl;
@@ -611,6 +560,63 @@ bool PlayerApp::initWithFile() {
     return true;
 }
 
+void PlayerApp::failOpen()
+{
+    std::cerr << "Failed to load video file: " << state_.filename << std::endl;
+    
+    // 解封装线程已经结束，视频解码线程可能已经启动；清理后回到没有文件的状态
+    stopThreads();
+    if (audio_player_) {
+        audio_player_->stop();
+    }
+    state_.resetForNewFile();   // 同时清除错误状态
+    cleanUp();
+    state_.filename.clear();
+    state_.loading.store(false); // 加载失败
+    
+    // 失败时清理UI
+    if (renderer_ && renderer_->getUiLayer()) {
+        renderer_->getUiLayer()->ClearVideoInfo();
+    }
+}
+
+// 专门的播放启动方法
+void PlayerApp::startPlayback() {
+    if (audio_decode_thread_) {
+        audio_decode_thread_->start();
+    }
+    
+    if (video_decode_thread_) {
+        video_decode_thread_->start();
+    }
+    
+    if (audio_player_) {
+        audio_player_->start();
+    }
+    
+    startKeyframeIndexer();
+    startStreamInfoProber();
+}
+
+void PlayerApp::startKeyframeIndexer()
+{
+    // 本地视频文件在后台建立关键帧索引（或从缓存加载），完成后 seek 直接落到关键帧
+    if (state_.video_stream >= 0 && state_.fmt_ctx && io_is_local_path(state_.filename)) {
+        AVStream* video_stream = state_.fmt_ctx->streams[state_.video_stream];
+        keyframe_indexer_ = std::make_unique<KeyframeIndexer>(&state_, state_.video_stream, video_stream->time_base);
+        keyframe_indexer_->start();
+    }
+}
+
+void PlayerApp::startStreamInfoProber()
+{
+    // 限量探测没有得到时长时在后台完整探测一遍，进度条和 seek 范围随后可用
+    if (state_.stats.probe_limited.load() && state_.media_duration.load() == AV_NOPTS_VALUE) {
+        stream_info_prober_ = std::make_unique<StreamInfoProber>(&state_);
+        stream_info_prober_->start();
+    }
+}
+
 void PlayerApp::cleanUp() {
     // 只清理资源，不要调用 SDL_Quit()，因为我们还要继续使用SDL
     
@@ -621,12 +627,161 @@ void PlayerApp::cleanUp() {
     
     // 清理线程对象
     demux_thread_.reset();
+    keyframe_indexer_.reset();
+    stream_info_prober_.reset();
     audio_decode_thread_.reset();
     video_decode_thread_.reset();
-    refresh_timer_.reset();
+    audio_decoder_.reset();
+    video_decoder_.reset();
     
     // 不要重置渲染器，它还要继续使用
     // 不要清理状态，因为UI还需要它
     
     // 不要调用 SDL_Quit()!
+}
+
+void PlayerApp::preloadNext()
+{
+    int next = playlist_.nextIndex();
+    if (next >= 0) {
+        preloader_.start(next, playlist_.item(next));
+    }
+}
+
+bool PlayerApp::decodeFinished() const
+{
+    return (!audio_decode_thread_ || audio_decode_thread_->finished()) &&
+           (!video_decode_thread_ || video_decode_thread_->finished());
+}
+
+void PlayerApp::updatePlaylist()
+{
+    if (!initialized_ || !preloader_.pending()) return;
+
+    // 当前条目已全部解码（尾部还在帧队列和音频环形缓冲区里播放）；下一条目还没打开好时等它
+    if (!state_.demux_finished.load() || !decodeFinished() || !preloader_.done()) return;
+
+    int index = preloader_.index();
+    std::unique_ptr<PreparedItem> item = preloader_.take();
+    if (!item) {
+        // 打不开的条目跳过
+        int next = playlist_.indexAfter(index);
+        if (next >= 0 && next != index) {
+            preloader_.start(next, playlist_.item(next));
+        }
+        return;
+    }
+
+    playlist_.setCurrent(item->index);
+    if (canCutOver(*item)) {
+        cutOver(std::move(item));
+    } else {
+        // 有无音频/视频不同：主时钟和输出设备都要重建，退回完整的重新打开
+        std::string filename = item->filename;
+        item.reset();
+        reopen(filename);
+    }
+    if (initialized_) {
+        preloadNext();
+    }
+}
+
+bool PlayerApp::canCutOver(const PreparedItem& item) const
+{
+    bool has_audio = item.input.audio_stream >= 0;
+    bool has_video = item.input.video_stream >= 0;
+    return has_audio == (state_.audio_stream >= 0) && has_video == (state_.video_stream >= 0) &&
+           (!has_audio || audio_player_) && (!has_video || renderer_);
+}
+
+// 流的起始时间（微秒），用于把新条目接到时间轴上
+static int64_t streamStartTime(const AVFormatContext* fmt_ctx, int stream_index)
+{
+    if (stream_index >= 0) {
+        const AVStream* stream = fmt_ctx->streams[stream_index];
+        if (stream->start_time != AV_NOPTS_VALUE) {
+            return av_rescale_q(stream->start_time, stream->time_base, AV_TIME_BASE_Q);
+        }
+    }
+    return fmt_ctx->start_time != AV_NOPTS_VALUE ? fmt_ctx->start_time : 0;
+}
+
+void PlayerApp::cutOver(std::unique_ptr<PreparedItem> item)
+{
+    int64_t cutover_start = av_gettime_relative();
+    std::cout << "Playlist: Switching to item " << item->index + 1 << "/" << playlist_.size()
+              << ": " << item->filename << std::endl;
+
+    // 旧条目的解封装/解码线程都已结束；关键帧索引和流信息探测可能还在进行
+    if (keyframe_indexer_) {
+        keyframe_indexer_->stop();
+        keyframe_indexer_->join();
+    }
+    if (stream_info_prober_) {
+        stream_info_prober_->stop();
+        stream_info_prober_->join();
+    }
+    if (demux_thread_) demux_thread_->join();
+    if (audio_decode_thread_) audio_decode_thread_->join();
+    if (video_decode_thread_) video_decode_thread_->join();
+    demux_thread_.reset();
+    keyframe_indexer_.reset();
+    stream_info_prober_.reset();
+    audio_decode_thread_.reset();
+    video_decode_thread_.reset();
+    audio_decoder_.reset();
+    video_decoder_.reset();
+
+    // 释放旧条目的解码器和输入；帧队列里的尾部帧持有各自缓冲区的引用，不受影响
+    if (state_.audio_ctx) avcodec_free_context(&state_.audio_ctx);
+    if (state_.video_ctx) avcodec_free_context(&state_.video_ctx);
+    if (state_.fmt_ctx) avformat_close_input(&state_.fmt_ctx);
+    state_.avio.reset();
+    state_.keyframe_index.reset();
+
+    // 新条目接在时间轴上旧条目的末尾（有音频时以音频为准，听起来没有缝隙）
+    bool has_audio = state_.audio_stream >= 0;
+    int64_t end = has_audio ? state_.audio_timeline_end.load() : state_.video_timeline_end.load();
+    if (end == AV_NOPTS_VALUE) {
+        end = static_cast<int64_t>(state_.get_master_clock() * AV_TIME_BASE);
+    }
+    const MediaInput& input = item->input;
+    int64_t first = streamStartTime(input.fmt_ctx, has_audio ? input.audio_stream : input.video_stream);
+    state_.previous_timeline_offset.store(state_.timeline_offset.load());
+    state_.timeline_offset.store(end - first);
+
+    // 接管预加载的输入和解码器
+    state_.filename = item->filename;
+    state_.adoptInput(item->input);
+    state_.fmt_ctx->interrupt_callback = AVIOInterruptCB{nullptr, nullptr};   // 原回调指向预加载器，取走后会中断读取
+    audio_decoder_ = std::move(item->audio_decoder);
+    video_decoder_ = std::move(item->video_decoder);
+    if (audio_decoder_) {
+        state_.audio_ctx = audio_decoder_->detachCodecCtx();
+        state_.threading.recordDecoder(AVMEDIA_TYPE_AUDIO, state_.audio_ctx);
+    }
+    if (video_decoder_) {
+        state_.video_ctx = video_decoder_->detachCodecCtx();
+        state_.threading.recordDecoder(AVMEDIA_TYPE_VIDEO, state_.video_ctx);
+    }
+    state_.demux_ready.store(false);
+    state_.demux_finished.store(false);
+    state_.audio_eof.store(false);
+    state_.video_eof.store(false);
+
+    // 分辨率/像素格式变化由渲染器在收到新帧时处理，这里只更新 UI 信息
+    if (state_.video_ctx && renderer_ && renderer_->getUiLayer()) {
+        renderer_->getUiLayer()->SetVideoSize(state_.video_ctx->width, state_.video_ctx->height);
+    }
+
+    // 启动新条目的线程；音频设备、渲染器和呈现调度保持不变，时钟沿时间轴继续
+    demux_thread_ = std::make_unique<DemuxThread>(&state_);
+    demux_thread_->start();
+    createThreads();
+    if (audio_decode_thread_) audio_decode_thread_->start();
+    if (video_decode_thread_) video_decode_thread_->start();
+    startKeyframeIndexer();
+
+    std::cout << "Playlist: Cut over in " << (av_gettime_relative() - cutover_start) / 1000.0
+              << " ms, timeline offset " << state_.timeline_offset.load() / (double)AV_TIME_BASE << "s" << std::endl;
 }
\ No newline at end of file
@@ -10,13 +10,20 @@
 #include "player_core/player_state.hpp"
 #include "play/audio_player.hpp"
 #include "player_thread/demux_thread.hpp"
+#include "player_thread/keyframe_indexer.hpp"
+#include "player_thread/stream_info_prober.hpp"
 #include "player_thread/decode_thread.hpp"
-#include "player_thread/video_refresh_timer.hpp"
+#include "player_core/decode/audio_decode.hpp"
+#include "player_core/decode/video_decode.hpp"
+#include "play/frame_scheduler.hpp"
+#include "player_core/playlist.hpp"
+#include "player_thread/item_preloader.hpp"
 
 class PlayerApp 
 {
 public:
     PlayerApp(const std::string& filename);
+    explicit PlayerApp(const Playlist& playlist);
     ~PlayerApp();
     
     bool init();
@@ -25,7 +32,7 @@ public:
 
     OpenGLRenderer* getRenderer() const { return renderer_.get(); }
     
-    // 打开新视频的方法
+    // 打开新视频的方法（替换播放列表）
     void openVideo(const std::string& filename);
     
 private:
@@ -34,18 +41,42 @@ private:
     bool createThreads();
     void handleEvents();
     void handleKeyPress(SDL_Keycode key);
-    bool initWithFile();
     void startPlayback(); 
     void videoRefresh();
     void cleanUp();
+    void stopThreads();
+    void reopen(const std::string& filename);
+    void startKeyframeIndexer();
+    void startStreamInfoProber();
+    
+    // 打开文件：解封装线程在后台打开和探测，主循环每次迭代检查，就绪后打开解码器开始播放
+    void startDemux();
+    void pollOpen();
+    bool finishOpen();
+    void failOpen();
+    
+    // 播放列表：预加载下一条目，当前条目解码结束后无缝切换
+    void preloadNext();
+    void updatePlaylist();
+    bool decodeFinished() const;
+    bool canCutOver(const PreparedItem& item) const;
+    void cutOver(std::unique_ptr<PreparedItem> item);
     
     PlayerState state_;
+    MetricsDumper metrics_dumper_{state_.metrics};
     std::unique_ptr<AudioPlayer> audio_player_;
     std::unique_ptr<OpenGLRenderer> renderer_;
     std::unique_ptr<DemuxThread> demux_thread_;
+    std::unique_ptr<KeyframeIndexer> keyframe_indexer_;
+    std::unique_ptr<StreamInfoProber> stream_info_prober_;
+    std::unique_ptr<AudioDecode> audio_decoder_;     // 须先于解码线程声明，线程先析构
+    std::unique_ptr<VideoDecode> video_decoder_;
     std::unique_ptr<AudioDecodeThread> audio_decode_thread_;
     std::unique_ptr<VideoDecodeThread> video_decode_thread_;
-    std::unique_ptr<VideoRefreshTimer> refresh_timer_;
+    FrameScheduler scheduler_{&state_};             // 视频帧按 vsync 呈现（主线程）
+    Playlist playlist_;
+    ItemPreloader preloader_{&state_};
     
     bool initialized_ = false;
+    bool opening_ = false;      // 解封装线程正在打开文件，由 pollOpen 完成
 };
\ No newline at end of file
@@ -6,7 +6,7 @@ Decode::~Decode()
     close();
 }
 
-bool Decode::open(AVCodecParameters* codecpar) 
+bool Decode::open(AVCodecParameters* codecpar, const DecoderConfig& config) 
 {
     close();
     
@@ -16,30 +16,43 @@ bool Decode::open(AVCodecParameters* codecpar)
         return false;
     }
     
-    codec_ctx_ = avcodec_alloc_context3(codec);
-    if (!codec_ctx_) {
-        std::cerr << "Failed to allocate codec context" << std::endl;
-        return false;
+    DecoderRegistry& registry = DecoderRegistry::instance();
+    for (const std::string& name : registry.candidates(config.backend)) 
+    {
+        std::unique_ptr<DecoderBackend> backend = registry.create(name);
+        if (!backend || !backend->probe(codec, codecpar)) {
+            continue;
+        }
+        
+        codec_ctx_ = avcodec_alloc_context3(codec);
+        if (!codec_ctx_) {
+            std::cerr << "Failed to allocate codec context" << std::endl;
+            return false;
+        }
+        
+        if (avcodec_parameters_to_context(codec_ctx_, codecpar) < 0) {
+            std::cerr << "Failed to copy codec parameters to context" << std::endl;
+            close();
+            return false;
+        }
+        
+        // 后端不可用（设备创建失败、打开失败）时换下一个候选
+        if (!backend->configure(codec_ctx_, config) || avcodec_open2(codec_ctx_, codec, nullptr) < 0) {
+            std::cerr << "Decoder backend " << name << " unavailable for "
+                      << avcodec_get_name(codecpar->codec_id) << std::endl;
+            close();
+            continue;
+        }
+        
+        backend_ = std::move(backend);
+        is_external_ctx_ = false; // 标记为内部创建的上下文
+        std::cout << "Decoder opened: " << avcodec_get_name(codecpar->codec_id)
+                  << " (" << backend_->name() << ", threads " << codec_ctx_->thread_count << ")" << std::endl;
+        return true;
     }
     
-    if (avcodec_parameters_to_context(codec_ctx_, codecpar) < 0) {
-        std::cerr << "Failed to copy codec parameters to context" << std::endl;
-        close();
-        return false;
-    }
-    
-    // 设置线程数（可选）
-    codec_ctx_->thread_count = 0; // 自动选择线程数
-    
-    if (avcodec_open2(codec_ctx_, codec, nullptr) < 0) {
-        std::cerr << "Failed to open codec" << std::endl;
-        close();
-        return false;
-    }
-    
-    is_external_ctx_ = false; // 标记为内部创建的上下文
-    std::cout << "Decoder opened: " << avcodec_get_name(codecpar->codec_id) << std::endl;
-    return true;
+    std::cerr << "Failed to open codec" << std::endl;
+    return false;
 }
 
 bool Decode::sendPacket(const AVPacket* pkt) 
@@ -52,6 +65,13 @@ bool Decode::sendPacket(const AVPacket* pkt)
     return ret == 0;
 }
 
+bool Decode::sendEof()
+{
+    if (!codec_ctx_) return false;
+    int ret = avcodec_send_packet(codec_ctx_, nullptr);
+    return ret == 0 || ret == AVERROR_EOF;
+}
+
 bool Decode::receiveFrame(AVFrame* frame) 
 {
     if (!codec_ctx_ || !frame) return false;
@@ -59,7 +79,13 @@ bool Decode::receiveFrame(AVFrame* frame)
     if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
         return false;
     }
-    return ret == 0;
+    if (ret != 0) return false;
+    
+    if (backend_ && !backend_->retrieveFrame(frame)) {
+        av_frame_unref(frame);
+        return false;
+    }
+    return true;
 }
 
 void Decode::close() 
@@ -69,6 +95,7 @@ void Decode::close()
     }
     codec_ctx_ = nullptr;
     is_external_ctx_ = false;
+    backend_.reset();
 }
 
 void Decode::flush() 
@@ -1,6 +1,7 @@
 #pragma once 
 
 #include "../ffmpeg_utils/ffmpeg_headers.hpp"
+#include "decode/decoder_backend.hpp"
 #include <memory>
 
 class Decode 
@@ -9,13 +10,16 @@ public:
     Decode() = default;
     virtual ~Decode();
 
-    // 打开解码器
-    virtual bool open(AVCodecParameters* codecpar);
+    // 打开解码器：按 config 依次尝试候选后端，探测或设备创建失败时回退到下一个（最后是软件解码）
+    virtual bool open(AVCodecParameters* codecpar, const DecoderConfig& config = DecoderConfig());
 
     // 发送压缩包到解码器
     virtual bool sendPacket(const AVPacket* pkt);
 
-    // 从解码器获取解码帧
+    // 通知解码器输入结束，之后 receiveFrame 取出缓存的剩余帧；再次解码前需要 flush
+    bool sendEof();
+
+    // 从解码器获取解码帧（硬件帧已下载到系统内存）
     virtual bool receiveFrame(AVFrame* frame);
 
     // 刷新解码器的方法
@@ -26,7 +30,13 @@ public:
 
     AVCodecContext* getCodecCtx() const { return codec_ctx_; }
 
+    // 上下文交给外部（PlayerState）释放，解码器仍继续使用它
+    AVCodecContext* detachCodecCtx() { is_external_ctx_ = true; return codec_ctx_; }
+
+    const char* backendName() const { return backend_ ? backend_->name() : "external"; }
+
 protected:
     AVCodecContext* codec_ctx_ = nullptr;
     bool is_external_ctx_ = false; // 标记上下文是否由外部传入
-};
\ No newline at end of file
+    std::unique_ptr<DecoderBackend> backend_;
+};
@@ -0,0 +1,222 @@
+#include "decoder_backend.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+namespace {
+
+// 各平台原生接口优先于通用接口
+int hwDevicePriority(AVHWDeviceType type)
+{
+    switch (type) {
+        case AV_HWDEVICE_TYPE_D3D11VA:      return 40;
+        case AV_HWDEVICE_TYPE_VIDEOTOOLBOX: return 40;
+        case AV_HWDEVICE_TYPE_CUDA:         return 30;
+        case AV_HWDEVICE_TYPE_VAAPI:        return 30;
+        case AV_HWDEVICE_TYPE_DXVA2:        return 20;
+        case AV_HWDEVICE_TYPE_QSV:          return 10;
+        default:                            return 5;
+    }
+}
+
+} // namespace
+
+bool DecoderConfig::parseThreadType(const std::string& text, int& thread_type)
+{
+    if (text == "frame") thread_type = FF_THREAD_FRAME;
+    else if (text == "slice") thread_type = FF_THREAD_SLICE;
+    else if (text == "auto") thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    else return false;
+    return true;
+}
+
+DecoderConfig DecoderConfig::fromEnvironment(AVMediaType type)
+{
+    DecoderConfig config;
+    const char* backend = std::getenv(type == AVMEDIA_TYPE_VIDEO ? "SDL2_PLAYER_VIDEO_DECODER" : "SDL2_PLAYER_AUDIO_DECODER");
+    if (backend && *backend) {
+        config.backend = backend;
+    }
+    if (const char* threads = std::getenv("SDL2_PLAYER_DECODER_THREADS")) {
+        int count = std::atoi(threads);
+        if (count >= 0) config.thread_count = count;
+    }
+    if (const char* thread_type = std::getenv("SDL2_PLAYER_DECODER_THREAD_TYPE")) {
+        if (!parseThreadType(thread_type, config.thread_type)) {
+            std::cerr << "DecoderConfig: Unknown thread type " << thread_type << ", using auto" << std::endl;
+        }
+    }
+    return config;
+}
+
+bool SoftwareDecoderBackend::probe(const AVCodec* codec, const AVCodecParameters* codecpar)
+{
+    (void)codecpar;
+    return codec != nullptr;
+}
+
+bool SoftwareDecoderBackend::configure(AVCodecContext* ctx, const DecoderConfig& config)
+{
+    ctx->thread_count = config.thread_count;
+    ctx->thread_type = config.thread_type;
+    return true;
+}
+
+HwDeviceDecoderBackend::HwDeviceDecoderBackend(AVHWDeviceType type) : type_(type) {}
+
+HwDeviceDecoderBackend::~HwDeviceDecoderBackend()
+{
+    av_frame_free(&transfer_frame_);
+}
+
+const char* HwDeviceDecoderBackend::name() const
+{
+    return av_hwdevice_get_type_name(type_);
+}
+
+bool HwDeviceDecoderBackend::probe(const AVCodec* codec, const AVCodecParameters* codecpar)
+{
+    if (!codec || codecpar->codec_type != AVMEDIA_TYPE_VIDEO) return false;
+
+    for (int i = 0;; i++) {
+        const AVCodecHWConfig* hw_config = avcodec_get_hw_config(codec, i);
+        if (!hw_config) return false;
+        if ((hw_config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX) && hw_config->device_type == type_) {
+            hw_pix_fmt_ = hw_config->pix_fmt;
+            return true;
+        }
+    }
+}
+
+bool HwDeviceDecoderBackend::configure(AVCodecContext* ctx, const DecoderConfig& config)
+{
+    (void)config;
+    int ret = av_hwdevice_ctx_create(&ctx->hw_device_ctx, type_, nullptr, nullptr, 0);
+    if (ret < 0) {
+        std::cerr << "Decoder: Cannot create " << name() << " device (" << ret << ")" << std::endl;
+        return false;
+    }
+
+    ctx->opaque = this;
+    ctx->get_format = getFormat;
+    // 硬件解码的并行在设备上完成，帧级多线程只会增加延迟和显存占用
+    ctx->thread_count = 1;
+    return true;
+}
+
+AVPixelFormat HwDeviceDecoderBackend::getFormat(AVCodecContext* ctx, const AVPixelFormat* formats)
+{
+    HwDeviceDecoderBackend* self = static_cast<HwDeviceDecoderBackend*>(ctx->opaque);
+    for (const AVPixelFormat* p = formats; *p != AV_PIX_FMT_NONE; p++) {
+        if (*p == self->hw_pix_fmt_) return *p;
+    }
+
+    // 当前码流参数超出硬件能力（分辨率、profile 等），退回解码器提供的第一个软件格式
+    for (const AVPixelFormat* p = formats; *p != AV_PIX_FMT_NONE; p++) {
+        const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(*p);
+        if (desc && !(desc->flags & AV_PIX_FMT_FLAG_HWACCEL)) {
+            std::cerr << "Decoder: " << self->name() << " unavailable for this stream, decoding "
+                      << av_get_pix_fmt_name(*p) << " in software" << std::endl;
+            return *p;
+        }
+    }
+    return AV_PIX_FMT_NONE;
+}
+
+bool HwDeviceDecoderBackend::retrieveFrame(AVFrame* frame)
+{
+    if (frame->format != hw_pix_fmt_) return true;
+
+    if (!transfer_frame_) {
+        transfer_frame_ = av_frame_alloc();
+        if (!transfer_frame_) return false;
+    }
+
+    if (av_hwframe_transfer_data(transfer_frame_, frame, 0) < 0) {
+        std::cerr << "Decoder: Failed to download " << name() << " frame" << std::endl;
+        av_frame_unref(transfer_frame_);
+        return false;
+    }
+    av_frame_copy_props(transfer_frame_, frame);
+
+    av_frame_unref(frame);
+    av_frame_move_ref(frame, transfer_frame_);
+    return true;
+}
+
+DecoderRegistry::DecoderRegistry()
+{
+    add("software", 0, []() { return std::unique_ptr<DecoderBackend>(new SoftwareDecoderBackend()); });
+
+    // 只注册本机 FFmpeg 编译时启用的设备类型；设备是否真的可用在打开时才知道
+    for (AVHWDeviceType type = av_hwdevice_iterate_types(AV_HWDEVICE_TYPE_NONE);
+         type != AV_HWDEVICE_TYPE_NONE;
+         type = av_hwdevice_iterate_types(type))
+    {
+        add(av_hwdevice_get_type_name(type), hwDevicePriority(type),
+            [type]() { return std::unique_ptr<DecoderBackend>(new HwDeviceDecoderBackend(type)); });
+    }
+}
+
+DecoderRegistry& DecoderRegistry::instance()
+{
+    static DecoderRegistry registry;
+    return registry;
+}
+
+void DecoderRegistry::add(const std::string& name, int priority, Factory factory)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(entries_.begin(), entries_.end(),
+                           [&name](const Entry& entry) { return entry.name == name; });
+    if (it != entries_.end()) {
+        it->priority = priority;
+        it->factory = std::move(factory);
+    } else {
+        entries_.push_back(Entry{name, priority, std::move(factory)});
+    }
+    std::stable_sort(entries_.begin(), entries_.end(),
+                     [](const Entry& a, const Entry& b) { return a.priority > b.priority; });
+}
+
+std::unique_ptr<DecoderBackend> DecoderRegistry::create(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Entry& entry : entries_) {
+        if (entry.name == name) return entry.factory();
+    }
+    return nullptr;
+}
+
+std::vector<std::string> DecoderRegistry::names() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> result;
+    for (const Entry& entry : entries_) result.push_back(entry.name);
+    return result;
+}
+
+std::vector<std::string> DecoderRegistry::candidates(const std::string& backend) const
+{
+    std::vector<std::string> result;
+    if (backend == "auto") {
+        result = names();
+        // 软件解码始终作为最后的兜底
+        result.erase(std::remove(result.begin(), result.end(), "software"), result.end());
+    } else {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool known = std::any_of(entries_.begin(), entries_.end(),
+                                 [&backend](const Entry& entry) { return entry.name == backend; });
+        if (known && backend != "software") {
+            result.push_back(backend);
+        } else if (!known) {
+            std::cerr << "Decoder: Unknown backend " << backend << ", using software" << std::endl;
+        }
+    }
+    result.push_back("software");
+    return result;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "../../ffmpeg_utils/ffmpeg_headers.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+
+extern "C" {
+#include <libavutil/hwcontext.h>
+}
+
+/**
+ * 解码器配置（按流选择）。
+ *
+ * backend 为注册表中的后端名（"software"、"d3d11va"、"cuda" 等）或 "auto"；
+ * 指定的后端不可用时回退到软件解码。
+ */
+struct DecoderConfig
+{
+    std::string backend = "software";
+    int thread_count = 0;                              // 0 表示由 FFmpeg 按 CPU 核数选择
+    int thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
+    // 读取环境变量：SDL2_PLAYER_VIDEO_DECODER / SDL2_PLAYER_AUDIO_DECODER（后端名），
+    // SDL2_PLAYER_DECODER_THREADS（线程数），SDL2_PLAYER_DECODER_THREAD_TYPE（frame / slice / auto）
+    static DecoderConfig fromEnvironment(AVMediaType type);
+
+    // 解析 "frame" / "slice" / "auto"，无法识别时返回 false
+    static bool parseThreadType(const std::string& text, int& thread_type);
+};
+
+/**
+ * 解码后端：决定解码器上下文在 avcodec_open2 之前如何配置，以及解码帧如何交给下游。
+ */
+class DecoderBackend
+{
+public:
+    virtual ~DecoderBackend() = default;
+
+    virtual const char* name() const = 0;
+
+    // 能力探测：该后端能否解码此编解码器（不创建任何设备）
+    virtual bool probe(const AVCodec* codec, const AVCodecParameters* codecpar) = 0;
+
+    // avcodec_open2 之前配置上下文；返回 false 表示后端当前不可用（例如设备创建失败）
+    virtual bool configure(AVCodecContext* ctx, const DecoderConfig& config) = 0;
+
+    // 解码出的帧交给下游之前的处理（硬件帧下载到系统内存）
+    virtual bool retrieveFrame(AVFrame* frame) { (void)frame; return true; }
+};
+
+/**
+ * FFmpeg 软件解码，线程数和线程类型（帧级 / 片级）可配置。
+ */
+class SoftwareDecoderBackend : public DecoderBackend
+{
+public:
+    const char* name() const override { return "software"; }
+    bool probe(const AVCodec* codec, const AVCodecParameters* codecpar) override;
+    bool configure(AVCodecContext* ctx, const DecoderConfig& config) override;
+};
+
+/**
+ * 基于 hw_device_ctx 的硬件解码（D3D11VA、DXVA2、CUDA、VAAPI、VideoToolbox 等）。
+ *
+ * 解码器协商不到硬件格式时由 get_format 退回软件格式；解码出的硬件帧下载为 NV12/P010 等
+ * 系统内存帧，渲染器按普通帧处理。
+ */
+class HwDeviceDecoderBackend : public DecoderBackend
+{
+public:
+    explicit HwDeviceDecoderBackend(AVHWDeviceType type);
+    ~HwDeviceDecoderBackend() override;
+
+    const char* name() const override;
+    bool probe(const AVCodec* codec, const AVCodecParameters* codecpar) override;
+    bool configure(AVCodecContext* ctx, const DecoderConfig& config) override;
+    bool retrieveFrame(AVFrame* frame) override;
+
+private:
+    static AVPixelFormat getFormat(AVCodecContext* ctx, const AVPixelFormat* formats);
+
+    AVHWDeviceType type_;
+    AVPixelFormat hw_pix_fmt_ = AV_PIX_FMT_NONE;
+    AVFrame* transfer_frame_ = nullptr;   // 下载目标，逐帧复用
+};
+
+/**
+ * 解码后端注册表。内置 software 和本机 FFmpeg 编译进来的所有硬件设备类型，
+ * 也可以在打开文件前注册自定义后端。
+ */
+class DecoderRegistry
+{
+public:
+    using Factory = std::function<std::unique_ptr<DecoderBackend>()>;
+
+    static DecoderRegistry& instance();
+
+    // priority 越大越先尝试（仅影响 "auto"）
+    void add(const std::string& name, int priority, Factory factory);
+    std::unique_ptr<DecoderBackend> create(const std::string& name) const;
+    std::vector<std::string> names() const;
+
+    // 按尝试顺序返回候选后端："auto" 为全部后端（软件最后），指定名称时为该后端加软件兜底
+    std::vector<std::string> candidates(const std::string& backend) const;
+
+private:
+    DecoderRegistry();
+
+    struct Entry
+    {
+        std::string name;
+        int priority;
+        Factory factory;
+    };
+
+    std::vector<Entry> entries_;
+    mutable std::mutex mutex_;
+};
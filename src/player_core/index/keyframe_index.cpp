@@ -0,0 +1,199 @@
+#include "keyframe_index.hpp"
+#include "../io/io_source.hpp"
+#include "../utils/player_constants.hpp"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+
+// 缓存文件头：魔数 + 版本 + 流信息 + 条目数，其后是 count 个 Entry
+constexpr uint32_t CACHE_MAGIC = 0x3149464B; // "KFI1"
+constexpr uint32_t CACHE_VERSION = 1;
+
+struct CacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    int32_t stream_index;
+    int32_t tb_num;
+    int32_t tb_den;
+    uint32_t reserved;
+    uint64_t count;
+};
+
+uint64_t fnv1a(uint64_t hash, const uint8_t* data, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+} // namespace
+
+void KeyframeIndex::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    entries_.shrink_to_fit();
+    time_base_ = AVRational{1, AV_TIME_BASE};
+    status_.store(Status::IDLE);
+    progress_.store(0.0f);
+    stream_index_.store(-1);
+    from_cache_.store(false);
+}
+
+void KeyframeIndex::publish(std::vector<Entry> entries, int stream_index, AVRational time_base, bool from_cache)
+{
+    // 按 pts 排序并去重（B 帧重排后关键帧包仍按解码顺序出现，pts 不一定单调）
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.pts < b.pts;
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.pts == b.pts;
+    }), entries.end());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_ = std::move(entries);
+        time_base_ = time_base;
+    }
+    stream_index_.store(stream_index);
+    from_cache_.store(from_cache);
+    progress_.store(1.0f);
+    status_.store(Status::READY);
+}
+
+bool KeyframeIndex::findBefore(int64_t ts, Entry& out) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::upper_bound(entries_.begin(), entries_.end(), ts, [](int64_t value, const Entry& e) {
+        return value < e.pts;
+    });
+    if (it == entries_.begin()) return false;
+    out = *(it - 1);
+    return true;
+}
+
+bool KeyframeIndex::findAfter(int64_t ts, Entry& out) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), ts, [](const Entry& e, int64_t value) {
+        return e.pts < value;
+    });
+    if (it == entries_.end()) return false;
+    out = *it;
+    return true;
+}
+
+AVRational KeyframeIndex::timeBase() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return time_base_;
+}
+
+size_t KeyframeIndex::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+std::string KeyframeIndex::cacheKey(const std::string& path)
+{
+    FILE* file = io_open_file(path);
+    if (!file) return "";
+
+    std::string key;
+    if (io_seek_file(file, 0, SEEK_END) == 0)
+    {
+        int64_t file_size = io_tell_file(file);
+        if (file_size > 0)
+        {
+            uint64_t hash = 0xCBF29CE484222325ULL;
+            hash = fnv1a(hash, reinterpret_cast<const uint8_t*>(&file_size), sizeof(file_size));
+
+            std::vector<uint8_t> buffer(KEYFRAME_INDEX_HASH_BYTES);
+            int64_t tail = std::max<int64_t>(0, file_size - KEYFRAME_INDEX_HASH_BYTES);
+            for (int64_t offset : {int64_t(0), tail})
+            {
+                if (io_seek_file(file, offset, SEEK_SET) != 0) break;
+                size_t n = std::fread(buffer.data(), 1, buffer.size(), file);
+                hash = fnv1a(hash, buffer.data(), n);
+            }
+
+            char text[32];
+            std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+            key = text;
+        }
+    }
+
+    std::fclose(file);
+    return key;
+}
+
+std::string KeyframeIndex::cachePath(const std::string& key)
+{
+    // SDL 负责创建目录并处理各平台的 UTF-8 路径
+    char* pref = SDL_GetPrefPath("SDL2_Player", "keyframe_index");
+    if (!pref) return "";
+    std::string path = std::string(pref) + key + ".kfi";
+    SDL_free(pref);
+    return path;
+}
+
+bool KeyframeIndex::loadCache(const std::string& key, int stream_index, AVRational time_base,
+                              std::vector<Entry>& entries)
+{
+    if (key.empty()) return false;
+    std::string path = cachePath(key);
+    if (path.empty()) return false;
+
+    SDL_RWops* rw = SDL_RWFromFile(path.c_str(), "rb");
+    if (!rw) return false;
+
+    bool ok = false;
+    CacheHeader header{};
+    if (SDL_RWread(rw, &header, sizeof(header), 1) == 1 &&
+        header.magic == CACHE_MAGIC && header.version == CACHE_VERSION &&
+        header.stream_index == stream_index &&
+        header.tb_num == time_base.num && header.tb_den == time_base.den &&
+        header.count > 0 && header.count < (1ULL << 28))
+    {
+        entries.resize(static_cast<size_t>(header.count));
+        ok = SDL_RWread(rw, entries.data(), sizeof(Entry), entries.size()) == entries.size();
+        if (!ok) entries.clear();
+    }
+
+    SDL_RWclose(rw);
+    return ok;
+}
+
+bool KeyframeIndex::saveCache(const std::string& key, int stream_index, AVRational time_base,
+                              const std::vector<Entry>& entries)
+{
+    if (key.empty() || entries.empty()) return false;
+    std::string path = cachePath(key);
+    if (path.empty()) return false;
+
+    SDL_RWops* rw = SDL_RWFromFile(path.c_str(), "wb");
+    if (!rw) {
+        std::cerr << "KeyframeIndex: Cannot write cache " << path << ": " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    CacheHeader header{};
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.stream_index = stream_index;
+    header.tb_num = time_base.num;
+    header.tb_den = time_base.den;
+    header.count = entries.size();
+
+    bool ok = SDL_RWwrite(rw, &header, sizeof(header), 1) == 1 &&
+              SDL_RWwrite(rw, entries.data(), sizeof(Entry), entries.size()) == entries.size();
+    SDL_RWclose(rw);
+    return ok;
+}
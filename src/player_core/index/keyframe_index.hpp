@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include "../../ffmpeg_utils/ffmpeg_headers.hpp"
+
+/**
+ * 视频流关键帧表：pts（流时间基）→ 包在文件中的字节偏移。
+ *
+ * 由后台索引线程扫描整个文件后一次性发布，之后只读；
+ * 解封装线程 seek 时查表，直接落在目标之前最近的关键帧上，省去解码后丢帧的开销。
+ * 结果按文件内容哈希保存为缓存文件，同一文件再次打开时直接加载。
+ */
+class KeyframeIndex
+{
+public:
+    struct Entry
+    {
+        int64_t pts;   // 关键帧显示时间（流时间基）
+        int64_t pos;   // 包的字节偏移，未知时为 -1
+    };
+
+    enum class Status
+    {
+        IDLE,       // 未开始（没有视频流或非本地文件）
+        BUILDING,   // 正在扫描
+        READY,      // 可用于 seek
+        FAILED      // 扫描失败或被中断
+    };
+
+    void reset();
+
+    // 发布扫描/加载结果（索引线程调用），entries 无需预先排序
+    void publish(std::vector<Entry> entries, int stream_index, AVRational time_base, bool from_cache);
+
+    void setStatus(Status status) { status_.store(status); }
+    Status status() const { return status_.load(); }
+    bool ready() const { return status_.load() == Status::READY; }
+
+    void setProgress(float progress) { progress_.store(progress); }
+    float progress() const { return progress_.load(); }
+
+    // 时间戳 <= ts 的最后一个关键帧
+    bool findBefore(int64_t ts, Entry& out) const;
+    // 时间戳 >= ts 的第一个关键帧
+    bool findAfter(int64_t ts, Entry& out) const;
+
+    int streamIndex() const { return stream_index_.load(); }
+    AVRational timeBase() const;
+    size_t size() const;
+    bool fromCache() const { return from_cache_.load(); }
+
+    // 缓存键：文件大小 + 首尾各 KEYFRAME_INDEX_HASH_BYTES 字节的 FNV-1a 哈希，无法读取时返回空串
+    static std::string cacheKey(const std::string& path);
+
+    // 缓存文件读写，stream_index/time_base 与当前文件不一致时视为失效
+    static bool loadCache(const std::string& key, int stream_index, AVRational time_base,
+                          std::vector<Entry>& entries);
+    static bool saveCache(const std::string& key, int stream_index, AVRational time_base,
+                          const std::vector<Entry>& entries);
+
+private:
+    static std::string cachePath(const std::string& key);
+
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;       // 按 pts 升序
+    AVRational time_base_{1, AV_TIME_BASE};
+
+    std::atomic<Status> status_{Status::IDLE};
+    std::atomic<float> progress_{0.0f};
+    std::atomic<int> stream_index_{-1};
+    std::atomic<bool> from_cache_{false};
+};
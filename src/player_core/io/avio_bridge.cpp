@@ -0,0 +1,46 @@
+#include "avio_bridge.hpp"
+#include <iostream>
+
+AvioBridge::AvioBridge(std::unique_ptr<IoSource> source, int buffer_size)
+    : source_(std::move(source))
+{
+    uint8_t* buffer = static_cast<uint8_t*>(av_malloc(buffer_size));
+    if (!buffer) {
+        std::cerr << "AvioBridge: Failed to allocate AVIO buffer" << std::endl;
+        return;
+    }
+
+    avio_ctx_ = avio_alloc_context(buffer, buffer_size, 0, this,
+                                   &AvioBridge::readPacket, nullptr, &AvioBridge::seek);
+    if (!avio_ctx_) {
+        std::cerr << "AvioBridge: Failed to allocate AVIOContext" << std::endl;
+        av_free(buffer);
+    }
+}
+
+AvioBridge::~AvioBridge()
+{
+    if (avio_ctx_) {
+        // 缓冲区可能已被 FFmpeg 重新分配，释放 avio_ctx_->buffer 而不是最初的指针
+        av_freep(&avio_ctx_->buffer);
+        avio_context_free(&avio_ctx_);
+    }
+}
+
+void AvioBridge::attach(AVFormatContext* fmt_ctx)
+{
+    fmt_ctx->pb = avio_ctx_;
+    fmt_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+}
+
+int AvioBridge::readPacket(void* opaque, uint8_t* buf, int buf_size)
+{
+    AvioBridge* self = static_cast<AvioBridge*>(opaque);
+    return self->source_->read(buf, buf_size);
+}
+
+int64_t AvioBridge::seek(void* opaque, int64_t offset, int whence)
+{
+    AvioBridge* self = static_cast<AvioBridge*>(opaque);
+    return self->source_->seek(offset, whence);
+}
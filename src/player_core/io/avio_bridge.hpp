@@ -0,0 +1,34 @@
+#pragma once
+
+#include <memory>
+#include "io_source.hpp"
+#include "../../ffmpeg_utils/ffmpeg_headers.hpp"
+
+/**
+ * 把 IoSource 包装成 AVIOContext，交给 avformat_open_input 使用。
+ *
+ * 用法：attach() 把 pb 挂到预先分配的 AVFormatContext 上并设置 AVFMT_FLAG_CUSTOM_IO；
+ * avformat_close_input 不会释放自定义 pb，必须在关闭格式上下文之后再销毁本对象。
+ */
+class AvioBridge
+{
+public:
+    AvioBridge(std::unique_ptr<IoSource> source, int buffer_size);
+    ~AvioBridge();
+
+    AvioBridge(const AvioBridge&) = delete;
+    AvioBridge& operator=(const AvioBridge&) = delete;
+
+    bool valid() const { return avio_ctx_ != nullptr; }
+    void attach(AVFormatContext* fmt_ctx);
+
+    const char* backendName() const { return source_->name(); }
+    IoStats getStats() const { return source_->getStats(); }
+
+private:
+    static int readPacket(void* opaque, uint8_t* buf, int buf_size);
+    static int64_t seek(void* opaque, int64_t offset, int whence);
+
+    std::unique_ptr<IoSource> source_;
+    AVIOContext* avio_ctx_ = nullptr;
+};
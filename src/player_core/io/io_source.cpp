@@ -0,0 +1,115 @@
+#include "io_source.hpp"
+#include "mmap_source.hpp"
+#include "readahead_source.hpp"
+#include "../utils/player_constants.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+IoOptions IoOptions::fromEnvironment()
+{
+    IoOptions options;
+    options.backend = IoBackend::AUTO;
+    options.block_size = IO_READAHEAD_BLOCK_SIZE;
+    options.block_count = IO_READAHEAD_BLOCK_COUNT;
+
+    if (const char* backend = std::getenv("SDL2_PLAYER_IO")) {
+        if (std::strcmp(backend, "ffmpeg") == 0) options.backend = IoBackend::FFMPEG;
+        else if (std::strcmp(backend, "mmap") == 0) options.backend = IoBackend::MMAP;
+        else if (std::strcmp(backend, "readahead") == 0) options.backend = IoBackend::READAHEAD;
+        else if (std::strcmp(backend, "auto") == 0) options.backend = IoBackend::AUTO;
+        else std::cerr << "Unknown SDL2_PLAYER_IO value: " << backend << std::endl;
+    }
+
+    if (const char* block_kb = std::getenv("SDL2_PLAYER_IO_BLOCK_KB")) {
+        long kb = std::atol(block_kb);
+        if (kb >= 4) options.block_size = static_cast<size_t>(kb) * 1024;
+    }
+
+    if (const char* blocks = std::getenv("SDL2_PLAYER_IO_BLOCKS")) {
+        int count = std::atoi(blocks);
+        if (count >= 2) options.block_count = count;
+    }
+
+    return options;
+}
+
+bool io_is_local_path(const std::string& path)
+{
+    if (path.compare(0, 5, "file:") == 0) return true;
+
+    // 含协议前缀的是 URL（Windows 盘符 "C:\" 不算）
+    size_t pos = path.find("://");
+    return pos == std::string::npos;
+}
+
+std::unique_ptr<IoSource> IoSource::create(const IoOptions& options, const std::string& path)
+{
+    if (options.backend == IoBackend::FFMPEG || !io_is_local_path(path)) {
+        return nullptr;
+    }
+
+    std::string local_path = path.compare(0, 5, "file:") == 0 ? path.substr(5) : path;
+
+    std::unique_ptr<IoSource> source;
+    if (options.backend == IoBackend::MMAP) {
+        source = std::make_unique<MmapSource>();
+    } else {
+        source = std::make_unique<ReadaheadSource>(options.block_size, options.block_count);
+    }
+
+    if (!source->open(local_path)) {
+        std::cerr << "IoSource: " << source->name() << " backend failed to open "
+                  << local_path << ", falling back to FFmpeg I/O" << std::endl;
+        return nullptr;
+    }
+    return source;
+}
+
+FILE* io_open_file(const std::string& path)
+{
+    FILE* file = nullptr;
+#ifdef _WIN32
+    // 优先按 UTF-8 解释路径，失败再按系统代码页（文件对话框返回的是 ANSI 路径）
+    UINT code_page = CP_UTF8;
+    int len = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, path.c_str(), -1, nullptr, 0);
+    if (len <= 0) {
+        code_page = CP_ACP;
+        len = MultiByteToWideChar(CP_ACP, 0, path.c_str(), -1, nullptr, 0);
+    }
+    if (len <= 0) return nullptr;
+
+    std::wstring wpath(len, L'\0');
+    MultiByteToWideChar(code_page, 0, path.c_str(), -1, &wpath[0], len);
+    file = _wfopen(wpath.c_str(), L"rb");
+#else
+    file = std::fopen(path.c_str(), "rb");
+#endif
+    if (file) {
+        // 关闭 stdio 缓冲：预读层自己做大块缓冲，每次 fread 对应一次系统调用
+        std::setvbuf(file, nullptr, _IONBF, 0);
+    }
+    return file;
+}
+
+int io_seek_file(FILE* file, int64_t offset, int whence)
+{
+#ifdef _WIN32
+    return _fseeki64(file, offset, whence);
+#else
+    return fseeko(file, static_cast<off_t>(offset), whence);
+#endif
+}
+
+int64_t io_tell_file(FILE* file)
+{
+#ifdef _WIN32
+    return _ftelli64(file);
+#else
+    return static_cast<int64_t>(ftello(file));
+#endif
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * 解封装器下层的 I/O 后端类型。
+ */
+enum class IoBackend
+{
+    FFMPEG,     // 不接管，使用 FFmpeg 自带的 file/网络协议
+    MMAP,       // 本地文件内存映射
+    READAHEAD,  // 独立 I/O 线程按大块预读
+    AUTO        // 本地文件使用预读，URL 交给 FFmpeg
+};
+
+/**
+ * I/O 配置，默认值可被环境变量覆盖：
+ *   SDL2_PLAYER_IO=ffmpeg|mmap|readahead|auto
+ *   SDL2_PLAYER_IO_BLOCK_KB=<预读块大小，KB>
+ *   SDL2_PLAYER_IO_BLOCKS=<预读块数量>
+ */
+struct IoOptions
+{
+    IoBackend backend;
+    size_t block_size;
+    int block_count;
+
+    static IoOptions fromEnvironment();
+};
+
+/**
+ * I/O 统计（任意线程读取）。
+ */
+struct IoStats
+{
+    int64_t bytes_read;   // 从文件/映射读出的字节数
+    int64_t syscalls;     // 打开、读取、定位等系统调用次数
+};
+
+/**
+ * 可被 AVIOContext 包装的只读字节源。
+ *
+ * read/seek 只由解封装线程调用，语义与 AVIOContext 的回调一致：
+ * read 返回读到的字节数或 AVERROR_EOF，seek 支持 SEEK_SET/SEEK_CUR/SEEK_END 和 AVSEEK_SIZE。
+ */
+class IoSource
+{
+public:
+    virtual ~IoSource() = default;
+
+    virtual bool open(const std::string& path) = 0;
+    virtual int read(uint8_t* buf, int size) = 0;
+    virtual int64_t seek(int64_t offset, int whence) = 0;
+    virtual int64_t size() const = 0;
+    virtual const char* name() const = 0;
+
+    IoStats getStats() const { return {bytes_read_.load(), syscalls_.load()}; }
+
+    // 根据配置和文件名创建后端，FFMPEG 或无法接管时返回 nullptr
+    static std::unique_ptr<IoSource> create(const IoOptions& options, const std::string& path);
+
+protected:
+    std::atomic<int64_t> bytes_read_{0};
+    std::atomic<int64_t> syscalls_{0};
+};
+
+// 以只读方式打开本地文件（Windows 下支持 UTF-8/ANSI 路径），关闭缓冲以便精确统计系统调用
+FILE* io_open_file(const std::string& path);
+
+// 64 位文件定位
+int io_seek_file(FILE* file, int64_t offset, int whence);
+int64_t io_tell_file(FILE* file);
+
+// 是否为本地文件路径（不含协议前缀，或 file: 前缀）
+bool io_is_local_path(const std::string& path);
@@ -0,0 +1,138 @@
+#include "mmap_source.hpp"
+#include "../../ffmpeg_utils/ffmpeg_headers.hpp"
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MmapSource::~MmapSource()
+{
+    close();
+}
+
+bool MmapSource::open(const std::string& path)
+{
+    close();
+
+#ifdef _WIN32
+    // 与 io_open_file 一致：优先 UTF-8，失败按系统代码页
+    UINT code_page = CP_UTF8;
+    int len = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, path.c_str(), -1, nullptr, 0);
+    if (len <= 0) {
+        code_page = CP_ACP;
+        len = MultiByteToWideChar(CP_ACP, 0, path.c_str(), -1, nullptr, 0);
+    }
+    if (len <= 0) return false;
+    std::wstring wpath(len, L'\0');
+    MultiByteToWideChar(code_page, 0, path.c_str(), -1, &wpath[0], len);
+
+    HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    syscalls_++;
+    if (file == INVALID_HANDLE_VALUE) return false;
+    file_handle_ = file;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0) {
+        close();
+        return false;
+    }
+    size_ = file_size.QuadPart;
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    syscalls_++;
+    if (!mapping) {
+        close();
+        return false;
+    }
+    mapping_handle_ = mapping;
+
+    data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    syscalls_++;
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    syscalls_++;
+    if (fd_ < 0) return false;
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || st.st_size <= 0) {
+        close();
+        return false;
+    }
+    size_ = st.st_size;
+
+    void* addr = mmap(nullptr, static_cast<size_t>(size_), PROT_READ, MAP_PRIVATE, fd_, 0);
+    syscalls_ += 2;
+    if (addr == MAP_FAILED) {
+        close();
+        return false;
+    }
+    data_ = static_cast<const uint8_t*>(addr);
+
+    // 解封装基本是顺序读，提示内核积极预读
+    madvise(addr, static_cast<size_t>(size_), MADV_SEQUENTIAL);
+#endif
+
+    if (!data_) {
+        close();
+        return false;
+    }
+
+    pos_ = 0;
+    return true;
+}
+
+void MmapSource::close()
+{
+#ifdef _WIN32
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_handle_) CloseHandle(static_cast<HANDLE>(mapping_handle_));
+    if (file_handle_) CloseHandle(static_cast<HANDLE>(file_handle_));
+    mapping_handle_ = nullptr;
+    file_handle_ = nullptr;
+#else
+    if (data_) munmap(const_cast<uint8_t*>(data_), static_cast<size_t>(size_));
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    pos_ = 0;
+}
+
+int MmapSource::read(uint8_t* buf, int size)
+{
+    if (!data_) return AVERROR(EIO);
+    if (pos_ >= size_) return AVERROR_EOF;
+
+    int n = static_cast<int>(std::min<int64_t>(size, size_ - pos_));
+    std::memcpy(buf, data_ + pos_, n);
+    pos_ += n;
+    bytes_read_ += n;
+    return n;
+}
+
+int64_t MmapSource::seek(int64_t offset, int whence)
+{
+    if (whence & AVSEEK_SIZE) return size_;
+
+    int64_t target;
+    switch (whence & ~AVSEEK_FORCE) {
+        case SEEK_SET: target = offset; break;
+        case SEEK_CUR: target = pos_ + offset; break;
+        case SEEK_END: target = size_ + offset; break;
+        default: return AVERROR(EINVAL);
+    }
+
+    if (target < 0) return AVERROR(EINVAL);
+    pos_ = target;
+    return pos_;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "io_source.hpp"
+
+/**
+ * 内存映射本地文件：整个文件只读映射到地址空间，read 退化为 memcpy，
+ * seek 只移动偏移，没有逐次的 read/lseek 系统调用。
+ */
+class MmapSource : public IoSource
+{
+public:
+    MmapSource() = default;
+    ~MmapSource() override;
+
+    bool open(const std::string& path) override;
+    int read(uint8_t* buf, int size) override;
+    int64_t seek(int64_t offset, int whence) override;
+    int64_t size() const override { return size_; }
+    const char* name() const override { return "mmap"; }
+
+private:
+    void close();
+
+    const uint8_t* data_ = nullptr;
+    int64_t size_ = 0;
+    int64_t pos_ = 0;
+
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
@@ -0,0 +1,223 @@
+#include "readahead_source.hpp"
+#include "../../ffmpeg_utils/ffmpeg_headers.hpp"
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+
+ReadaheadSource::ReadaheadSource(size_t block_size, int block_count)
+    : block_size_(block_size > 0 ? block_size : 1024 * 1024),
+      block_count_(block_count >= 2 ? block_count : 2)
+{
+}
+
+ReadaheadSource::~ReadaheadSource()
+{
+    close();
+}
+
+bool ReadaheadSource::open(const std::string& path)
+{
+    close();
+
+    file_ = io_open_file(path);
+    syscalls_++;
+    if (!file_) return false;
+
+    if (io_seek_file(file_, 0, SEEK_END) != 0) {
+        close();
+        return false;
+    }
+    size_ = io_tell_file(file_);
+    io_seek_file(file_, 0, SEEK_SET);
+    syscalls_ += 2;
+    if (size_ <= 0) {
+        close();
+        return false;
+    }
+
+    free_buffers_.clear();
+    for (int i = 0; i < block_count_; i++) {
+        free_buffers_.emplace_back(block_size_);
+    }
+
+    ready_.clear();
+    read_pos_ = 0;
+    fetch_pos_ = 0;
+    file_pos_ = 0;
+    epoch_ = 0;
+    error_ = 0;
+    eof_ = false;
+    stop_ = false;
+
+    thread_ = std::thread(&ReadaheadSource::ioLoop, this);
+    return true;
+}
+
+void ReadaheadSource::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cond_space_.notify_all();
+    cond_data_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    ready_.clear();
+    size_ = 0;
+}
+
+void ReadaheadSource::ioLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (!stop_)
+    {
+        cond_space_.wait(lock, [this]() {
+            return stop_ || (!eof_ && error_ == 0 && !free_buffers_.empty());
+        });
+        if (stop_) break;
+
+        int64_t pos = fetch_pos_;
+        uint64_t epoch = epoch_;
+        Block block;
+        block.pos = pos;
+        block.data = std::move(free_buffers_.back());
+        free_buffers_.pop_back();
+
+        // 读文件时不持锁，解封装线程可以继续消费已有的块
+        lock.unlock();
+
+        int io_error = 0;
+        size_t n = 0;
+        if (file_pos_ != pos) {
+            syscalls_++;
+            if (io_seek_file(file_, pos, SEEK_SET) != 0) {
+                io_error = AVERROR(EIO);
+            }
+        }
+        if (io_error == 0) {
+            n = std::fread(block.data.data(), 1, block_size_, file_);
+            syscalls_++;
+            if (n == 0 && std::ferror(file_)) {
+                io_error = AVERROR(EIO);
+                std::clearerr(file_);
+            }
+            file_pos_ = pos + static_cast<int64_t>(n);
+            bytes_read_ += static_cast<int64_t>(n);
+        }
+
+        lock.lock();
+
+        if (epoch != epoch_) {
+            // 读取期间发生了重新定位，结果作废
+            free_buffers_.push_back(std::move(block.data));
+            continue;
+        }
+
+        if (io_error != 0) {
+            error_ = io_error;
+            free_buffers_.push_back(std::move(block.data));
+        } else if (n == 0) {
+            eof_ = true;
+            free_buffers_.push_back(std::move(block.data));
+        } else {
+            block.size = n;
+            fetch_pos_ = pos + static_cast<int64_t>(n);
+            ready_.push_back(std::move(block));
+        }
+        cond_data_.notify_all();
+    }
+}
+
+void ReadaheadSource::recycleFront()
+{
+    free_buffers_.push_back(std::move(ready_.front().data));
+    ready_.pop_front();
+    cond_space_.notify_one();
+}
+
+void ReadaheadSource::restartAt(int64_t pos)
+{
+    while (!ready_.empty()) {
+        recycleFront();
+    }
+    epoch_++;
+    fetch_pos_ = pos;
+    eof_ = false;
+    error_ = 0;
+    cond_space_.notify_one();
+}
+
+int ReadaheadSource::read(uint8_t* buf, int size)
+{
+    if (size <= 0) return 0;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!file_) return AVERROR(EIO);
+
+    while (!stop_)
+    {
+        // 丢弃已经完全读过的块
+        while (!ready_.empty() &&
+               ready_.front().pos + static_cast<int64_t>(ready_.front().size) <= read_pos_) {
+            recycleFront();
+        }
+
+        if (!ready_.empty() && ready_.front().pos <= read_pos_) {
+            // 在已预读的连续块中尽量多拷贝
+            int copied = 0;
+            for (const Block& block : ready_) {
+                if (copied >= size) break;
+                int64_t offset = read_pos_ - block.pos;
+                if (offset < 0 || offset >= static_cast<int64_t>(block.size)) break;
+
+                int n = static_cast<int>(std::min<int64_t>(size - copied, static_cast<int64_t>(block.size) - offset));
+                std::memcpy(buf + copied, block.data.data() + offset, n);
+                copied += n;
+                read_pos_ += n;
+            }
+            return copied;
+        }
+
+        // 读位置不在预读窗口内（seek 到窗口之前或之后），从读位置重新预读
+        bool outside = ready_.empty() ? fetch_pos_ != read_pos_ : ready_.front().pos > read_pos_;
+        if (outside) {
+            restartAt(read_pos_);
+        }
+
+        if (error_ != 0) return error_;
+        if (eof_ || read_pos_ >= size_) return AVERROR_EOF;
+
+        cond_data_.wait(lock);
+    }
+
+    return AVERROR_EXIT;
+}
+
+int64_t ReadaheadSource::seek(int64_t offset, int whence)
+{
+    if (whence & AVSEEK_SIZE) return size_;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    int64_t target;
+    switch (whence & ~AVSEEK_FORCE) {
+        case SEEK_SET: target = offset; break;
+        case SEEK_CUR: target = read_pos_ + offset; break;
+        case SEEK_END: target = size_ + offset; break;
+        default: return AVERROR(EINVAL);
+    }
+    if (target < 0) return AVERROR(EINVAL);
+
+    // 只记录位置：目标仍在预读窗口内时下一次 read 直接命中，否则由 read 重新预读
+    read_pos_ = target;
+    return target;
+}
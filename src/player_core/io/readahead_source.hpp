@@ -0,0 +1,62 @@
+#pragma once
+
+#include "io_source.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+/**
+ * 大块预读：独立的 I/O 线程按 block_size 顺序读取文件，最多预读 block_count 块。
+ *
+ * 解封装线程的 read 只从已读好的块里拷贝；seek 落在预读窗口内时直接命中，
+ * 落在窗口外时丢弃已预读的块，I/O 线程从新位置重新开始。
+ * 慢盘/网络盘上的读延迟因此由 I/O 线程承担，不再直接阻塞解封装。
+ */
+class ReadaheadSource : public IoSource
+{
+public:
+    ReadaheadSource(size_t block_size, int block_count);
+    ~ReadaheadSource() override;
+
+    bool open(const std::string& path) override;
+    int read(uint8_t* buf, int size) override;
+    int64_t seek(int64_t offset, int whence) override;
+    int64_t size() const override { return size_; }
+    const char* name() const override { return "readahead"; }
+
+private:
+    struct Block
+    {
+        int64_t pos = 0;              // 块在文件中的起始偏移
+        size_t size = 0;              // 有效字节数
+        std::vector<uint8_t> data;
+    };
+
+    void ioLoop();
+    void close();
+    void restartAt(int64_t pos);      // 调用方持有 mutex_
+    void recycleFront();              // 调用方持有 mutex_
+
+    size_t block_size_;
+    int block_count_;
+
+    FILE* file_ = nullptr;
+    int64_t size_ = 0;
+    int64_t file_pos_ = 0;            // 仅 I/O 线程访问
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cond_data_;   // 有新块可读
+    std::condition_variable cond_space_;  // 有空闲块可填充 / 需要重新定位
+
+    std::deque<Block> ready_;              // 已读好的连续块
+    std::vector<std::vector<uint8_t>> free_buffers_;
+    int64_t read_pos_ = 0;                 // 解封装线程的逻辑读位置
+    int64_t fetch_pos_ = 0;                // I/O 线程下一次读取的位置
+    uint64_t epoch_ = 0;                   // 每次重新定位加一，丢弃过期的读取结果
+    int error_ = 0;
+    bool eof_ = false;
+    bool stop_ = false;
+};
@@ -0,0 +1,149 @@
+#include "media_input.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// 查找音频和视频流（各取第一个）
+void selectStreams(MediaInput& input)
+{
+    input.audio_stream = -1;
+    input.video_stream = -1;
+    for (unsigned int i = 0; i < input.fmt_ctx->nb_streams; i++)
+    {
+        AVMediaType type = input.fmt_ctx->streams[i]->codecpar->codec_type;
+        if (type == AVMEDIA_TYPE_AUDIO && input.audio_stream < 0)
+        {
+            input.audio_stream = i;
+        }
+        else if (type == AVMEDIA_TYPE_VIDEO && input.video_stream < 0)
+        {
+            input.video_stream = i;
+        }
+    }
+}
+
+// 解码器和输出需要的参数是否都已探测到
+bool streamComplete(const AVFormatContext* fmt_ctx, int stream_index)
+{
+    if (stream_index < 0) return true;
+    const AVCodecParameters* codecpar = fmt_ctx->streams[stream_index]->codecpar;
+    if (codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
+        return codecpar->sample_rate > 0 && codecpar->channels > 0 && codecpar->format != AV_SAMPLE_FMT_NONE;
+    }
+    return codecpar->width > 0 && codecpar->height > 0 && codecpar->format != AV_PIX_FMT_NONE;
+}
+
+} // namespace
+
+ProbeOptions ProbeOptions::fromEnvironment()
+{
+    ProbeOptions options;
+    options.fast = true;
+
+    if (const char* fast = std::getenv("SDL2_PLAYER_FAST_OPEN")) {
+        options.fast = std::strcmp(fast, "0") != 0;
+    }
+    return options;
+}
+
+void MediaInput::close()
+{
+    if (fmt_ctx)
+    {
+        avformat_close_input(&fmt_ctx);
+        fmt_ctx = nullptr;
+    }
+    // 自定义 AVIOContext 不随格式上下文释放
+    avio.reset();
+    audio_stream = -1;
+    video_stream = -1;
+    probe_us = 0;
+    limited_probe = false;
+}
+
+PlayerError openMediaInput(const IoOptions& io_options, const ProbeOptions& probe, const std::string& filename,
+                           MediaInput& input, std::string& message, const AVIOInterruptCB* interrupt)
+{
+    input.close();
+    int64_t start = av_gettime_relative();
+
+    // 按配置接管文件 I/O（本地文件走预读/内存映射，URL 交给 FFmpeg 自带协议）
+    input.fmt_ctx = avformat_alloc_context();
+    if (!input.fmt_ctx)
+    {
+        message = "Cannot allocate format context";
+        return PlayerError::OUT_OF_MEMORY;
+    }
+    if (interrupt)
+    {
+        input.fmt_ctx->interrupt_callback = *interrupt;
+    }
+    if (auto source = IoSource::create(io_options, filename))
+    {
+        auto bridge = std::make_unique<AvioBridge>(std::move(source), IO_AVIO_BUFFER_SIZE);
+        if (bridge->valid())
+        {
+            bridge->attach(input.fmt_ctx);
+            input.avio = std::move(bridge);
+        }
+    }
+
+    // 快速打开：流信息探测只读开头一小段、只分析很短的时长
+    int64_t default_probe_size = input.fmt_ctx->probesize;
+    int64_t default_analyze_duration = input.fmt_ctx->max_analyze_duration;
+    if (probe.fast)
+    {
+        input.fmt_ctx->probesize = probe.probe_size;
+        input.fmt_ctx->max_analyze_duration = probe.analyze_duration;
+    }
+
+    // 打开输入文件（失败时 FFmpeg 会释放 fmt_ctx 并置空）
+    if (avformat_open_input(&input.fmt_ctx, filename.c_str(), nullptr, nullptr) < 0)
+    {
+        input.close();
+        message = "Cannot open file: " + filename;
+        return PlayerError::FILE_OPEN_FAILED;
+    }
+
+    // 获取流信息
+    if (avformat_find_stream_info(input.fmt_ctx, nullptr) < 0)
+    {
+        input.close();
+        message = "Could not find stream information";
+        return PlayerError::STREAM_INFO_FAILED;
+    }
+
+    selectStreams(input);
+
+    // 限量探测没拿到选中流的参数（或者一个流都没找到）时按默认范围再探测一次
+    bool complete = (input.audio_stream >= 0 || input.video_stream >= 0) &&
+                    streamComplete(input.fmt_ctx, input.audio_stream) &&
+                    streamComplete(input.fmt_ctx, input.video_stream);
+    if (probe.fast && !complete)
+    {
+        std::cout << "MediaInput: Limited probe incomplete after " << (av_gettime_relative() - start) / 1000
+                  << " ms, probing fully" << std::endl;
+        input.fmt_ctx->probesize = default_probe_size;
+        input.fmt_ctx->max_analyze_duration = default_analyze_duration;
+        if (avformat_find_stream_info(input.fmt_ctx, nullptr) < 0)
+        {
+            input.close();
+            message = "Could not find stream information";
+            return PlayerError::STREAM_INFO_FAILED;
+        }
+        selectStreams(input);
+    }
+
+    if (input.audio_stream < 0 && input.video_stream < 0)
+    {
+        input.close();
+        message = "No audio or video streams found";
+        return PlayerError::STREAM_INFO_FAILED;
+    }
+
+    input.limited_probe = probe.fast && complete;
+    input.probe_us = av_gettime_relative() - start;
+    return PlayerError::NONE;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include "io/avio_bridge.hpp"
+#include "utils/player_constants.hpp"
+#include "../ffmpeg_utils/ffmpeg_headers.hpp"
+
+/**
+ * 流信息探测的范围。
+ *
+ * 快速打开时限制 avformat_find_stream_info 读取的字节数和分析的时长：网络存储上的大 MKV
+ * 按默认值要读几 MB、分析几秒才返回。选中的流参数不完整时退回完整探测，不影响正确性。
+ * 环境变量：
+ *   SDL2_PLAYER_FAST_OPEN=0|1（默认 1）
+ */
+struct ProbeOptions
+{
+    bool fast = false;
+    int64_t probe_size = FAST_OPEN_PROBE_SIZE;
+    int64_t analyze_duration = FAST_OPEN_ANALYZE_DURATION_MS * 1000;   // 微秒
+
+    static ProbeOptions fromEnvironment();
+};
+
+/**
+ * 已打开并完成探测的输入：格式上下文、自定义 I/O 和选中的音视频流。
+ *
+ * 解封装线程和播放列表预加载线程共用 openMediaInput；结果可以整体移交给 PlayerState。
+ */
+struct MediaInput
+{
+    AVFormatContext* fmt_ctx = nullptr;
+    std::unique_ptr<AvioBridge> avio;   // 必须在 fmt_ctx 关闭之后释放
+    int audio_stream = -1;
+    int video_stream = -1;
+    int64_t probe_us = 0;        // 打开和探测的耗时
+    bool limited_probe = false;  // 限量探测已足够（流信息可能不完整，例如时长未知）
+
+    MediaInput() = default;
+    ~MediaInput() { close(); }
+
+    MediaInput(const MediaInput&) = delete;
+    MediaInput& operator=(const MediaInput&) = delete;
+
+    void close();
+};
+
+/**
+ * 打开文件并按 probe 探测流信息，选出第一个音频流和第一个视频流。
+ *
+ * interrupt 不为空时设置为格式上下文的中断回调（取消打开或预加载时让阻塞的读取尽快返回）。
+ * 失败时返回对应的错误码，message 为错误描述，input 保持关闭状态。
+ */
+PlayerError openMediaInput(const IoOptions& io_options, const ProbeOptions& probe, const std::string& filename,
+                           MediaInput& input, std::string& message, const AVIOInterruptCB* interrupt = nullptr);
@@ -1,6 +1,8 @@
 #include "player_state.hpp"
 #include <iostream>
 #include <thread>
+#include <cmath>
+#include <algorithm>
 
 extern "C" {
 #include <libavutil/frame.h>
@@ -15,6 +17,68 @@ PlayerState::PlayerState()
     video_packet_queue.set_quit(false);
     audio_frame_queue.set_quit(false);
     video_frame_queue.set_quit(false);
+
+    // 按字节数和时长限制队列，元素个数上限只作为槽位数
+    audio_packet_queue.set_limits(MAX_AUDIO_PACKET_BYTES, MAX_PACKET_QUEUE_SECONDS);
+    video_packet_queue.set_limits(MAX_VIDEO_PACKET_BYTES, MAX_PACKET_QUEUE_SECONDS);
+    audio_frame_queue.set_limits(MAX_AUDIO_FRAME_BYTES, MAX_AUDIO_FRAME_SECONDS);
+    video_frame_queue.set_limits(MAX_VIDEO_FRAME_BYTES, MAX_VIDEO_FRAME_SECONDS);
+
+    // 流控：包队列降到恢复水位时唤醒解封装线程，视频帧队列有数据时唤醒刷新定时器
+    audio_packet_queue.set_space_signal(&packet_space_signal, PACKET_QUEUE_RESUME_RATIO);
+    video_packet_queue.set_space_signal(&packet_space_signal, PACKET_QUEUE_RESUME_RATIO);
+    video_frame_queue.set_data_signal(&video_frame_signal);
+}
+
+// 数据包代价：压缩数据大小 + 包时长
+static QueueItemCost packetCost(const PacketHandle& pkt, AVRational time_base)
+{
+    QueueItemCost cost;
+    cost.bytes = pkt->size > 0 ? pkt->size : 0;
+    if (pkt->duration > 0) {
+        cost.duration_us = av_rescale_q(pkt->duration, time_base, AV_TIME_BASE_Q);
+    }
+    return cost;
+}
+
+// 解码帧代价：引用的缓冲区大小 + 帧时长（音频按样本数计算）
+static QueueItemCost frameCost(const AVFrame* frame, AVRational time_base)
+{
+    QueueItemCost cost;
+    if (!frame) return cost;
+
+    for (int i = 0; i < AV_NUM_DATA_POINTERS && frame->buf[i]; i++) {
+        cost.bytes += frame->buf[i]->size;
+    }
+    for (int i = 0; i < frame->nb_extended_buf; i++) {
+        cost.bytes += frame->extended_buf[i]->size;
+    }
+
+    if (frame->nb_samples > 0 && frame->sample_rate > 0) {
+        cost.duration_us = (int64_t)frame->nb_samples * 1000000 / frame->sample_rate;
+    } else if (frame->pkt_duration > 0) {
+        cost.duration_us = av_rescale_q(frame->pkt_duration, time_base, AV_TIME_BASE_Q);
+    }
+    return cost;
+}
+
+void PlayerState::configureQueueLimits()
+{
+    if (!fmt_ctx) return;
+
+    if (audio_stream >= 0) {
+        AVRational tb = fmt_ctx->streams[audio_stream]->time_base;
+        audio_packet_queue.set_cost_func([tb](const PacketHandle& pkt) { return packetCost(pkt, tb); });
+    }
+
+    if (video_stream >= 0) {
+        AVRational tb = fmt_ctx->streams[video_stream]->time_base;
+        video_packet_queue.set_cost_func([tb](const PacketHandle& pkt) { return packetCost(pkt, tb); });
+    }
+
+    // 解码线程送出的帧已换算到微秒时间轴，与条目的时间基无关
+    audio_frame_queue.set_cost_func([](AVFrame* const& frame) { return frameCost(frame, AV_TIME_BASE_Q); });
+    video_frame_queue.set_cost_func([](AVFrame* const& frame) { return frameCost(frame, AV_TIME_BASE_Q); });
 }
 
 PlayerState::~PlayerState() 
@@ -44,6 +108,8 @@ void PlayerState::clearForReload(bool set_quit_flag)
     // 通知所有等待的线程
     demux_ready_cv.notify_all();
     threads_cv.notify_all();
+    packet_space_signal.notify();
+    video_frame_signal.notify();
     
     // 设置队列退出标志
     audio_packet_queue.set_quit(true);
@@ -73,6 +139,12 @@ void PlayerState::clearForReload(bool set_quit_flag)
         avformat_close_input(&fmt_ctx);
         fmt_ctx = nullptr;
     }
+
+    // 自定义 AVIOContext 不随格式上下文释放
+    avio.reset();
+
+    // 关键帧索引属于上一个文件
+    keyframe_index.reset();
     
     // 清理图像转换上下文
     if (sws_ctx) 
@@ -95,6 +167,12 @@ void PlayerState::clearForReload(bool set_quit_flag)
     video_packet_queue.reset();  // 修改：使用reset而不是clear
     audio_frame_queue.reset();   // 修改：使用reset而不是clear
     video_frame_queue.reset();   // 修改：使用reset而不是clear
+
+    // 队列已把帧归还给池，释放空闲帧（新文件的分辨率/格式可能不同）
+    audio_frame_pool.trim();
+    video_frame_pool.trim();
+    audio_frame_pool.resetStats();
+    video_frame_pool.resetStats();
     
     // 重置所有状态
     demux_ready.store(false);
@@ -111,13 +189,20 @@ void PlayerState::clearForReload(bool set_quit_flag)
     seek_rel.store(0);
     seek_flags.store(0);
     seek_target_pts.store(AV_NOPTS_VALUE);
+
+    media_duration.store(AV_NOPTS_VALUE);
+
+    // 新文件从条目内时间开始
+    timeline_offset.store(0);
+    previous_timeline_offset.store(0);
+    audio_timeline_end.store(AV_NOPTS_VALUE);
+    video_timeline_end.store(AV_NOPTS_VALUE);
     
     // 重置统计信息
     stats.reset();
     
     // 重置时钟，使用新的reset方法
-    audio_clock.reset();  // 修改：使用reset方法
-    video_clock.reset();  // 修改：使用reset方法
+    sync.reset();  // 三个时钟一起重置，外部时钟回到未启动状态
     
     // 重置错误状态
     error.store(PlayerError::NONE);
@@ -139,6 +224,9 @@ void PlayerState::resetForNewFile()
     demux_finished.store(false);
     audio_eof.store(false);
     video_eof.store(false);
+    seek_request_time.store(0);
+    seek_display_pts.store(NAN);
+    metrics.reset();
     
     // 确保线程计数器重置
     running_threads.store(0);
@@ -146,11 +234,14 @@ void PlayerState::resetForNewFile()
     std::cout << "PlayerState reset for new file" << std::endl;
 }
 
-void PlayerState::set_error(PlayerError err, const std::string& msg) 
+void PlayerState::set_error(PlayerError err, const std::string& msg, bool stop) 
 {
-    error.store(err);
+    // 先写描述再发布错误码，看到错误码的线程能读到完整描述
     error_message = msg;
-    quit.store(true);
+    error.store(err);
+    if (stop) {
+        quit.store(true);
+    }
     std::cerr << "Player Error: " << msg << std::endl;
 }
 
@@ -193,8 +284,43 @@ void PlayerState::update_video_clock(double pts)
 
 double PlayerState::get_master_clock() 
 {
-    // 返回音频时钟的值作为主时钟
-    return audio_clock.get();
+    // 由同步引擎按生效的主时钟返回
+    return sync.masterClock();
+}
+
+void PlayerState::adoptInput(MediaInput& input)
+{
+    fmt_ctx = input.fmt_ctx;
+    input.fmt_ctx = nullptr;
+    avio = std::move(input.avio);
+    audio_stream = input.audio_stream;
+    video_stream = input.video_stream;
+    media_duration.store(fmt_ctx->duration);
+    configureQueueLimits();
+}
+
+double PlayerState::get_video_frame_pts(const AVFrame* frame) const
+{
+    if (!frame || frame->pts == AV_NOPTS_VALUE) {
+        return NAN;
+    }
+    return frame->pts / (double)AV_TIME_BASE;
+}
+
+double PlayerState::itemPosition(double timeline_seconds) const
+{
+    // 时钟还没走到当前条目的起点时，听到/看到的仍是上一条目的尾部
+    double offset = timeline_offset.load() / (double)AV_TIME_BASE;
+    if (timeline_seconds < offset) {
+        offset = previous_timeline_offset.load() / (double)AV_TIME_BASE;
+    }
+    return std::max(0.0, timeline_seconds - offset);
+}
+
+double PlayerState::mediaDuration() const
+{
+    int64_t duration = media_duration.load();
+    return duration == AV_NOPTS_VALUE ? NAN : duration / (double)AV_TIME_BASE;
 }
 
 void PlayerState::doSeekAbsolute(double seconds) {
@@ -214,12 +340,12 @@ void PlayerState::doSeekAbsolute(double seconds) {
     // 确保时间在有效范围内
     if (seconds < 0.0) seconds = 0.0;
     
-    if (fmt_ctx->duration != AV_NOPTS_VALUE) {
-        double duration = fmt_ctx->duration / (double)AV_TIME_BASE;
-        if (seconds > duration) seconds = duration;
+    double duration = mediaDuration();
+    if (!std::isnan(duration) && seconds > duration) {
+        seconds = duration;
     }
     
-    double current_time = get_master_clock();
+    double current_time = itemPosition(get_master_clock());
     double incr = seconds - current_time;
     
     printf("Current time: %.2fs, Target: %.2fs, Increment: %.2fs\n", 
@@ -230,20 +356,65 @@ void PlayerState::doSeekAbsolute(double seconds) {
     seek_pos.store((int64_t)(seconds * AV_TIME_BASE));
     seek_flags.store((incr < 0) ? AVSEEK_FLAG_BACKWARD : 0);
     seek_target_pts.store(seek_pos.load());
+    seek_display_pts.store(NAN);
+    seek_request_time.store(av_gettime_relative());
     
     // ✅ 重要：设置 seek 请求标志
     seek_request.store(true);
+    packet_space_signal.notify(); // 唤醒可能因队列满而等待的解封装线程
     
     printf("Seek request set: pos=%lld, rel=%lld, flags=%d\n",
            seek_pos.load(), seek_rel.load(), seek_flags.load());
     
-    // 立即更新时钟以提供视觉反馈
-    audio_clock.set(seconds);
-    video_clock.set(seconds);
+    // 立即更新时钟以提供视觉反馈；seek 之后时间轴回到条目内时间
+    timeline_offset.store(0);
+    previous_timeline_offset.store(0);
+    sync.resetTo(seconds);
     
     printf("=== PlayerState::doSeekAbsolute END ===\n");
 }
 
+void PlayerState::record_seek_display(double pts)
+{
+    int64_t requested = seek_request_time.load();
+    if (requested == 0 || std::isnan(pts)) return;
+
+    double landed = seek_display_pts.load();
+    if (std::isnan(landed) || std::fabs(pts - landed) > 1e-6) return;
+
+    // 只结算一次（期间若有新的 seek 请求，CAS 失败，留给新请求结算）
+    if (!seek_request_time.compare_exchange_strong(requested, 0)) return;
+    seek_display_pts.store(NAN);
+
+    int64_t latency = av_gettime_relative() - requested;
+    stats.seek_count++;
+    stats.seek_latency_last_us.store(latency);
+    stats.seek_latency_total_us += latency;
+    int64_t max_latency = stats.seek_latency_max_us.load();
+    while (latency > max_latency && !stats.seek_latency_max_us.compare_exchange_weak(max_latency, latency)) {
+    }
+    printf("Seek displayed after %.1f ms (pts %.3fs)\n", latency / 1000.0, pts);
+}
+
+void PlayerState::record_first_video_frame()
+{
+    int64_t start = stats.open_start_us.load();
+    if (start == 0 || stats.first_frame_us.load() != 0) return;
+
+    int64_t latency = std::max<int64_t>(av_gettime_relative() - start, 1);
+    stats.first_frame_us.store(latency);
+    printf("Open: First frame displayed after %.1f ms (probe %.1f ms%s)\n", latency / 1000.0,
+           stats.probe_us.load() / 1000.0, stats.probe_limited.load() ? ", limited" : "");
+}
+
+void PlayerState::record_first_audio()
+{
+    // 在音频回调里调用，只做原子操作不打印
+    int64_t start = stats.open_start_us.load(std::memory_order_relaxed);
+    if (start == 0 || stats.first_audio_us.load(std::memory_order_relaxed) != 0) return;
+    stats.first_audio_us.store(std::max<int64_t>(av_gettime_relative() - start, 1), std::memory_order_relaxed);
+}
+
 void PlayerState::doSeekRelative(double incr_seconds) {
     printf("=== PlayerState::doSeekRelative START ===\n");
     printf("Increment: %.2f seconds\n", incr_seconds);
@@ -255,8 +426,8 @@ void PlayerState::doSeekRelative(double incr_seconds) {
 
     std::lock_guard<std::mutex> lock(seek_mutex);
     
-    // 获取当前播放位置
-    double current_time = get_master_clock();
+    // 获取当前播放位置（条目内时间）
+    double current_time = itemPosition(get_master_clock());
     double target_time = current_time + incr_seconds;
     
     // 确保目标时间在有效范围内
@@ -264,11 +435,9 @@ void PlayerState::doSeekRelative(double incr_seconds) {
         target_time = 0.0;
     }
     
-    if (fmt_ctx->duration != AV_NOPTS_VALUE) {
-        double duration = fmt_ctx->duration / (double)AV_TIME_BASE;
-        if (target_time > duration) {
-            target_time = duration;
-        }
+    double duration = mediaDuration();
+    if (!std::isnan(duration) && target_time > duration) {
+        target_time = duration;
     }
     
     printf("Current time: %.2fs, Target: %.2fs\n", current_time, target_time);
@@ -278,13 +447,17 @@ void PlayerState::doSeekRelative(double incr_seconds) {
     seek_pos.store((int64_t)(target_time * AV_TIME_BASE));
     seek_flags.store((incr_seconds < 0) ? AVSEEK_FLAG_BACKWARD : 0);
     seek_target_pts.store(seek_pos.load());
+    seek_display_pts.store(NAN);
+    seek_request_time.store(av_gettime_relative());
     
     // 重要：设置 seek 请求标志
     seek_request.store(true);
+    packet_space_signal.notify(); // 唤醒可能因队列满而等待的解封装线程
     
-    // 预先更新时钟到目标位置
-    audio_clock.set(target_time);
-    video_clock.set(target_time);
+    // 预先更新时钟到目标位置；seek 之后时间轴回到条目内时间
+    timeline_offset.store(0);
+    previous_timeline_offset.store(0);
+    sync.resetTo(target_time);
     
     printf("=== PlayerState::doSeekRelative END ===\n");
 }
\ No newline at end of file
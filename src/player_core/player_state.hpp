@@ -5,10 +5,20 @@
 #include <memory>
 #include <mutex>
 #include <condition_variable>
+#include <cmath>
 #include <SDL2/SDL.h>
-#include "utils/safe_queue.hpp"
+#include "utils/spsc_queue.hpp"
+#include "utils/frame_pool.hpp"
+#include "utils/packet_handle.hpp"
+#include "utils/flow_signal.hpp"
+#include "utils/pipeline_metrics.hpp"
+#include "utils/threading_policy.hpp"
+#include "io/avio_bridge.hpp"
+#include "media_input.hpp"
+#include "index/keyframe_index.hpp"
 #include "utils/player_constants.hpp"
 #include "../play/clock.hpp"
+#include "../play/sync_engine.hpp"
 #include "../ffmpeg_utils/ffmpeg_headers.hpp"
 
 /**
@@ -22,6 +32,7 @@ public:
     std::atomic<bool> quit{false};
     std::atomic<bool> paused{false};    // 暂停状态
     std::atomic<float> volume{1.0f};    // 全局音量（0.0~1.0）
+    std::atomic<double> playback_speed{1.0};   // UI 选择的播放速度，主循环交给同步引擎
     std::atomic<PlayerError> error{PlayerError::NONE};
     std::string error_message;
 
@@ -38,6 +49,19 @@ public:
     // 解封装器
     AVFormatContext* fmt_ctx = nullptr;
 
+    // 自定义 I/O（为空时使用 FFmpeg 自带协议），必须在 fmt_ctx 关闭之后释放
+    IoOptions io_options = IoOptions::fromEnvironment();
+    std::unique_ptr<AvioBridge> avio;
+
+    // 流信息探测范围（快速打开时限量探测）
+    ProbeOptions probe_options = ProbeOptions::fromEnvironment();
+
+    // 当前条目的总时长（微秒），未知时为 AV_NOPTS_VALUE；限量探测未得到时长时由后台探测补上
+    std::atomic<int64_t> media_duration{AV_NOPTS_VALUE};
+
+    // 视频关键帧索引（后台线程建立，READY 之后 seek 直接落到目标前的关键帧）
+    KeyframeIndex keyframe_index;
+
     // 音视频流索引
     int audio_stream = -1;
     int video_stream = -1;
@@ -46,21 +70,25 @@ public:
     AVCodecContext* audio_ctx = nullptr;
     AVCodecContext* video_ctx = nullptr;
 
-    // 队列（带容量限制）
-    SafeQueue<AVPacket> audio_packet_queue{MAX_AUDIO_PACKETS, [](AVPacket& pkt) {
-        av_packet_unref(&pkt);
-    }};
-    
-    SafeQueue<AVPacket> video_packet_queue{MAX_VIDEO_PACKETS, [](AVPacket& pkt) {
-        av_packet_unref(&pkt);
-    }};
+    // 流控信号（必须声明在队列之前，队列持有其指针）
+    FlowSignal packet_space_signal;   // 包队列降到恢复水位
+    FlowSignal video_frame_signal;    // 视频帧队列由空变为非空
+
+    // 帧复用池（必须声明在帧队列之前，保证队列先析构、把帧归还给池）
+    FramePool audio_frame_pool{MAX_AUDIO_FRAMES + FRAME_POOL_EXTRA_FRAMES, "audio"};
+    FramePool video_frame_pool{MAX_VIDEO_FRAMES + FRAME_POOL_EXTRA_FRAMES, "video"};
+
+    // 队列（带容量限制，每个队列只有一个生产者线程和一个消费者线程）
+    // 数据包由 PacketHandle 独占，出队/清空时随句柄析构自动释放
+    SpscQueue<PacketHandle> audio_packet_queue{MAX_AUDIO_PACKETS};
+    SpscQueue<PacketHandle> video_packet_queue{MAX_VIDEO_PACKETS};
     
-    SafeQueue<AVFrame*> audio_frame_queue{MAX_AUDIO_FRAMES, [](AVFrame*& frame) {
-        if (frame) av_frame_free(&frame);
+    SpscQueue<AVFrame*> audio_frame_queue{MAX_AUDIO_FRAMES, [this](AVFrame*& frame) {
+        audio_frame_pool.release(frame);
     }};
     
-    SafeQueue<AVFrame*> video_frame_queue{MAX_VIDEO_FRAMES, [](AVFrame*& frame) {
-        if (frame) av_frame_free(&frame);
+    SpscQueue<AVFrame*> video_frame_queue{MAX_VIDEO_FRAMES, [this](AVFrame*& frame) {
+        video_frame_pool.release(frame);
     }};
 
     // SDL 相关
@@ -85,6 +113,31 @@ public:
         std::atomic<int64_t> video_frames{0};
         std::atomic<int64_t> audio_bytes{0};
         std::atomic<int64_t> video_bytes{0};
+
+        // Seek 统计（请求到首帧显示的延迟，微秒）
+        std::atomic<int64_t> seek_count{0};
+        std::atomic<int64_t> seek_latency_last_us{0};
+        std::atomic<int64_t> seek_latency_max_us{0};
+        std::atomic<int64_t> seek_latency_total_us{0};
+        std::atomic<int64_t> seek_dropped_frames{0};   // 追赶目标时解码后丢弃的帧数
+
+        // 音频回调欠载（环形缓冲区读空，补静音）
+        std::atomic<int64_t> audio_underruns{0};
+        std::atomic<int64_t> audio_underrun_bytes{0};
+        // 已解码但尚未被听到的采样帧数（环形缓冲区 + 设备队列估计）
+        std::atomic<int64_t> audio_queued_frames{0};
+
+        // 打开文件（微秒）：开始打开的时刻（av_gettime_relative），探测耗时，
+        // 到第一帧上屏 / 第一次输出音频的延迟（0 表示尚未发生）
+        std::atomic<int64_t> open_start_us{0};
+        std::atomic<int64_t> probe_us{0};
+        std::atomic<bool> probe_limited{false};
+        std::atomic<int64_t> first_frame_us{0};
+        std::atomic<int64_t> first_audio_us{0};
+
+        // 呈现调度（显示器属性，换文件时不清零）
+        std::atomic<double> display_refresh_hz{0.0};
+        std::atomic<bool> vsync_locked{false};
         
         // 添加重置方法
         void reset() 
@@ -95,12 +148,35 @@ public:
             video_frames.store(0);
             audio_bytes.store(0);
             video_bytes.store(0);
+            seek_count.store(0);
+            seek_latency_last_us.store(0);
+            seek_latency_max_us.store(0);
+            seek_latency_total_us.store(0);
+            seek_dropped_frames.store(0);
+            audio_underruns.store(0);
+            audio_underrun_bytes.store(0);
+            audio_queued_frames.store(0);
+            open_start_us.store(0);
+            probe_us.store(0);
+            probe_limited.store(false);
+            first_frame_us.store(0);
+            first_audio_us.store(0);
         }
     } stats;
 
+    // 流水线各阶段耗时直方图和计数器
+    PipelineMetrics metrics;
+
+    // 线程绑核/优先级和解码线程数（实际生效的布局在统计浮层中显示）
+    ThreadingPolicy threading;
+
     // 时钟管理
     Clock audio_clock;
     Clock video_clock;
+    Clock external_clock;
+
+    // 主时钟选择、速度/暂停和漂移校正（声明在三个时钟之后）
+    SyncEngine sync{audio_clock, video_clock, external_clock};
 
     // 时间同步
     std::mutex clock_mutex;
@@ -122,6 +198,17 @@ public:
     // 精准 seek 相关
     std::atomic<bool> seeking{false};        // 是否正在 seeking
     std::atomic<int64_t> seek_target_pts{AV_NOPTS_VALUE}; // 目标 PTS
+    std::atomic<SeekMode> seek_mode{SeekMode::KEYFRAME};
+    std::atomic<int64_t> seek_request_time{0};     // 最近一次 seek 请求时刻（av_gettime_relative），0 表示无
+    std::atomic<double> seek_display_pts{NAN};     // seek 后解码线程送出的第一帧 pts，显示时结算延迟
+    std::atomic<uint64_t> audio_flush_serial{0};   // 音频解码线程每处理一个 flush 包加一，音频输出据此丢弃旧数据
+
+    // 播放时间轴：解码线程送出的帧 pts 统一为微秒，等于条目内时间 + timeline_offset。
+    // 播放列表无缝切换时新条目接在上一条目末尾，时钟和呈现调度看到的是连续的时间轴；seek 后回到条目内时间
+    std::atomic<int64_t> timeline_offset{0};
+    std::atomic<int64_t> previous_timeline_offset{0};      // 切换后上一条目的尾部仍在播放，UI 据此换算
+    std::atomic<int64_t> audio_timeline_end{AV_NOPTS_VALUE};   // 最近送出的音频帧末尾（时间轴，微秒）
+    std::atomic<int64_t> video_timeline_end{AV_NOPTS_VALUE};
 
     // 调试限制
     long maxFramesToDecode = 0;
@@ -133,7 +220,8 @@ public:
     void clear();
     void clearForReload(bool set_quit_flag = false); // 支持重新加载的清理
     void resetForNewFile(); // 为新文件重置状态
-    void set_error(PlayerError err, const std::string& msg = "");
+    // stop 为 false 时只记录错误、不设置 quit（打开文件失败时由主线程处理，不退出播放器）
+    void set_error(PlayerError err, const std::string& msg = "", bool stop = true);
     
     bool wait_for_threads(int timeout_ms = 5000);
     void thread_started();
@@ -143,14 +231,31 @@ public:
     void update_video_clock(double pts);
     double get_master_clock();
 
+    // 根据流的时间基设置队列的字节/时长计量（找到流之后、开始入队之前调用）
+    void configureQueueLimits();
+    // 接管已打开的输入（格式上下文、I/O、选中的流）并配置队列计量；在主线程、解封装/解码线程开始读写之前调用
+    void adoptInput(MediaInput& input);
+
+    // 视频帧显示时间（秒，播放时间轴），无时间戳时返回 NAN
+    double get_video_frame_pts(const AVFrame* frame) const;
+    // 时间轴上的时刻换算为所在条目内的位置（秒），供 UI 显示进度和 seek 使用
+    double itemPosition(double timeline_seconds) const;
+    // 当前条目的总时长（秒），未知时返回 NAN
+    double mediaDuration() const;
+
     // Seek 方法
     void doSeekRelative(double seconds);
     void doSeekAbsolute(double seconds);
+    // 显示一帧视频时调用，若是 seek 后的第一帧则记录 seek 到显示的延迟
+    void record_seek_display(double pts);
+    // 打开文件后第一帧上屏（主线程）/ 第一次输出音频数据（音频回调）时调用，记录距开始打开的延迟
+    void record_first_video_frame();
+    void record_first_audio();
     bool isSeekRequested() const { return seek_request.load(); }
     
     // 队列状态检查
-    bool audio_queue_full() const { return audio_packet_queue.size() >= MAX_AUDIO_PACKETS; }
-    bool video_queue_full() const { return video_packet_queue.size() >= MAX_VIDEO_PACKETS; }
-    bool audio_frame_queue_full() const { return audio_frame_queue.size() >= MAX_AUDIO_FRAMES; }
-    bool video_frame_queue_full() const { return video_frame_queue.size() >= MAX_VIDEO_FRAMES; }
+    bool audio_queue_full() const { return audio_packet_queue.full(); }
+    bool video_queue_full() const { return video_packet_queue.full(); }
+    bool audio_frame_queue_full() const { return audio_frame_queue.full(); }
+    bool video_frame_queue_full() const { return video_frame_queue.full(); }
 };
\ No newline at end of file
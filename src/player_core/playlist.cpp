@@ -0,0 +1,123 @@
+#include "playlist.hpp"
+#include <fstream>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+const std::string EMPTY_ITEM;
+
+bool isUrl(const std::string& path)
+{
+    return path.find("://") != std::string::npos;
+}
+
+bool isAbsoluteOrUrl(const std::string& path)
+{
+    if (path.empty()) return false;
+    if (path[0] == '/' || path[0] == '\\') return true;
+    if (path.size() > 1 && path[1] == ':') return true;      // Windows 盘符
+    return isUrl(path);
+}
+
+} // namespace
+
+Playlist Playlist::fromArguments(int argc, char* argv[])
+{
+    Playlist playlist;
+    std::vector<std::string> items;
+
+    if (const char* loop = std::getenv("SDL2_PLAYER_LOOP")) {
+        playlist.loop_ = std::strcmp(loop, "1") == 0;
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--loop") {
+            playlist.loop_ = true;
+        } else if (isListFile(arg)) {
+            if (!loadList(arg, items)) {
+                std::cerr << "Playlist: Cannot read " << arg << std::endl;
+            }
+        } else {
+            items.push_back(arg);
+        }
+    }
+
+    playlist.items_ = std::move(items);
+    if (playlist.items_.size() > 1 || playlist.loop_) {
+        std::cout << "Playlist: " << playlist.items_.size() << " item(s)"
+                  << (playlist.loop_ ? ", looping" : "") << std::endl;
+    }
+    return playlist;
+}
+
+void Playlist::assign(std::vector<std::string> items)
+{
+    items_ = std::move(items);
+    current_ = 0;
+}
+
+const std::string& Playlist::current() const
+{
+    return item(current_);
+}
+
+const std::string& Playlist::item(int index) const
+{
+    if (index < 0 || index >= size()) return EMPTY_ITEM;
+    return items_[index];
+}
+
+int Playlist::indexAfter(int index) const
+{
+    if (items_.empty()) return -1;
+    if (index + 1 < size()) return index + 1;
+    return loop_ ? 0 : -1;
+}
+
+void Playlist::setCurrent(int index)
+{
+    if (index >= 0 && index < size()) {
+        current_ = index;
+    }
+}
+
+bool Playlist::isListFile(const std::string& path)
+{
+    // 网络地址（如 HLS 的 https://.../live.m3u8）交给 FFmpeg 打开，不当作本地列表读取
+    if (isUrl(path)) return false;
+
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return false;
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == "m3u" || ext == "m3u8";
+}
+
+bool Playlist::loadList(const std::string& path, std::vector<std::string>& items)
+{
+    std::ifstream file(path);
+    if (!file) return false;
+
+    size_t slash = path.find_last_of("/\\");
+    std::string base = slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        // 去掉 BOM、首尾空白和 Windows 换行；# 开头的是注释或扩展信息
+        if (line.compare(0, 3, "\xEF\xBB\xBF") == 0) line.erase(0, 3);
+        size_t begin = line.find_first_not_of(" \t\r");
+        size_t end = line.find_last_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#') continue;
+        line = line.substr(begin, end - begin + 1);
+
+        items.push_back(isAbsoluteOrUrl(line) ? line : base + line);
+    }
+    return true;
+}
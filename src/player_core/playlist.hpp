@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * 播放列表：按顺序播放的文件，可循环。
+ *
+ * 命令行可以给出多个文件或 .m3u/.m3u8 列表（相对路径相对列表所在目录），--loop 或
+ * SDL2_PLAYER_LOOP=1 开启循环；只有一个文件时循环即单曲循环。只在主线程访问。
+ */
+class Playlist
+{
+public:
+    static Playlist fromArguments(int argc, char* argv[]);
+
+    // 替换全部条目，从第一项开始
+    void assign(std::vector<std::string> items);
+    void setLoop(bool loop) { loop_ = loop; }
+    bool loop() const { return loop_; }
+
+    bool empty() const { return items_.empty(); }
+    int size() const { return static_cast<int>(items_.size()); }
+    int currentIndex() const { return current_; }
+    const std::string& current() const;
+    const std::string& item(int index) const;
+
+    // 第 index 项之后的索引；列表已到末尾且不循环时返回 -1
+    int indexAfter(int index) const;
+    int nextIndex() const { return indexAfter(current_); }
+    void setCurrent(int index);
+
+private:
+    static bool isListFile(const std::string& path);
+    static bool loadList(const std::string& path, std::vector<std::string>& items);
+
+    std::vector<std::string> items_;
+    int current_ = 0;
+    bool loop_ = false;
+};
@@ -0,0 +1,40 @@
+#include "cpu_features.hpp"
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/cpu.h>
+}
+
+SimdLevel detectSimdLevel()
+{
+    static const SimdLevel level = []() {
+        SimdLevel detected = SimdLevel::SCALAR;
+#if PLAYER_SIMD_X86
+        int flags = av_get_cpu_flags();
+        if (flags & AV_CPU_FLAG_AVX2) {
+            detected = SimdLevel::AVX2;
+        } else if (flags & AV_CPU_FLAG_SSE4) {
+            detected = SimdLevel::SSE41;
+        }
+#endif
+        // 只允许降级，不能强制使用 CPU 不支持的指令集
+        if (const char* forced = std::getenv("SDL2_PLAYER_SIMD")) {
+            SimdLevel cap = detected;
+            if (std::strcmp(forced, "scalar") == 0) cap = SimdLevel::SCALAR;
+            else if (std::strcmp(forced, "sse4") == 0) cap = SimdLevel::SSE41;
+            if (cap < detected) detected = cap;
+        }
+        return detected;
+    }();
+    return level;
+}
+
+const char* simdLevelName(SimdLevel level)
+{
+    switch (level) {
+        case SimdLevel::AVX2:  return "avx2";
+        case SimdLevel::SSE41: return "sse4.1";
+        default:               return "scalar";
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+/**
+ * 运行时 SIMD 能力检测，供手写内核选择实现。
+ *
+ * 检测结果来自 av_get_cpu_flags()，因此 FFmpeg 的 -cpuflags / av_force_cpu_flags 同样生效。
+ * 环境变量 SDL2_PLAYER_SIMD=scalar|sse4|avx2 可把级别压低，用于排查或对比。
+ */
+enum class SimdLevel
+{
+    SCALAR,
+    SSE41,
+    AVX2
+};
+
+SimdLevel detectSimdLevel();
+const char* simdLevelName(SimdLevel level);
+
+// 编译目标是否为 x86（非 x86 平台只有标量实现）
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define PLAYER_SIMD_X86 1
+#else
+#define PLAYER_SIMD_X86 0
+#endif
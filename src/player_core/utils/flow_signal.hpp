@@ -0,0 +1,48 @@
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * 队列间的流控信号（“有空间” / “有数据”）。
+ *
+ * 用代数计数避免丢失唤醒：等待方先取 generation()，再检查自己的条件，
+ * 条件不满足时调用 wait(seen)。只要在取代数之后发生过 notify()，wait 就会立即返回。
+ */
+class FlowSignal
+{
+public:
+    // 当前代数（任意线程）
+    uint64_t generation() const
+    {
+        return generation_.load(std::memory_order_acquire);
+    }
+
+    // 唤醒所有等待者（任意线程）
+    void notify()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            generation_.store(generation_.load(std::memory_order_relaxed) + 1,
+                              std::memory_order_release);
+        }
+        cond_.notify_all();
+    }
+
+    // 等待代数变化，超时返回 false
+    bool wait(uint64_t seen_generation, int timeout_ms)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cond_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this, seen_generation]() {
+            return generation_.load(std::memory_order_acquire) != seen_generation;
+        });
+    }
+
+private:
+    std::atomic<uint64_t> generation_{0};
+    std::mutex mutex_;
+    std::condition_variable cond_;
+};
@@ -0,0 +1,93 @@
+#include "frame_pool.hpp"
+#include <iostream>
+
+FramePool::FramePool(size_t capacity, const std::string& name)
+    : capacity_(capacity), name_(name)
+{
+    free_list_.reserve(capacity_);
+}
+
+FramePool::~FramePool()
+{
+    int64_t leaked = outstanding_.load();
+    if (leaked > 0) {
+        std::cerr << "FramePool(" << name_ << "): " << leaked
+                  << " frames still outstanding at destruction" << std::endl;
+    }
+    trim();
+}
+
+AVFrame* FramePool::acquire()
+{
+    AVFrame* frame = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_list_.empty()) {
+            frame = free_list_.back();
+            free_list_.pop_back();
+        }
+    }
+
+    if (frame) {
+        hits_++;
+    } else {
+        frame = av_frame_alloc();
+        if (!frame) return nullptr;
+        misses_++;
+    }
+
+    // 更新借出计数和高水位
+    int64_t now = ++outstanding_;
+    int64_t peak = high_water_.load();
+    while (now > peak && !high_water_.compare_exchange_weak(peak, now)) {
+    }
+
+    return frame;
+}
+
+void FramePool::release(AVFrame*& frame)
+{
+    if (!frame) return;
+
+    // 释放数据引用，AVFrame 结构本身保留
+    av_frame_unref(frame);
+    outstanding_--;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_list_.size() < capacity_) {
+            free_list_.push_back(frame);
+            frame = nullptr;
+            return;
+        }
+    }
+
+    // 空闲列表已满，直接释放
+    av_frame_free(&frame);
+}
+
+void FramePool::trim()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (AVFrame*& frame : free_list_) {
+        av_frame_free(&frame);
+    }
+    free_list_.clear();
+}
+
+FramePool::PoolStats FramePool::getStats() const
+{
+    size_t idle = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle = free_list_.size();
+    }
+    return {hits_.load(), misses_.load(), high_water_.load(), outstanding_.load(), idle};
+}
+
+void FramePool::resetStats()
+{
+    hits_.store(0);
+    misses_.store(0);
+    high_water_.store(outstanding_.load());
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include "../../ffmpeg_utils/ffmpeg_headers.hpp"
+
+/**
+ * AVFrame 复用池。
+ *
+ * 解码线程通过 acquire() 取得空帧，把解码结果 av_frame_move_ref 进去后入队；
+ * 消费者用完后调用 release() 归还，帧数据引用被释放回解码器内部的缓冲池，
+ * AVFrame 结构本身留在空闲列表里等待下一次复用，稳态下不再发生堆分配。
+ */
+class FramePool
+{
+public:
+    struct PoolStats
+    {
+        int64_t hits;        // 从空闲列表复用的次数
+        int64_t misses;      // 空闲列表为空、新分配的次数
+        int64_t high_water;  // 同时借出帧数的历史最大值
+        int64_t outstanding; // 当前借出未归还的帧数
+        size_t  idle;        // 空闲列表中的帧数
+    };
+
+    FramePool(size_t capacity, const std::string& name);
+    ~FramePool();
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // 取出一个空帧（任意线程），失败返回 nullptr
+    AVFrame* acquire();
+
+    // 归还帧（任意线程），调用后 frame 被置空；超过容量的帧直接释放
+    void release(AVFrame*& frame);
+
+    // 释放空闲列表中的所有帧（用于重新加载文件）
+    void trim();
+
+    PoolStats getStats() const;
+    void resetStats();
+
+    const std::string& name() const { return name_; }
+
+private:
+    size_t capacity_;
+    std::string name_;
+
+    std::vector<AVFrame*> free_list_;
+    mutable std::mutex mutex_;
+
+    std::atomic<int64_t> hits_{0};
+    std::atomic<int64_t> misses_{0};
+    std::atomic<int64_t> outstanding_{0};
+    std::atomic<int64_t> high_water_{0};
+};
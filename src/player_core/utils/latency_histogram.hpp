@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * 无锁延迟直方图（HDR 风格的对数-线性分桶，单位微秒）。
+ *
+ * 0~63us 每微秒一个桶；之后每个 2 的幂区间再均分 32 个子桶，相对误差约 3%。
+ * record 只做几次 relaxed 原子加，可在任意线程的热路径上调用；
+ * snapshot 在任意线程读取，结果是近似一致的快照，足够用于统计展示。
+ */
+class LatencyHistogram
+{
+public:
+    struct Snapshot
+    {
+        int64_t count;
+        double mean_us;
+        int64_t p50_us;
+        int64_t p90_us;
+        int64_t p99_us;
+        int64_t p999_us;
+        int64_t max_us;
+    };
+
+    LatencyHistogram() { reset(); }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(int64_t value_us)
+    {
+        if (value_us < 0) value_us = 0;
+        if (value_us > MAX_VALUE) value_us = MAX_VALUE;
+
+        counts_[bucketOf(static_cast<uint64_t>(value_us))].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value_us, std::memory_order_relaxed);
+
+        int64_t max = max_.load(std::memory_order_relaxed);
+        while (value_us > max && !max_.compare_exchange_weak(max, value_us, std::memory_order_relaxed)) {
+        }
+    }
+
+    void reset()
+    {
+        for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    int64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    // 第 q 分位（0~1）所在桶的上界
+    int64_t percentile(double q) const
+    {
+        int64_t total = 0;
+        for (const auto& c : counts_) total += c.load(std::memory_order_relaxed);
+        if (total == 0) return 0;
+
+        int64_t rank = static_cast<int64_t>(q * total + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > total) rank = total;
+
+        int64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            seen += counts_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                int64_t upper = upperBoundOf(i);
+                int64_t max = max_.load(std::memory_order_relaxed);
+                return upper < max ? upper : max;
+            }
+        }
+        return max_.load(std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const
+    {
+        Snapshot s{};
+        s.count = count();
+        s.mean_us = s.count > 0 ? sum_.load(std::memory_order_relaxed) / static_cast<double>(s.count) : 0.0;
+        s.p50_us = percentile(0.50);
+        s.p90_us = percentile(0.90);
+        s.p99_us = percentile(0.99);
+        s.p999_us = percentile(0.999);
+        s.max_us = max_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    static constexpr int SUB_BITS = 5;
+    static constexpr int SUB_COUNT = 1 << SUB_BITS;                  // 每个 2 的幂区间的子桶数
+    static constexpr int MAX_SHIFT = 32;
+    static constexpr int BUCKET_COUNT = 2 * SUB_COUNT + MAX_SHIFT * SUB_COUNT;
+    static constexpr int64_t MAX_VALUE = (int64_t(1) << (MAX_SHIFT + SUB_BITS + 1)) - 1; // 约 76 小时
+
+    static int bucketOf(uint64_t v)
+    {
+        if (v < static_cast<uint64_t>(2 * SUB_COUNT)) return static_cast<int>(v);
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - SUB_BITS;                                   // >= 1
+        int sub = static_cast<int>(v >> shift) - SUB_COUNT;           // 0 ~ SUB_COUNT-1
+        return 2 * SUB_COUNT + (shift - 1) * SUB_COUNT + sub;
+    }
+
+    static int64_t upperBoundOf(int bucket)
+    {
+        if (bucket < 2 * SUB_COUNT) return bucket;
+        int shift = (bucket - 2 * SUB_COUNT) / SUB_COUNT + 1;
+        int64_t sub = (bucket - 2 * SUB_COUNT) % SUB_COUNT + SUB_COUNT;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::atomic<int64_t> counts_[BUCKET_COUNT];
+    std::atomic<int64_t> count_;
+    std::atomic<int64_t> sum_;
+    std::atomic<int64_t> max_;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include "player_constants.hpp"
+#include "../../ffmpeg_utils/ffmpeg_headers.hpp"
+
+/**
+ * 独占所有权的数据包句柄（只能移动，不能复制）。
+ *
+ * AVPacket 结构直接内嵌在句柄里，不需要 av_packet_alloc 分配外壳；
+ * 移动时用 av_packet_move_ref 转移引用计数的数据，析构时自动 av_packet_unref。
+ * 解封装线程把 av_read_frame 的结果直接读进句柄，再移动进队列，全程不复制数据。
+ */
+class PacketHandle
+{
+public:
+    PacketHandle()
+    {
+        init();
+    }
+
+    ~PacketHandle()
+    {
+        av_packet_unref(&pkt_);
+    }
+
+    PacketHandle(PacketHandle&& other) noexcept
+    {
+        init();
+        av_packet_move_ref(&pkt_, &other.pkt_);
+    }
+
+    PacketHandle& operator=(PacketHandle&& other) noexcept
+    {
+        if (this != &other)
+        {
+            av_packet_unref(&pkt_);
+            av_packet_move_ref(&pkt_, &other.pkt_);
+        }
+        return *this;
+    }
+
+    PacketHandle(const PacketHandle&) = delete;
+    PacketHandle& operator=(const PacketHandle&) = delete;
+
+    // 创建 flush 包（seek 后通知解码线程刷新），pos 携带 seek 目标位置
+    static PacketHandle makeFlush(int64_t seek_pos, bool accurate = false)
+    {
+        PacketHandle handle;
+        handle.pkt_.stream_index = FF_FLUSH_PACKET_STREAM_INDEX;
+        handle.pkt_.pos = seek_pos;
+        handle.pkt_.flags = accurate ? FF_FLUSH_FLAG_ACCURATE : 0;
+        return handle;
+    }
+
+    // 创建 EOF 包（空数据）
+    static PacketHandle makeEof(int stream_index)
+    {
+        PacketHandle handle;
+        handle.pkt_.stream_index = stream_index;
+        return handle;
+    }
+
+    bool isFlush() const { return pkt_.stream_index == FF_FLUSH_PACKET_STREAM_INDEX; }
+    bool isAccurateFlush() const { return isFlush() && (pkt_.flags & FF_FLUSH_FLAG_ACCURATE); }
+    bool isEof() const { return pkt_.data == nullptr && pkt_.size == 0; }
+
+    // 释放数据引用，句柄恢复为空包
+    void reset()
+    {
+        av_packet_unref(&pkt_);
+    }
+
+    AVPacket* get() { return &pkt_; }
+    const AVPacket* get() const { return &pkt_; }
+
+    AVPacket* operator->() { return &pkt_; }
+    const AVPacket* operator->() const { return &pkt_; }
+
+private:
+    void init()
+    {
+        av_init_packet(&pkt_);
+        pkt_.data = nullptr;
+        pkt_.size = 0;
+    }
+
+    AVPacket pkt_;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+// 与 SpscQueue 相同的缓存行隔离
+constexpr size_t PCM_RING_CACHE_LINE_SIZE = 64;
+
+/**
+ * 单生产者/单消费者 PCM 字节环形缓冲区，读写都是无锁、无等待的。
+ *
+ * - write 只能由唯一的生产者线程（音频供给线程）调用，空间不足时只写入能放下的部分；
+ * - read/discardAll/discardUntil 只能由唯一的消费者线程（音频回调）调用，数据不足时只读出已有的部分；
+ * - 读写位置是单调递增的 64 位总字节数，readTotal/writeTotal 可用于把播放位置换算回时间戳；
+ * - allocate/reset 只能在两端都停止时调用。
+ */
+class PcmRingBuffer
+{
+public:
+    // 容量按 2 的幂向上取整
+    void allocate(size_t min_bytes)
+    {
+        size_t capacity = 1;
+        while (capacity < min_bytes) capacity <<= 1;
+        data_ = std::make_unique<uint8_t[]>(capacity);
+        mask_ = capacity - 1;
+        reset();
+    }
+
+    void reset()
+    {
+        write_.store(0, std::memory_order_relaxed);
+        read_.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return data_ ? mask_ + 1 : 0; }
+
+    size_t readable() const
+    {
+        return static_cast<size_t>(write_.load(std::memory_order_acquire) - read_.load(std::memory_order_acquire));
+    }
+
+    size_t writable() const { return capacity() - readable(); }
+
+    uint64_t readTotal() const { return read_.load(std::memory_order_acquire); }
+    uint64_t writeTotal() const { return write_.load(std::memory_order_acquire); }
+
+    // 生产者：返回实际写入的字节数
+    size_t write(const uint8_t* src, size_t bytes)
+    {
+        if (!data_) return 0;
+        uint64_t write = write_.load(std::memory_order_relaxed);
+        uint64_t read = read_.load(std::memory_order_acquire);
+        size_t n = std::min(bytes, capacity() - static_cast<size_t>(write - read));
+        size_t offset = static_cast<size_t>(write & mask_);
+        size_t first = std::min(n, capacity() - offset);   // 环绕时分两段拷贝
+        memcpy(data_.get() + offset, src, first);
+        memcpy(data_.get(), src + first, n - first);
+        write_.store(write + n, std::memory_order_release);
+        return n;
+    }
+
+    // 消费者：返回实际读出的字节数
+    size_t read(uint8_t* dst, size_t bytes)
+    {
+        if (!data_) return 0;
+        uint64_t read = read_.load(std::memory_order_relaxed);
+        uint64_t write = write_.load(std::memory_order_acquire);
+        size_t n = std::min(bytes, static_cast<size_t>(write - read));
+        size_t offset = static_cast<size_t>(read & mask_);
+        size_t first = std::min(n, capacity() - offset);
+        memcpy(dst, data_.get() + offset, first);
+        memcpy(dst + first, data_.get(), n - first);
+        read_.store(read + n, std::memory_order_release);
+        return n;
+    }
+
+    // 消费者：丢弃当前可读的全部数据（seek 后旧数据作废）
+    void discardAll()
+    {
+        read_.store(write_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    // 消费者：丢弃写入总量 end 之前的数据，之后写入的保留（end 由生产者按 writeTotal 记录）
+    void discardUntil(uint64_t end)
+    {
+        uint64_t read = read_.load(std::memory_order_relaxed);
+        uint64_t write = write_.load(std::memory_order_acquire);
+        end = std::min(end, write);
+        if (end > read) read_.store(end, std::memory_order_release);
+    }
+
+private:
+    std::unique_ptr<uint8_t[]> data_;
+    size_t mask_ = 0;
+    alignas(PCM_RING_CACHE_LINE_SIZE) std::atomic<uint64_t> write_{0};   // 生产者独占
+    alignas(PCM_RING_CACHE_LINE_SIZE) std::atomic<uint64_t> read_{0};    // 消费者独占
+};
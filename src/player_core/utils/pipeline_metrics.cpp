@@ -0,0 +1,156 @@
+#include "pipeline_metrics.hpp"
+#include "player_constants.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+struct StageInfo
+{
+    const char* name;
+    int64_t budget_us;
+};
+
+// 预算按 60fps 一帧（约 16.7ms）拆分；等待类阶段反映上下游快慢，不设预算
+const StageInfo STAGE_INFO[PipelineMetrics::STAGE_COUNT] = {
+    {"demux_read",        5000},
+    {"packet_queue_wait", 0},
+    {"audio_decode",      5000},
+    {"video_decode",      16000},
+    {"frame_clone",       500},
+    {"frame_queue_wait",  0},
+    {"sws_convert",       8000},
+    {"texture_upload",    8000},
+    {"present",           16000},
+};
+
+const char* COUNTER_NAMES[PipelineMetrics::COUNTER_COUNT] = {
+    "packets_read",
+    "bytes_read",
+    "audio_frames_decoded",
+    "video_frames_decoded",
+    "frames_dropped_queue",
+    "frames_presented",
+    "frames_dropped_late",
+    "frames_repeated",
+    "vsync_missed",
+};
+
+std::atomic<int> g_next_slot{0};
+
+} // namespace
+
+const char* PipelineMetrics::stageName(MetricStage stage)
+{
+    return STAGE_INFO[static_cast<int>(stage)].name;
+}
+
+int64_t PipelineMetrics::stageBudget(MetricStage stage)
+{
+    return STAGE_INFO[static_cast<int>(stage)].budget_us;
+}
+
+const char* PipelineMetrics::counterName(MetricCounter counter)
+{
+    return COUNTER_NAMES[static_cast<int>(counter)];
+}
+
+int PipelineMetrics::threadSlot()
+{
+    thread_local int slot = g_next_slot.fetch_add(1, std::memory_order_relaxed) % MAX_THREAD_SLOTS;
+    return slot;
+}
+
+int64_t PipelineMetrics::counter(MetricCounter counter) const
+{
+    int64_t total = 0;
+    for (const CounterSlot& slot : slots_) {
+        total += slot.values[static_cast<int>(counter)].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void PipelineMetrics::reset()
+{
+    for (CounterSlot& slot : slots_) {
+        for (auto& value : slot.values) value.store(0, std::memory_order_relaxed);
+    }
+    for (Stage& stage : stages_) {
+        stage.histogram.reset();
+        stage.over_budget.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::string PipelineMetrics::toJson() const
+{
+    std::ostringstream out;
+    out << "{\n  \"stages\": {\n";
+    for (int i = 0; i < STAGE_COUNT; i++)
+    {
+        MetricStage stage = static_cast<MetricStage>(i);
+        LatencyHistogram::Snapshot s = histogram(stage).snapshot();
+        out << "    \"" << stageName(stage) << "\": {\"count\": " << s.count
+            << ", \"mean_us\": " << s.mean_us
+            << ", \"p50_us\": " << s.p50_us
+            << ", \"p90_us\": " << s.p90_us
+            << ", \"p99_us\": " << s.p99_us
+            << ", \"p999_us\": " << s.p999_us
+            << ", \"max_us\": " << s.max_us
+            << ", \"budget_us\": " << stageBudget(stage)
+            << ", \"over_budget\": " << overBudget(stage) << "}"
+            << (i + 1 < STAGE_COUNT ? ",\n" : "\n");
+    }
+    out << "  },\n  \"counters\": {\n";
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        MetricCounter c = static_cast<MetricCounter>(i);
+        out << "    \"" << counterName(c) << "\": " << counter(c)
+            << (i + 1 < COUNTER_COUNT ? ",\n" : "\n");
+    }
+    out << "  }\n}\n";
+    return out.str();
+}
+
+MetricsDumper::MetricsDumper(const PipelineMetrics& metrics)
+    : metrics_(metrics), interval_us_(METRICS_DUMP_INTERVAL_MS * 1000LL)
+{
+    if (const char* path = std::getenv("SDL2_PLAYER_METRICS_FILE")) {
+        path_ = path;
+    }
+    if (const char* interval = std::getenv("SDL2_PLAYER_METRICS_INTERVAL_MS")) {
+        long ms = std::atol(interval);
+        if (ms >= 100) interval_us_ = ms * 1000LL;
+    }
+}
+
+void MetricsDumper::tick()
+{
+    if (path_.empty()) return;
+
+    int64_t now = av_gettime_relative();
+    if (now < next_dump_us_) return;
+    next_dump_us_ = now + interval_us_;
+
+    dump();
+}
+
+bool MetricsDumper::dump() const
+{
+    if (path_.empty()) return false;
+
+    // 先写临时文件再改名，外部读取方不会读到写了一半的 JSON
+    std::string tmp_path = path_ + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::trunc);
+        if (!file) {
+            std::cerr << "MetricsDumper: Cannot write " << tmp_path << std::endl;
+            return false;
+        }
+        file << metrics_.toJson();
+    }
+    std::remove(path_.c_str());
+    return std::rename(tmp_path.c_str(), path_.c_str()) == 0;
+}
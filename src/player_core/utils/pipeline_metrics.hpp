@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include "latency_histogram.hpp"
+
+extern "C" {
+#include <libavutil/time.h>
+}
+
+/**
+ * 流水线各阶段（耗时直方图）。
+ */
+enum class MetricStage
+{
+    DEMUX_READ,         // av_read_frame
+    PACKET_QUEUE_WAIT,  // 解码线程等待数据包（上游供给不足）
+    AUDIO_DECODE,       // 每个音频包的 send + receive
+    VIDEO_DECODE,       // 每个视频包的 send + receive
+    FRAME_CLONE,        // 从帧池取帧并转移解码结果
+    FRAME_QUEUE_WAIT,   // 解码线程等待帧队列空位（下游背压）
+    SWS_CONVERT,        // 像素格式转换
+    TEXTURE_UPLOAD,     // 视频帧上传到纹理
+    PRESENT,            // 交换缓冲区
+    COUNT
+};
+
+/**
+ * 流水线计数器。
+ */
+enum class MetricCounter
+{
+    PACKETS_READ,
+    BYTES_READ,
+    AUDIO_FRAMES_DECODED,
+    VIDEO_FRAMES_DECODED,
+    FRAMES_DROPPED_QUEUE,   // 帧队列满被丢弃
+    FRAMES_PRESENTED,
+    FRAMES_DROPPED_LATE,    // 显示时已落后主时钟被丢弃
+    FRAMES_REPEATED,        // vsync 时没有新帧到期，重复显示上一帧
+    VSYNC_MISSED,           // 两次交换之间超过 1.5 个刷新周期
+    COUNT
+};
+
+/**
+ * 全流水线的低开销统计。
+ *
+ * 阶段耗时写入无锁直方图，并统计超出预算的次数；计数器按线程分槽位累加，
+ * 各线程写自己的缓存行，读取时再求和，热路径上没有锁也没有共享缓存行争用。
+ */
+class PipelineMetrics
+{
+public:
+    static constexpr int STAGE_COUNT = static_cast<int>(MetricStage::COUNT);
+    static constexpr int COUNTER_COUNT = static_cast<int>(MetricCounter::COUNT);
+
+    static const char* stageName(MetricStage stage);
+    static const char* counterName(MetricCounter counter);
+    // 阶段预算（微秒），0 表示不设预算（等待类阶段）
+    static int64_t stageBudget(MetricStage stage);
+
+    void record(MetricStage stage, int64_t us)
+    {
+        Stage& s = stages_[static_cast<int>(stage)];
+        s.histogram.record(us);
+        int64_t budget = stageBudget(stage);
+        if (budget > 0 && us > budget) {
+            s.over_budget.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void add(MetricCounter counter, int64_t n = 1)
+    {
+        slots_[threadSlot()].values[static_cast<int>(counter)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    int64_t counter(MetricCounter counter) const;
+    const LatencyHistogram& histogram(MetricStage stage) const { return stages_[static_cast<int>(stage)].histogram; }
+    int64_t overBudget(MetricStage stage) const { return stages_[static_cast<int>(stage)].over_budget.load(std::memory_order_relaxed); }
+
+    void reset();
+    std::string toJson() const;
+
+private:
+    static constexpr int MAX_THREAD_SLOTS = 16;
+
+    struct alignas(64) CounterSlot
+    {
+        std::atomic<int64_t> values[COUNTER_COUNT] = {};
+    };
+
+    struct Stage
+    {
+        LatencyHistogram histogram;
+        std::atomic<int64_t> over_budget{0};
+    };
+
+    // 每个线程首次写入时分配一个槽位；线程数超过槽位数时共享（仍是原子操作，只是可能争用）
+    static int threadSlot();
+
+    CounterSlot slots_[MAX_THREAD_SLOTS];
+    Stage stages_[STAGE_COUNT];
+};
+
+/**
+ * 作用域计时，析构时记录到对应阶段。
+ */
+class ScopedStageTimer
+{
+public:
+    ScopedStageTimer(PipelineMetrics& metrics, MetricStage stage)
+        : metrics_(metrics), stage_(stage), start_(av_gettime_relative())
+    {
+    }
+
+    ~ScopedStageTimer()
+    {
+        metrics_.record(stage_, av_gettime_relative() - start_);
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    PipelineMetrics& metrics_;
+    MetricStage stage_;
+    int64_t start_;
+};
+
+/**
+ * 定期把统计写成 JSON 文件，由主循环调用 tick()。
+ *
+ * 环境变量 SDL2_PLAYER_METRICS_FILE 指定输出路径（未设置时不输出），
+ * SDL2_PLAYER_METRICS_INTERVAL_MS 指定间隔（默认 METRICS_DUMP_INTERVAL_MS）。
+ */
+class MetricsDumper
+{
+public:
+    explicit MetricsDumper(const PipelineMetrics& metrics);
+
+    bool enabled() const { return !path_.empty(); }
+    void tick();
+    bool dump() const;
+
+private:
+    const PipelineMetrics& metrics_;
+    std::string path_;
+    int64_t interval_us_;
+    int64_t next_dump_us_ = 0;
+};
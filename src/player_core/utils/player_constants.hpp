@@ -20,6 +20,68 @@ constexpr int MAX_VIDEO_PACKETS = 500;    // 增加容量
 constexpr int MAX_AUDIO_FRAMES = 100;     // 增加容量
 constexpr int MAX_VIDEO_FRAMES = 50;      // 增加容量
 
+// 队列字节/时长上限（任一达到即视为已满，上面的个数上限只作为槽位数）
+constexpr int64_t MAX_AUDIO_PACKET_BYTES = 4 * 1024 * 1024;
+constexpr int64_t MAX_VIDEO_PACKET_BYTES = 64 * 1024 * 1024;
+constexpr double MAX_PACKET_QUEUE_SECONDS = 10.0;
+constexpr int64_t MAX_AUDIO_FRAME_BYTES = 8 * 1024 * 1024;
+constexpr int64_t MAX_VIDEO_FRAME_BYTES = 256 * 1024 * 1024;   // 4K 10bit 约 20 帧
+constexpr double MAX_AUDIO_FRAME_SECONDS = 1.0;
+constexpr double MAX_VIDEO_FRAME_SECONDS = 1.0;
+
+// 包队列满后，降到容量的该比例以下才恢复读取（滞回，避免在满载边缘反复唤醒）
+constexpr double PACKET_QUEUE_RESUME_RATIO = 0.5;
+
+// 流控信号等待的超时兜底
+constexpr int FLOW_WAIT_TIMEOUT_MS = 100;
+
+// 帧池在队列容量之外额外保留的帧数（解码线程和消费者手上各持有的帧）
+constexpr int FRAME_POOL_EXTRA_FRAMES = 4;
+
+// 解封装 I/O（自定义 AVIOContext）
+constexpr int IO_AVIO_BUFFER_SIZE = 64 * 1024;               // 交给 FFmpeg 的 AVIO 缓冲区
+constexpr size_t IO_READAHEAD_BLOCK_SIZE = 1024 * 1024;      // 预读块大小
+constexpr int IO_READAHEAD_BLOCK_COUNT = 8;                  // 预读块数量
+
+// 关键帧索引
+constexpr int64_t KEYFRAME_INDEX_HASH_BYTES = 64 * 1024;     // 计算缓存键时读取的首/尾字节数
+constexpr int KEYFRAME_INDEX_PROGRESS_PACKETS = 256;         // 每扫描多少个包更新一次进度
+
+// 视频纹理上传
+constexpr int PBO_RING_SIZE = 3;                             // PBO 环深度，GPU 仍在读取的缓冲区不会被立即覆盖
+constexpr int SWS_CACHE_CAPACITY = 4;                        // 缓存的格式转换上下文数（分辨率/格式切换时复用）
+
+// 解码线程
+constexpr int DECODER_MAX_THREADS = 16;                      // 自动选择的解码线程数上限（FFmpeg 对多数编解码器超过 16 会告警）
+
+// 音视频同步
+constexpr int SYNC_DRIFT_WINDOW = 20;                        // 漂移估计的平滑窗口（次数）
+constexpr double SYNC_NOSYNC_THRESHOLD = 10.0;               // 偏差超过该值（秒）视为时间轴跳变，不做校正
+constexpr double SYNC_AUDIO_DRIFT_THRESHOLD = 0.03;          // 音频作为从时钟时，平均偏差超过该值才补偿样本
+constexpr int SYNC_SAMPLE_CORRECTION_PERCENT_MAX = 10;       // 单帧样本补偿的最大比例
+constexpr int SYNC_PASSTHROUGH_RESTORE_FRAMES = 50;          // 连续多少帧不需要补偿后从 swr 恢复直通，避免反复重建 swr
+
+// 视频呈现调度
+constexpr double PRESENT_DEFAULT_REFRESH_HZ = 60.0;          // 查询不到显示器刷新率时的假定值
+constexpr double PRESENT_SPIN_THRESHOLD_MS = 2.0;            // 高精度等待：剩余时间低于该值后改为让出 CPU 轮询
+constexpr int PRESENT_FAST_SWAP_LIMIT = 8;                   // 连续多少次交换未阻塞即认为垂直同步失效，改为自行定拍
+
+// 变速播放
+constexpr double TIME_STRETCH_WINDOW_MS = 30.0;              // WSOLA 分析/合成窗长（50% 重叠）
+constexpr double TIME_STRETCH_SEEK_MS = 10.0;                // 搜索最相似拼接位置的范围（±）
+constexpr double SPEED_SKIP_NONREF_MIN = 1.5;                // 不低于该速度且视频落后时跳过非参考帧的解码
+constexpr double SPEED_SKIP_NONREF_LAG = 0.08;               // 视频平均落后主时钟超过该值（秒）开始跳帧
+
+// 音频输出
+constexpr double AUDIO_RING_SECONDS = 0.2;                   // 供给线程与音频回调之间的 PCM 环形缓冲区时长
+constexpr int AUDIO_FEEDER_POLL_MS = 5;                      // 环形缓冲区满时供给线程的重试间隔
+constexpr int AUDIO_LATENCY_WINDOW = 64;                     // 设备延迟估计的滑动窗口（回调次数）
+constexpr double AUDIO_LATENCY_MAX = 1.0;                    // 设备延迟估计的上限（秒），超过视为时间轴异常
+
+// 快速打开（限量探测）
+constexpr int64_t FAST_OPEN_PROBE_SIZE = 512 * 1024;         // 探测读取的字节上限（FFmpeg 默认 5MB）
+constexpr int64_t FAST_OPEN_ANALYZE_DURATION_MS = 500;       // 探测分析的媒体时长上限（FFmpeg 默认 5 秒，MKV/TS 更长）
+
 // SDL 音频设置
 constexpr int SDL_AUDIO_BUFFER_SIZE = 1024;
 constexpr int MAX_AUDIO_FRAME_SIZE = 192000;
@@ -37,6 +99,16 @@ constexpr int FF_ERROR_EVENT = SDL_USEREVENT + 2;
 // ✅ 修复：统一定义 flush 包标识
 constexpr int FF_FLUSH_PACKET_STREAM_INDEX = -999;
 
+// flush 包的 flags 中标记精确 seek（不与 AV_PKT_FLAG_* 重叠）
+constexpr int FF_FLUSH_FLAG_ACCURATE = 0x1000;
+
+// Seek 模式
+enum class SeekMode
+{
+    KEYFRAME,   // 落在目标前的关键帧，适合快速拖动
+    ACCURATE    // 解码到 pts >= 目标的第一帧，适合逐帧审看
+};
+
 // 错误代码
 enum class PlayerError 
 {
@@ -60,4 +132,5 @@ constexpr int DEFAULT_AUDIO_BUFFER_MS = 100;
 constexpr double AV_NOSYNC_THRESHOLD = 10.0;
 
 // 性能监控
-constexpr int STATS_UPDATE_INTERVAL_MS = 1000;
\ No newline at end of file
+constexpr int STATS_UPDATE_INTERVAL_MS = 1000;
+constexpr int METRICS_DUMP_INTERVAL_MS = 5000;   // 统计 JSON 的默认输出间隔
\ No newline at end of file
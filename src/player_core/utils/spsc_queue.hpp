@@ -0,0 +1,578 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <type_traits>
+#include "flow_signal.hpp"
+#include "../../ffmpeg_utils/ffmpeg_headers.hpp"
+
+// 缓存行大小，用于隔离生产者/消费者各自读写的索引，避免伪共享
+constexpr size_t SPSC_CACHE_LINE_SIZE = 64;
+
+// 阻塞等待前的自旋次数（队列满/空通常只是短暂状态）
+constexpr int SPSC_SPIN_COUNT = 64;
+
+/**
+ * 队列元素的代价：占用的字节数和可播放时长（微秒）。
+ */
+struct QueueItemCost
+{
+    int64_t bytes = 0;
+    int64_t duration_us = 0;
+};
+
+/**
+ * 单生产者/单消费者有界环形队列。
+ *
+ * - push 只能由唯一的生产者线程调用；pop/try_pop/front 只能由唯一的消费者线程调用。
+ * - 正常路径不加锁：生产者只写 tail_，消费者只写 head_，各自独占一条缓存行。
+ * - 只有在队列满/空需要等待时才退化为互斥量 + 条件变量阻塞。
+ * - clear() 可以在任意线程调用：它只记录“清空水位”，水位之前的元素由消费者
+ *   在下一次出队时统一释放。clear() 返回时正在出队的消费者仍可能取走一个水位之前的元素，
+ *   调用方要靠 flush 包、序号等自行识别旧数据。被清空的元素立即不再计入个数、字节和时长，
+ *   生产者不必等消费者释放它们就能继续入队（底层槽位按两倍容量分配，留出尚未释放的元素）。
+ * - reset() 会直接释放所有元素，只能在生产者和消费者都已停止时调用。
+ * - 可选挂接流控信号：出队使占用降到低水位时通知“有空间”，空队列入队时通知“有数据”，
+ *   用于跨多个队列等待的线程（解封装线程、刷新定时器），代替轮询 size()。
+ * - 可选按元素代价（字节数、时长）计量：设置 set_cost_func/set_limits 后，
+ *   队列除了元素个数外还受“最多 N 字节、M 秒”约束，max_size 只作为槽位上限。
+ */
+template<typename T>
+class SpscQueue
+{
+public:
+    using ItemCleanupFunc = std::function<void(T&)>;
+    using ItemCostFunc = std::function<QueueItemCost(const T&)>;
+
+    SpscQueue(size_t max_size, ItemCleanupFunc cleanup_func = nullptr)
+        : max_size_(max_size > 0 ? max_size : 1), cleanup_func_(cleanup_func)
+    {
+        // 底层存储按 2 的幂分配，便于用掩码取模；逻辑容量仍然是 max_size_。
+        // 至少两倍容量：clear() 之后消费者释放旧元素之前，生产者可以再放入 max_size_ 个新元素
+        size_t capacity = 1;
+        while (capacity < max_size_ * 2) capacity <<= 1;
+        mask_ = capacity - 1;
+        slots_ = std::make_unique<T[]>(capacity);
+        costs_ = std::make_unique<QueueItemCost[]>(capacity);
+        cum_bytes_ = std::make_unique<std::atomic<int64_t>[]>(capacity);
+        cum_us_ = std::make_unique<std::atomic<int64_t>[]>(capacity);
+    }
+
+    ~SpscQueue()
+    {
+        drainAll();
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // 入队（生产者线程，队列满时可选阻塞等待）
+    bool push(const T& value, bool blocking = true, int timeout_ms = 100)
+    {
+        T copy(value);
+        return push(std::move(copy), blocking, timeout_ms);
+    }
+
+    // 移动入队（生产者线程）：失败时 value 保持原样，所有权仍归调用者
+    bool push(T&& value, bool blocking = true, int timeout_ms = 100)
+    {
+        if (quit_.load(std::memory_order_acquire)) return false;
+
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (!reserveSlot(tail, blocking, timeout_ms)) return false;
+
+        QueueItemCost cost = cost_func_ ? cost_func_(value) : QueueItemCost{};
+        slots_[tail & mask_] = std::move(value);
+        costs_[tail & mask_] = cost;
+
+        // 代价计数只由生产者写入，随 tail 一起发布；每个槽位另记截至该元素的累计值，供 clear() 后计量
+        int64_t pushed_bytes = pushed_bytes_.load(std::memory_order_relaxed) + cost.bytes;
+        int64_t pushed_us = pushed_us_.load(std::memory_order_relaxed) + cost.duration_us;
+        cum_bytes_[tail & mask_].store(pushed_bytes, std::memory_order_relaxed);
+        cum_us_[tail & mask_].store(pushed_us, std::memory_order_relaxed);
+        pushed_bytes_.store(pushed_bytes, std::memory_order_release);
+        pushed_us_.store(pushed_us, std::memory_order_release);
+        publish(tail + 1);
+        return true;
+    }
+
+    // 出队（消费者线程，队列空时阻塞等待直到超时）
+    bool pop(T& item, std::atomic<bool>& quit, int timeout_ms = 100)
+    {
+        for (int spin = 0; ; ++spin)
+        {
+            if (takeFront(item)) return true;
+
+            if (quit.load() || quit_.load()) return false;
+
+            if (spin < SPSC_SPIN_COUNT)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // 慢路径：登记为等待者后在条件变量上睡眠
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            pop_waiters_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool ready = cond_not_empty_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                [this, &quit]() { return hasItems() || quit.load() || quit_.load(); });
+            pop_waiters_.fetch_sub(1);
+            lock.unlock();
+
+            if (!ready) return false; // 超时
+            if (takeFront(item)) return true;
+            return false; // 退出
+        }
+    }
+
+    // 非阻塞出队（消费者线程）
+    bool try_pop(T& value)
+    {
+        return takeFront(value);
+    }
+
+    // 队列大小（任意线程，近似值）
+    size_t size() const
+    {
+        // 读取顺序：mark -> head -> tail，保证 tail 不小于前两者
+        uint64_t mark = clear_mark_.load(std::memory_order_acquire);
+        uint64_t head = head_.load(std::memory_order_acquire);
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        uint64_t begin = std::max(head, mark);
+        return tail > begin ? static_cast<size_t>(tail - begin) : 0;
+    }
+
+    // 是否为空
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    // 队列中元素占用的字节数（任意线程，近似值；不含已 clear 的元素）
+    int64_t bytes() const
+    {
+        int64_t pushed = pushed_bytes_.load(std::memory_order_acquire);
+        int64_t consumed = consumedCost().bytes;
+        return pushed > consumed ? pushed - consumed : 0;
+    }
+
+    // 队列中元素的总时长（秒，任意线程，近似值）
+    double duration() const
+    {
+        return heldDurationUs() / 1000000.0;
+    }
+
+    // 清空队列（任意线程）：丢弃调用时刻之前入队的所有元素，腾出的额度立即对生产者可见
+    void clear()
+    {
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        uint64_t mark = clear_mark_.load(std::memory_order_relaxed);
+        bool advanced = false;
+        while (mark < tail)
+        {
+            if (clear_mark_.compare_exchange_weak(mark, tail, std::memory_order_acq_rel))
+            {
+                advanced = true;
+                break;
+            }
+        }
+        if (!advanced) return;
+
+        // 在其他线程清空时，生产者可能正等待空间
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (push_waiters_.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            cond_not_full_.notify_all();
+        }
+        if (space_signal_) space_signal_->notify();
+    }
+
+    // 设置退出标志
+    void set_quit(bool quit = true)
+    {
+        quit_.store(quit);
+        if (quit)
+        {
+            {
+                std::lock_guard<std::mutex> lock(wait_mutex_);
+                cond_not_empty_.notify_all();
+                cond_not_full_.notify_all();
+            }
+            if (space_signal_) space_signal_->notify();
+            if (data_signal_) data_signal_->notify();
+        }
+    }
+
+    // 检查是否设置了退出标志
+    bool is_quit() const {
+        return quit_.load();
+    }
+
+    // 查看队列头部元素但不移除（消费者线程）
+    bool front(T& item) const {
+        uint64_t head = std::max(head_.load(std::memory_order_relaxed),
+                                 clear_mark_.load(std::memory_order_acquire));
+        if (head >= tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = slots_[head & mask_];
+        return true;
+    }
+
+    // 获取最大容量
+    size_t max_size() const { return max_size_; }
+
+    // 设置元素代价计算函数（生产者入队时调用，必须在生产者线程启动前设置）
+    void set_cost_func(ItemCostFunc cost_func)
+    {
+        cost_func_ = cost_func;
+    }
+
+    // 设置字节/时长上限，<= 0 表示不限制；超过任一上限即视为已满（单个超大元素仍可入空队列）
+    void set_limits(int64_t max_bytes, double max_seconds)
+    {
+        max_bytes_.store(max_bytes);
+        max_duration_us_.store(max_seconds > 0 ? static_cast<int64_t>(max_seconds * 1000000.0) : 0);
+    }
+
+    int64_t max_bytes() const { return max_bytes_.load(); }
+    double max_duration() const { return max_duration_us_.load() / 1000000.0; }
+
+    // 是否已满（元素个数、字节数、时长任一达到上限）
+    bool full() const
+    {
+        return size() >= max_size_ || overBudget();
+    }
+
+    // 设置“有空间”信号：出队使队列从恢复水位之上降到恢复水位及以下时通知（在启动线程前调用）。
+    // 恢复水位按 resume_ratio 同时作用于元素个数、字节上限和时长上限。
+    void set_space_signal(FlowSignal* signal, double resume_ratio)
+    {
+        space_signal_ = signal;
+        resume_ratio_ = resume_ratio;
+        low_watermark_ = static_cast<size_t>(max_size_ * resume_ratio);
+    }
+
+    // 设置“有数据”信号：队列由空变为非空时通知（在启动线程前调用）
+    void set_data_signal(FlowSignal* signal)
+    {
+        data_signal_ = signal;
+    }
+
+    size_t low_watermark() const { return low_watermark_; }
+
+    // 是否已降到恢复水位（用于恢复生产的滞回判断）
+    bool below_low_watermark() const
+    {
+        return isBelowLow(size(), bytes(), heldDurationUs());
+    }
+
+    // 重置队列状态（用于重新加载文件，要求生产者和消费者都已停止）
+    void reset() {
+        drainAll();
+
+        // 重置退出标志
+        quit_.store(false);
+
+        // 通知等待的线程
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        cond_not_empty_.notify_all();
+        cond_not_full_.notify_all();
+    }
+
+    // 获取统计信息
+    struct QueueStats {
+        size_t current_size;
+        size_t max_size;
+        int64_t bytes;
+        double duration;
+        bool is_quit;
+    };
+
+    QueueStats getStats() const {
+        return {size(), max_size_, bytes(), duration(), quit_.load()};
+    }
+
+private:
+    bool hasItems() const
+    {
+        return size() > 0;
+    }
+
+    int64_t heldDurationUs() const
+    {
+        int64_t pushed = pushed_us_.load(std::memory_order_acquire);
+        int64_t consumed = consumedCost().duration_us;
+        return pushed > consumed ? pushed - consumed : 0;
+    }
+
+    // 已出队或已被 clear 标记的元素的累计代价（不再计入队列占用的部分）
+    QueueItemCost consumedCost() const
+    {
+        uint64_t mark = clear_mark_.load(std::memory_order_acquire);
+        QueueItemCost consumed;
+        consumed.bytes = popped_bytes_.load(std::memory_order_acquire);
+        consumed.duration_us = popped_us_.load(std::memory_order_acquire);
+        if (mark > head_.load(std::memory_order_acquire))
+        {
+            // 水位前最后一个元素的累计值；消费者释放它之前生产者不会覆盖该槽位，读完后再确认一次
+            int64_t at_mark_bytes = cum_bytes_[(mark - 1) & mask_].load(std::memory_order_relaxed);
+            int64_t at_mark_us = cum_us_[(mark - 1) & mask_].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (mark > head_.load(std::memory_order_relaxed))
+            {
+                consumed.bytes = std::max(consumed.bytes, at_mark_bytes);
+                consumed.duration_us = std::max(consumed.duration_us, at_mark_us);
+            }
+        }
+        return consumed;
+    }
+
+    // 生产者：tail 位置是否可写（槽位未被占用，且个数/字节/时长未超限）
+    bool hasRoom(uint64_t tail, uint64_t head) const
+    {
+        uint64_t begin = std::max(head, clear_mark_.load(std::memory_order_acquire));
+        return tail - head <= mask_ && tail - begin < max_size_ && !overBudget();
+    }
+
+    // 字节数或时长是否已达上限
+    bool overBudget() const
+    {
+        int64_t max_bytes = max_bytes_.load(std::memory_order_relaxed);
+        int64_t max_us = max_duration_us_.load(std::memory_order_relaxed);
+        if (max_bytes > 0 && bytes() >= max_bytes) return true;
+        if (max_us > 0 && heldDurationUs() >= max_us) return true;
+        return false;
+    }
+
+    bool isBelowLow(size_t count, int64_t held_bytes, int64_t held_us) const
+    {
+        int64_t max_bytes = max_bytes_.load(std::memory_order_relaxed);
+        int64_t max_us = max_duration_us_.load(std::memory_order_relaxed);
+        return count <= low_watermark_ &&
+               (max_bytes <= 0 || held_bytes <= static_cast<int64_t>(max_bytes * resume_ratio_)) &&
+               (max_us <= 0 || held_us <= static_cast<int64_t>(max_us * resume_ratio_));
+    }
+
+    // 生产者：确认 tail 位置可写，必要时等待消费者腾出空间
+    bool reserveSlot(uint64_t tail, bool blocking, int timeout_ms)
+    {
+        if (hasRoom(tail, cached_head_)) return true;
+
+        cached_head_ = head_.load(std::memory_order_acquire);
+        if (hasRoom(tail, cached_head_)) return true;
+
+        if (!blocking) return false; // 非阻塞模式直接返回失败
+
+        for (int spin = 0; spin < SPSC_SPIN_COUNT; ++spin)
+        {
+            std::this_thread::yield();
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (hasRoom(tail, cached_head_)) return true;
+        }
+
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        push_waiters_.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ready = cond_not_full_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+            [this, tail]() {
+                return quit_.load() || hasRoom(tail, head_.load(std::memory_order_acquire));
+            });
+        push_waiters_.fetch_sub(1);
+        lock.unlock();
+
+        if (!ready || quit_.load()) return false; // 超时或退出
+
+        cached_head_ = head_.load(std::memory_order_acquire);
+        return true;
+    }
+
+    // 生产者：发布新元素并按需唤醒消费者
+    void publish(uint64_t new_tail)
+    {
+        tail_.store(new_tail, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (pop_waiters_.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            cond_not_empty_.notify_one();
+        }
+
+        if (data_signal_)
+        {
+            // 入队前队列为空（消费者已取完或已被 clear 标记）时才通知
+            uint64_t begin = std::max(head_.load(std::memory_order_acquire),
+                                      clear_mark_.load(std::memory_order_acquire));
+            if (begin + 1 >= new_tail) data_signal_->notify();
+        }
+    }
+
+    // 消费者：先释放已被 clear() 标记的元素，再取出队首元素
+    bool takeFront(T& item)
+    {
+        uint64_t old_head = head_.load(std::memory_order_relaxed);
+        uint64_t head = old_head;
+        uint64_t mark = clear_mark_.load(std::memory_order_acquire);
+        QueueItemCost freed;
+        bool released = false;
+
+        while (head < mark)
+        {
+            freed.bytes += costs_[head & mask_].bytes;
+            freed.duration_us += costs_[head & mask_].duration_us;
+            cleanup(slots_[head & mask_]);
+            ++head;
+            released = true;
+        }
+
+        if (head >= cached_tail_)
+        {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+
+        bool has_item = head < cached_tail_;
+        if (has_item)
+        {
+            freed.bytes += costs_[head & mask_].bytes;
+            freed.duration_us += costs_[head & mask_].duration_us;
+            item = std::move(slots_[head & mask_]);
+            ++head;
+        }
+
+        if (has_item || released)
+        {
+            popped_bytes_.store(popped_bytes_.load(std::memory_order_relaxed) + freed.bytes,
+                                std::memory_order_release);
+            popped_us_.store(popped_us_.load(std::memory_order_relaxed) + freed.duration_us,
+                             std::memory_order_release);
+            advanceHead(old_head, head, freed);
+        }
+        return has_item;
+    }
+
+    // 消费者：推进 head 并按需唤醒生产者
+    void advanceHead(uint64_t old_head, uint64_t new_head, const QueueItemCost& freed)
+    {
+        head_.store(new_head, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (push_waiters_.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            cond_not_full_.notify_one();
+        }
+
+        if (space_signal_)
+        {
+            // 只在跨越恢复水位时通知一次，避免每次出队都唤醒生产者
+            uint64_t tail = tail_.load(std::memory_order_acquire);
+            size_t count_before = tail > old_head ? static_cast<size_t>(tail - old_head) : 0;
+            size_t count_after = tail > new_head ? static_cast<size_t>(tail - new_head) : 0;
+            int64_t bytes_after = bytes();
+            int64_t us_after = heldDurationUs();
+            if (!isBelowLow(count_before, bytes_after + freed.bytes, us_after + freed.duration_us) &&
+                isBelowLow(count_after, bytes_after, us_after))
+            {
+                space_signal_->notify();
+            }
+        }
+    }
+
+    // 释放所有元素（仅在没有并发访问时调用）
+    void drainAll()
+    {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        while (head < tail)
+        {
+            cleanup(slots_[head & mask_]);
+            ++head;
+        }
+        head_.store(head, std::memory_order_release);
+        clear_mark_.store(head, std::memory_order_release);
+        cached_head_ = head;
+        cached_tail_ = head;
+
+        pushed_bytes_.store(0);
+        pushed_us_.store(0);
+        popped_bytes_.store(0);
+        popped_us_.store(0);
+    }
+
+    void cleanup(T& slot)
+    {
+        T item = std::move(slot);
+        if (cleanup_func_)
+        {
+            cleanup_func_(item);
+        }
+        else
+        {
+            default_cleanup(item);
+        }
+    }
+
+    // 默认清理函数
+    void default_cleanup(T& item)
+    {
+        if constexpr (std::is_same_v<T, AVPacket>)
+        {
+            av_packet_unref(&item);
+        }
+        else if constexpr (std::is_same_v<T, AVFrame*>)
+        {
+            if (item) av_frame_free(&item);
+        }
+        // 其他类型不需要特殊清理
+    }
+
+    // 消费者独占的缓存行
+    alignas(SPSC_CACHE_LINE_SIZE) std::atomic<uint64_t> head_{0};
+    uint64_t cached_tail_ = 0;        // 消费者缓存的 tail，减少跨核读取
+    std::atomic<int64_t> popped_bytes_{0};
+    std::atomic<int64_t> popped_us_{0};
+
+    // 生产者独占的缓存行
+    alignas(SPSC_CACHE_LINE_SIZE) std::atomic<uint64_t> tail_{0};
+    uint64_t cached_head_ = 0;        // 生产者缓存的 head，减少跨核读取
+    std::atomic<int64_t> pushed_bytes_{0};
+    std::atomic<int64_t> pushed_us_{0};
+
+    // 任意线程写入的清空水位
+    alignas(SPSC_CACHE_LINE_SIZE) std::atomic<uint64_t> clear_mark_{0};
+
+    // 只读配置
+    alignas(SPSC_CACHE_LINE_SIZE) std::unique_ptr<T[]> slots_;
+    std::unique_ptr<QueueItemCost[]> costs_;
+    std::unique_ptr<std::atomic<int64_t>[]> cum_bytes_;   // 截至该槽位元素的累计入队代价
+    std::unique_ptr<std::atomic<int64_t>[]> cum_us_;
+    size_t mask_ = 0;
+    size_t max_size_ = 0;
+    ItemCleanupFunc cleanup_func_ = nullptr;
+    ItemCostFunc cost_func_ = nullptr;
+    std::atomic<int64_t> max_bytes_{0};
+    std::atomic<int64_t> max_duration_us_{0};
+    std::atomic<bool> quit_{false};
+
+    // 流控信号（可选，由外部持有）
+    FlowSignal* space_signal_ = nullptr;
+    FlowSignal* data_signal_ = nullptr;
+    size_t low_watermark_ = 0;
+    double resume_ratio_ = 1.0;
+
+    // 阻塞等待回退路径
+    std::atomic<int> pop_waiters_{0};
+    std::atomic<int> push_waiters_{0};
+    std::mutex wait_mutex_;
+    std::condition_variable cond_not_empty_;
+    std::condition_variable cond_not_full_;
+};
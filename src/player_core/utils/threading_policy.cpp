@@ -0,0 +1,341 @@
+#include "threading_policy.hpp"
+#include "player_constants.hpp"
+#include "../decode/decoder_backend.hpp"
+#include <SDL2/SDL.h>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <iostream>
+#include <thread>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+const char* THREAD_NAMES[static_cast<int>(PipelineThread::COUNT)] = {
+    "demux",
+    "audio_decode",
+    "video_decode",
+    "refresh",
+    "audio_output",
+    "audio_feed",
+    "index",
+};
+
+bool findThread(const std::string& name, PipelineThread& thread)
+{
+    for (int i = 0; i < static_cast<int>(PipelineThread::COUNT); i++) {
+        if (name == THREAD_NAMES[i]) {
+            thread = static_cast<PipelineThread>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parsePriority(const std::string& text, ThreadPriority& priority)
+{
+    if (text == "low") priority = ThreadPriority::LOW;
+    else if (text == "normal") priority = ThreadPriority::NORMAL;
+    else if (text == "high") priority = ThreadPriority::HIGH;
+    else return false;
+    return true;
+}
+
+// 逐条处理 "name=value;name=value"
+template<typename Handler>
+void parseEntries(const char* env_name, Handler handler)
+{
+    const char* text = std::getenv(env_name);
+    if (!text) return;
+
+    std::stringstream entries(text);
+    std::string entry;
+    while (std::getline(entries, entry, ';')) {
+        if (entry.empty()) continue;
+        size_t eq = entry.find('=');
+        PipelineThread thread;
+        if (eq == std::string::npos || !findThread(entry.substr(0, eq), thread) ||
+            !handler(thread, entry.substr(eq + 1))) {
+            std::cerr << "Invalid " << env_name << " entry: " << entry << std::endl;
+        }
+    }
+}
+
+void setCurrentThreadName(const char* name)
+{
+#ifdef _WIN32
+    // SetThreadDescription 从 Windows 10 1607 起才有，按需动态获取
+    using SetThreadDescriptionFn = HRESULT (WINAPI*)(HANDLE, PCWSTR);
+    auto set_description = reinterpret_cast<SetThreadDescriptionFn>(
+        reinterpret_cast<void*>(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription")));
+    if (set_description) {
+        std::wstring wide(name, name + std::strlen(name));
+        set_description(GetCurrentThread(), wide.c_str());
+    }
+#elif defined(__APPLE__)
+    pthread_setname_np(name);
+#elif defined(__linux__)
+    // Linux 线程名最长 15 个字符
+    std::string truncated(name);
+    pthread_setname_np(pthread_self(), truncated.substr(0, 15).c_str());
+#else
+    (void)name;
+#endif
+}
+
+SDL_ThreadPriority toSdlPriority(ThreadPriority priority)
+{
+    switch (priority) {
+        case ThreadPriority::LOW:  return SDL_THREAD_PRIORITY_LOW;
+        case ThreadPriority::HIGH: return SDL_THREAD_PRIORITY_HIGH;
+        default:                   return SDL_THREAD_PRIORITY_NORMAL;
+    }
+}
+
+const char* threadTypeName(int thread_type)
+{
+    if (thread_type & FF_THREAD_FRAME) return "frame";
+    if (thread_type & FF_THREAD_SLICE) return "slice";
+    return "none";
+}
+
+} // namespace
+
+bool ThreadingConfig::parseCpuList(const std::string& text, std::vector<int>& cpus)
+{
+    cpus.clear();
+    std::stringstream parts(text);
+    std::string part;
+    while (std::getline(parts, part, ',')) {
+        size_t dash = part.find('-');
+        char* end = nullptr;
+        long first = std::strtol(part.c_str(), &end, 10);
+        long last = first;
+        if (end == part.c_str() || first < 0) return false;
+        if (dash != std::string::npos) {
+            const char* range_end = part.c_str() + dash + 1;
+            last = std::strtol(range_end, &end, 10);
+            if (end == range_end || last < first) return false;
+        }
+        for (long cpu = first; cpu <= last; cpu++) cpus.push_back(static_cast<int>(cpu));
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return !cpus.empty();
+}
+
+ThreadingConfig ThreadingConfig::fromEnvironment()
+{
+    ThreadingConfig config;
+
+    // 音频回调/供给和呈现线程对延迟敏感，索引线程只是后台任务
+    config.threads[static_cast<int>(PipelineThread::AUDIO_OUTPUT)].priority = ThreadPriority::HIGH;
+    config.threads[static_cast<int>(PipelineThread::AUDIO_FEED)].priority = ThreadPriority::HIGH;
+    config.threads[static_cast<int>(PipelineThread::REFRESH)].priority = ThreadPriority::HIGH;
+    config.threads[static_cast<int>(PipelineThread::INDEX)].priority = ThreadPriority::LOW;
+
+    parseEntries("SDL2_PLAYER_AFFINITY", [&config](PipelineThread thread, const std::string& value) {
+        return parseCpuList(value, config.threads[static_cast<int>(thread)].cpus);
+    });
+    parseEntries("SDL2_PLAYER_THREAD_PRIORITY", [&config](PipelineThread thread, const std::string& value) {
+        return parsePriority(value, config.threads[static_cast<int>(thread)].priority);
+    });
+
+    return config;
+}
+
+ThreadingPolicy::ThreadingPolicy(const ThreadingConfig& config) : config_(config)
+{
+    for (int i = 0; i < static_cast<int>(PipelineThread::COUNT); i++) {
+        layout_[i] = ThreadLayout{THREAD_NAMES[i], "", config_.threads[i].priority, false, false, false};
+    }
+}
+
+const char* ThreadingPolicy::threadName(PipelineThread thread)
+{
+    return THREAD_NAMES[static_cast<int>(thread)];
+}
+
+const char* ThreadingPolicy::priorityName(ThreadPriority priority)
+{
+    switch (priority) {
+        case ThreadPriority::LOW:  return "low";
+        case ThreadPriority::HIGH: return "high";
+        default:                   return "normal";
+    }
+}
+
+std::string ThreadingPolicy::formatCpuList(const std::vector<int>& cpus)
+{
+    std::ostringstream out;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) j++;
+        if (i > 0) out << ",";
+        out << cpus[i];
+        if (j > i) out << "-" << cpus[j];
+        i = j + 1;
+    }
+    return out.str();
+}
+
+bool ThreadingPolicy::setCurrentAffinity(const std::vector<int>& cpus, std::vector<int>* previous)
+{
+#ifdef _WIN32
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) mask |= DWORD_PTR(1) << cpu;
+    }
+    if (mask == 0) return false;
+
+    DWORD_PTR old_mask = SetThreadAffinityMask(GetCurrentThread(), mask);
+    if (old_mask == 0) return false;
+    if (previous) {
+        previous->clear();
+        for (int cpu = 0; cpu < static_cast<int>(sizeof(DWORD_PTR) * 8); cpu++) {
+            if (old_mask & (DWORD_PTR(1) << cpu)) previous->push_back(cpu);
+        }
+    }
+    return true;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    if (CPU_COUNT(&set) == 0) return false;
+
+    if (previous) {
+        cpu_set_t old_set;
+        previous->clear();
+        if (pthread_getaffinity_np(pthread_self(), sizeof(old_set), &old_set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &old_set)) previous->push_back(cpu);
+            }
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    // macOS 等平台没有可用的绑核接口
+    (void)cpus;
+    (void)previous;
+    return false;
+#endif
+}
+
+void ThreadingPolicy::applyToCurrentThread(PipelineThread thread)
+{
+    int index = static_cast<int>(thread);
+    const ThreadingConfig::Placement& placement = config_.threads[index];
+
+    setCurrentThreadName(THREAD_NAMES[index]);
+    bool affinity_ok = placement.cpus.empty() || setCurrentAffinity(placement.cpus);
+    bool priority_ok = SDL_SetThreadPriority(toSdlPriority(placement.priority)) == 0;
+
+    if (!affinity_ok) {
+        std::cerr << "ThreadingPolicy: Cannot pin " << THREAD_NAMES[index] << " to cpus "
+                  << formatCpuList(placement.cpus) << std::endl;
+    }
+    if (!priority_ok) {
+        std::cerr << "ThreadingPolicy: Cannot set " << THREAD_NAMES[index] << " priority to "
+                  << priorityName(placement.priority) << ": " << SDL_GetError() << std::endl;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ThreadLayout& entry = layout_[index];
+    entry.cpus = affinity_ok ? formatCpuList(placement.cpus) : "";
+    entry.priority = placement.priority;
+    entry.started = true;
+    entry.affinity_ok = affinity_ok;
+    entry.priority_ok = priority_ok;
+}
+
+void ThreadingPolicy::configureDecoder(DecoderConfig& config, AVMediaType type) const
+{
+    // 显式指定（环境变量或基准测试参数）时不覆盖
+    if (config.thread_count > 0) return;
+
+    if (type != AVMEDIA_TYPE_VIDEO) {
+        // 音频解码器基本不能并行，多线程只增加延迟
+        config.thread_count = 1;
+        return;
+    }
+
+    const std::vector<int>& cpus = config_.threads[static_cast<int>(PipelineThread::VIDEO_DECODE)].cpus;
+    if (!cpus.empty()) {
+        config.thread_count = std::min(static_cast<int>(cpus.size()), DECODER_MAX_THREADS);
+        return;
+    }
+
+    // 未绑核时留出一个核给音频回调和解封装，避免 FFmpeg 按核数 + 1 开满线程
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    if (cores > 2) {
+        config.thread_count = std::min(cores - 1, DECODER_MAX_THREADS);
+    }
+}
+
+void ThreadingPolicy::recordDecoder(AVMediaType type, const AVCodecContext* ctx)
+{
+    if (!ctx) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    DecoderLayout& entry = type == AVMEDIA_TYPE_VIDEO ? video_decoder_ : audio_decoder_;
+    entry.thread_count = ctx->thread_count;
+    entry.thread_type = ctx->active_thread_type;
+}
+
+std::vector<ThreadingPolicy::ThreadLayout> ThreadingPolicy::layout() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::vector<ThreadLayout>(layout_, layout_ + static_cast<int>(PipelineThread::COUNT));
+}
+
+ThreadingPolicy::DecoderLayout ThreadingPolicy::decoderLayout(AVMediaType type) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return type == AVMEDIA_TYPE_VIDEO ? video_decoder_ : audio_decoder_;
+}
+
+std::string ThreadingPolicy::toJson() const
+{
+    std::ostringstream out;
+    out << "{\"threads\": [";
+    std::vector<ThreadLayout> threads = layout();
+    for (size_t i = 0; i < threads.size(); i++) {
+        const ThreadLayout& t = threads[i];
+        out << (i > 0 ? ", " : "") << "{\"name\": \"" << t.name << "\""
+            << ", \"started\": " << (t.started ? "true" : "false")
+            << ", \"cpus\": \"" << (t.cpus.empty() ? "any" : t.cpus) << "\""
+            << ", \"priority\": \"" << priorityName(t.priority) << "\""
+            << ", \"affinity_ok\": " << (t.affinity_ok ? "true" : "false")
+            << ", \"priority_ok\": " << (t.priority_ok ? "true" : "false") << "}";
+    }
+    DecoderLayout audio = decoderLayout(AVMEDIA_TYPE_AUDIO);
+    DecoderLayout video = decoderLayout(AVMEDIA_TYPE_VIDEO);
+    out << "], \"audio_decoder\": {\"threads\": " << audio.thread_count
+        << ", \"thread_type\": \"" << threadTypeName(audio.thread_type) << "\"}"
+        << ", \"video_decoder\": {\"threads\": " << video.thread_count
+        << ", \"thread_type\": \"" << threadTypeName(video.thread_type) << "\"}}";
+    return out.str();
+}
+
+AffinityScope::AffinityScope(const ThreadingPolicy& policy, PipelineThread thread)
+{
+    const std::vector<int>& cpus = policy.config().threads[static_cast<int>(thread)].cpus;
+    if (!cpus.empty()) {
+        active_ = ThreadingPolicy::setCurrentAffinity(cpus, &previous_) && !previous_.empty();
+    }
+}
+
+AffinityScope::~AffinityScope()
+{
+    if (active_) {
+        ThreadingPolicy::setCurrentAffinity(previous_);
+    }
+}
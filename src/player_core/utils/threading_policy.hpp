@@ -0,0 +1,130 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include "../../ffmpeg_utils/ffmpeg_headers.hpp"
+
+struct DecoderConfig;
+
+/**
+ * 受线程策略管理的播放器线程。
+ */
+enum class PipelineThread
+{
+    DEMUX,          // DemuxThread
+    AUDIO_DECODE,   // 音频 DecodeThread
+    VIDEO_DECODE,   // 视频 DecodeThread（以及 FFmpeg 在其下创建的解码工作线程）
+    REFRESH,        // 主线程：呈现调度和 UI
+    AUDIO_OUTPUT,   // SDL 音频回调线程
+    AUDIO_FEED,     // 音频供给线程（重采样、变速后写入 PCM 环形缓冲区）
+    INDEX,          // KeyframeIndexer
+    COUNT
+};
+
+enum class ThreadPriority
+{
+    LOW,
+    NORMAL,
+    HIGH
+};
+
+/**
+ * 线程策略配置：每个线程绑定的核、优先级，以及每路流的解码线程数/类型。
+ *
+ * 环境变量（条目之间用分号分隔，线程名见 PipelineThread 对应的小写名）：
+ *   SDL2_PLAYER_AFFINITY="video_decode=2-7;audio_output=1"
+ *   SDL2_PLAYER_THREAD_PRIORITY="video_decode=low;refresh=high"
+ * 未列出的线程不绑核；解码线程数由 SDL2_PLAYER_DECODER_THREADS 等覆盖（见 DecoderConfig）。
+ */
+struct ThreadingConfig
+{
+    struct Placement
+    {
+        std::vector<int> cpus;      // 为空表示不限制
+        ThreadPriority priority = ThreadPriority::NORMAL;
+    };
+
+    Placement threads[static_cast<int>(PipelineThread::COUNT)];
+
+    static ThreadingConfig fromEnvironment();
+
+    // 解析 "0-3,6" 形式的核列表，格式错误时返回 false
+    static bool parseCpuList(const std::string& text, std::vector<int>& cpus);
+};
+
+/**
+ * 线程策略：线程启动时对自身调用 applyToCurrentThread 设置名称、绑核和优先级，
+ * 打开解码器前用 configureDecoder 决定 FFmpeg 的线程数和线程类型。
+ * 实际生效的结果记录下来，供统计浮层和基准测试输出。
+ */
+class ThreadingPolicy
+{
+public:
+    explicit ThreadingPolicy(const ThreadingConfig& config = ThreadingConfig::fromEnvironment());
+
+    static const char* threadName(PipelineThread thread);
+
+    const ThreadingConfig& config() const { return config_; }
+
+    // 设置当前线程的名称、亲和性和优先级（任意线程调用）
+    void applyToCurrentThread(PipelineThread thread);
+
+    // 未显式指定线程数时按策略填入：音频单线程，视频按绑定的核数（未绑核时留一个核给其他线程）
+    void configureDecoder(DecoderConfig& config, AVMediaType type) const;
+
+    // 记录解码器打开后实际使用的线程数和线程类型
+    void recordDecoder(AVMediaType type, const AVCodecContext* ctx);
+
+    struct ThreadLayout
+    {
+        std::string name;
+        std::string cpus;           // 实际生效的绑核（空表示不限制）
+        ThreadPriority priority;
+        bool started;
+        bool affinity_ok;
+        bool priority_ok;
+    };
+
+    struct DecoderLayout
+    {
+        int thread_count;
+        int thread_type;            // 生效的 FF_THREAD_FRAME / FF_THREAD_SLICE，0 表示单线程
+    };
+
+    std::vector<ThreadLayout> layout() const;
+    DecoderLayout decoderLayout(AVMediaType type) const;
+    std::string toJson() const;
+
+    // 设置当前线程的亲和性，previous 非空时返回原来的核列表
+    static bool setCurrentAffinity(const std::vector<int>& cpus, std::vector<int>* previous = nullptr);
+    static std::string formatCpuList(const std::vector<int>& cpus);
+    static const char* priorityName(ThreadPriority priority);
+
+private:
+    ThreadingConfig config_;
+    ThreadLayout layout_[static_cast<int>(PipelineThread::COUNT)];
+    DecoderLayout audio_decoder_{0, 0};
+    DecoderLayout video_decoder_{0, 0};
+    mutable std::mutex mutex_;
+};
+
+/**
+ * 作用域内把当前线程临时绑定到某个播放器线程的核上，析构时恢复。
+ *
+ * 用于包住 avcodec_open2：FFmpeg 在打开时创建解码工作线程，Linux 上新线程继承创建者的亲和性，
+ * 这样工作线程也落在 video_decode 的核上（Windows 上新线程使用进程亲和性，不受影响）。
+ */
+class AffinityScope
+{
+public:
+    AffinityScope(const ThreadingPolicy& policy, PipelineThread thread);
+    ~AffinityScope();
+
+    AffinityScope(const AffinityScope&) = delete;
+    AffinityScope& operator=(const AffinityScope&) = delete;
+
+private:
+    std::vector<int> previous_;
+    bool active_ = false;
+};
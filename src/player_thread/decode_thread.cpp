@@ -4,7 +4,6 @@
 #include "../player_core/utils/timestamp_utils.hpp"
 #include <thread>
 #include <iostream>
-#include <cmath> // 需要包含cmath以使用std::isnan
 
 // 模板类实现
 template<typename Decoder, typename PacketQueue, typename FrameQueue>
@@ -26,7 +25,11 @@ DecodeThread<Decoder, PacketQueue, FrameQueue>::~DecodeThread()
 template<typename Decoder, typename PacketQueue, typename FrameQueue>
 void DecodeThread<Decoder, PacketQueue, FrameQueue>::start() 
 {
+    // 已经在运行（打开文件时视频解码先于音频设备启动，以便尽早显示海报帧）
+    if (thread_.joinable()) return;
+
     running_ = true;
+    finished_ = false;
     state_->thread_started();
     thread_ = std::thread(&DecodeThread::run, this);
 }
@@ -50,31 +53,41 @@ void DecodeThread<Decoder, PacketQueue, FrameQueue>::run()
 {
     std::cout << name_ << ": Starting..." << std::endl;
 
-    AVPacket pkt;
+    bool is_audio = (name_.find("Audio") != std::string::npos);
+    state_->threading.applyToCurrentThread(is_audio ? PipelineThread::AUDIO_DECODE : PipelineThread::VIDEO_DECODE);
+
+    PacketHandle pkt;
     AVFrame* frame = av_frame_alloc();
     if (!frame) {
         std::cerr << name_ << ": Failed to allocate frame" << std::endl;
+        finished_ = true;
         state_->thread_finished();
         return;
     }
 
-    bool is_audio = (name_.find("Audio") != std::string::npos);
     int stream_index = is_audio ? state_->audio_stream : state_->video_stream;
     
     if (stream_index < 0) {
         std::cout << name_ << ": No stream available, exiting" << std::endl;
         av_frame_free(&frame);
+        finished_ = true;
         state_->thread_finished();
         return;
     }
 
     AVStream* stream = state_->fmt_ctx->streams[stream_index];
+    FramePool& frame_pool = is_audio ? state_->audio_frame_pool : state_->video_frame_pool;
     int64_t frame_number = 0;
     int frame_count = 0;
     
     // 精准 seek 相关变量
     bool seeking_flag = false;
+    bool accurate_seek = false;     // 精确模式：丢弃 pts < 目标的所有帧
+    bool skipping_nonref = false;   // 追赶期间或高速播放落后时是否让解码器跳过非参考帧
+    bool speed_skip = false;        // 高速播放时视频跟不上主时钟
     double target_seek_time = 0.0;
+    int64_t target_seek_ts = AV_NOPTS_VALUE;   // 目标时间（视频流时间基）
+    bool report_landing = false;    // 下一个送出的视频帧是 seek 后的第一帧
 
     while (running_ && !state_->quit) 
     {
@@ -86,14 +99,16 @@ void DecodeThread<Decoder, PacketQueue, FrameQueue>::run()
             break;
         }
 
-        // 获取数据包
+        // 获取数据包（等待时间反映解封装供给是否跟得上）
+        int64_t pop_start = av_gettime_relative();
         if (!pkt_queue_->pop(pkt, state_->quit, 100)) {
             if (state_->quit) break;
             continue;
         }
+        state_->metrics.record(MetricStage::PACKET_QUEUE_WAIT, av_gettime_relative() - pop_start);
 
         // ✅ 修复：正确检查 flush 包
-        if (pkt.stream_index == FF_FLUSH_PACKET_STREAM_INDEX) {
+        if (pkt.isFlush()) {
             printf("%s: Received flush packet\n", name_.c_str());
             
             // 刷新解码器缓冲区
@@ -102,14 +117,21 @@ void DecodeThread<Decoder, PacketQueue, FrameQueue>::run()
             // 清空帧队列
             int cleared_frames = frame_queue_->size();
             frame_queue_->clear();
+            if (is_audio) {
+                state_->audio_flush_serial.fetch_add(1);
+            }
             printf("%s: Decoder flushed, cleared %d frames\n", name_.c_str(), cleared_frames);
             
             // 设置精准 seek 状态
-            if (pkt.pos != AV_NOPTS_VALUE) {
+            if (pkt->pos != AV_NOPTS_VALUE) {
                 seeking_flag = true;
-                target_seek_time = pkt.pos / (double)AV_TIME_BASE;
-                printf("%s: Starting accurate seek to %.2fs\n", name_.c_str(), target_seek_time);
+                accurate_seek = pkt.isAccurateFlush();
+                target_seek_time = pkt->pos / (double)AV_TIME_BASE;
+                target_seek_ts = av_rescale_q(pkt->pos, AV_TIME_BASE_Q, stream->time_base);
+                printf("%s: Starting %s seek to %.3fs\n", name_.c_str(),
+                       accurate_seek ? "frame-accurate" : "keyframe", target_seek_time);
             }
+            report_landing = !is_audio;
             
             // ✅ 重要：对于视频解码线程，完成 flush 后重置 seeking 状态
             if (!is_audio) {
@@ -117,29 +139,52 @@ void DecodeThread<Decoder, PacketQueue, FrameQueue>::run()
                 state_->seeking.store(false);
             }
             
-            av_packet_unref(&pkt);
+            pkt.reset();
             continue;
         }
 
-        // ✅ 修复：检查 EOF 包
-        if (pkt.data == nullptr && pkt.size == 0) {
-            printf("%s: EOF packet received\n", name_.c_str());
-            av_packet_unref(&pkt);
-            break;
+        // ✅ 修复：检查 EOF 包：取出解码器中缓存的剩余帧后退出（播放列表切换条目时尾部不丢）
+        bool draining = pkt.isEof();
+        if (draining) {
+            printf("%s: EOF packet received, draining decoder\n", name_.c_str());
         }
 
         // 只处理本线程对应的流
-        if (pkt.stream_index != stream_index) {
+        if (pkt->stream_index != stream_index) {
             printf("%s: Ignoring packet from stream %d (expected %d)\n", 
-                   name_.c_str(), pkt.stream_index, stream_index);
-            av_packet_unref(&pkt);
+                   name_.c_str(), pkt->stream_index, stream_index);
+            pkt.reset();
             continue;
         }
 
-        // 发送到解码器
-        if (!decoder_->sendPacket(&pkt)) {
+        // 精确 seek 追赶期间，目标之前的包只需解出参考帧（后续帧解码依赖它们），非参考帧直接跳过；
+        // 包的 pts 即其输出帧的 pts，pts >= 目标或未知的包照常解码，保证目标帧本身不会被跳过
+        // 高速播放时解码跟不上（显示端平均落后主时钟）同样只解参考帧，带滞回避免来回切换
+        if (!is_audio && !draining) {
+            double speed = state_->sync.speed();
+            double drift = state_->sync.videoDrift();
+            if (speed < SPEED_SKIP_NONREF_MIN) {
+                speed_skip = false;
+            } else if (drift < -SPEED_SKIP_NONREF_LAG) {
+                speed_skip = true;
+            } else if (drift > -SPEED_SKIP_NONREF_LAG / 4) {
+                speed_skip = false;
+            }
+
+            bool skip = seeking_flag && accurate_seek && pkt->pts != AV_NOPTS_VALUE && pkt->pts < target_seek_ts;
+            skip = skip || speed_skip;
+            if (skip != skipping_nonref) {
+                decoder_->getCodecCtx()->skip_frame = skip ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+                skipping_nonref = skip;
+            }
+        }
+
+        // 发送到解码器（send + receive 的耗时计入解码阶段，不含取帧和入队等待）
+        int64_t decode_start = av_gettime_relative();
+        int64_t decode_wait = 0;
+        if (!(draining ? decoder_->sendEof() : decoder_->sendPacket(pkt.get()))) {
             std::cerr << name_ << ": Error sending packet to decoder" << std::endl;
-            av_packet_unref(&pkt);
+            pkt.reset();
             continue;
         }
 
@@ -155,14 +200,14 @@ void DecodeThread<Decoder, PacketQueue, FrameQueue>::run()
             // 处理时间戳
             if (frame->pts == AV_NOPTS_VALUE) 
             {
-                if (pkt.pts != AV_NOPTS_VALUE) 
+                if (pkt->pts != AV_NOPTS_VALUE) 
                 {
-                    frame->pts = av_rescale_q(pkt.pts, stream->time_base, 
+                    frame->pts = av_rescale_q(pkt->pts, stream->time_base, 
                                             decoder_->getCodecCtx()->time_base);
                 } 
-                else if (pkt.dts != AV_NOPTS_VALUE) 
+                else if (pkt->dts != AV_NOPTS_VALUE) 
                 {
-                    frame->pts = av_rescale_q(pkt.dts, stream->time_base, 
+                    frame->pts = av_rescale_q(pkt->dts, stream->time_base, 
                                             decoder_->getCodecCtx()->time_base);
                 } 
                 else 
@@ -176,9 +221,10 @@ void DecodeThread<Decoder, PacketQueue, FrameQueue>::run()
                 }
             }
             
-            // ✅ 改进：精准 seek 处理
+            // ✅ 改进：精准 seek 处理（丢弃的帧在取帧池之前释放，不产生任何复制）
             if (seeking_flag) {
                 double frame_time_seconds = 0.0;
+                bool drop = false;
                 
                 if (is_audio) {
                     frame_time_seconds = frame->pts * av_q2d(decoder_->getCodecCtx()->time_base);
@@ -189,35 +235,78 @@ void DecodeThread<Decoder, PacketQueue, FrameQueue>::run()
                 // 检查是否到达目标位置
                 double time_diff = frame_time_seconds - target_seek_time;
                 
-                if (time_diff < -0.5) { // 如果帧时间比目标时间早0.5秒以上，丢弃
-                    printf("%s: Dropping frame at %.2fs (target: %.2fs, diff: %.2fs)\n", 
-                           name_.c_str(), frame_time_seconds, target_seek_time, time_diff);
+                if (!accurate_seek) {
+                    drop = time_diff < -0.5; // 如果帧时间比目标时间早0.5秒以上，丢弃
+                } else if (is_audio) {
+                    // 音频帧结束时间仍在目标之前才丢弃
+                    double frame_end = frame_time_seconds +
+                        (frame->sample_rate > 0 ? frame->nb_samples / (double)frame->sample_rate : 0.0);
+                    drop = frame_end <= target_seek_time;
+                } else {
+                    drop = frame->pts < target_seek_ts; // 停在第一个 pts >= 目标的帧
+                }
+                
+                if (drop) {
+                    state_->stats.seek_dropped_frames++;
+                    state_->metrics.add(is_audio ? MetricCounter::AUDIO_FRAMES_DECODED : MetricCounter::VIDEO_FRAMES_DECODED);
                     av_frame_unref(frame);
                     continue;
                 } else {
                     // 到达目标位置附近，停止 seeking
                     seeking_flag = false;
-                    printf("%s: Seek completed at %.2fs (target: %.2fs, diff: %.2fs)\n", 
+                    printf("%s: Seek completed at %.3fs (target: %.3fs, diff: %.3fs)\n", 
                            name_.c_str(), frame_time_seconds, target_seek_time, time_diff);
+                    
+                    if (skipping_nonref && !speed_skip) {
+                        decoder_->getCodecCtx()->skip_frame = AVDISCARD_DEFAULT;
+                        skipping_nonref = false;
+                    }
                 }
             }
             
-            // 对于视频帧，保存PTS到opaque字段
-            if (!is_audio) {
-                double* pts_ptr = (double*)av_malloc(sizeof(double));
-                *pts_ptr = (frame->pts == AV_NOPTS_VALUE) ? NAN : 
-                        frame->pts * av_q2d(stream->time_base);
-                frame->opaque = pts_ptr;
+            // 换算到播放时间轴（微秒）：下游不再关心帧来自哪个条目、用什么时间基
+            AVRational frame_tb = is_audio ? decoder_->getCodecCtx()->time_base : stream->time_base;
+            int64_t offset = state_->timeline_offset.load();
+            int64_t duration_us = 0;
+            if (is_audio && frame->sample_rate > 0) {
+                duration_us = (int64_t)frame->nb_samples * AV_TIME_BASE / frame->sample_rate;
+            } else if (frame->pkt_duration > 0) {
+                duration_us = av_rescale_q(frame->pkt_duration, stream->time_base, AV_TIME_BASE_Q);
             }
-
-            // 克隆帧并放入队列
-            AVFrame* cloned_frame = av_frame_clone(frame);
-            if (cloned_frame) 
+            frame->pkt_duration = duration_us;
+            if (frame->pts != AV_NOPTS_VALUE) {
+                frame->pts = av_rescale_q(frame->pts, frame_tb, AV_TIME_BASE_Q) + offset;
+                (is_audio ? state_->audio_timeline_end : state_->video_timeline_end).store(frame->pts + duration_us);
+            }
+            
+            // seek 后的第一帧：由显示端结算 seek 到显示的延迟
+            if (report_landing) {
+                state_->seek_display_pts.store(state_->get_video_frame_pts(frame));
+                report_landing = false;
+            }
+            
+            state_->metrics.add(is_audio ? MetricCounter::AUDIO_FRAMES_DECODED : MetricCounter::VIDEO_FRAMES_DECODED);
+            
+            // 从帧池取出空帧，转移解码结果的引用（不复制数据，也不分配新的 AVFrame）
+            int64_t clone_start = av_gettime_relative();
+            AVFrame* out_frame = frame_pool.acquire();
+            if (out_frame) {
+                av_frame_move_ref(out_frame, frame);
+            }
+            int64_t push_start = av_gettime_relative();
+            state_->metrics.record(MetricStage::FRAME_CLONE, push_start - clone_start);
+            decode_wait += push_start - clone_start;
+            if (out_frame) 
             {
-                if (!frame_queue_->push(cloned_frame, true, 100)) 
+                bool pushed = frame_queue_->push(out_frame, true, 100);
+                int64_t push_wait = av_gettime_relative() - push_start;
+                state_->metrics.record(MetricStage::FRAME_QUEUE_WAIT, push_wait);
+                decode_wait += push_wait;
+                if (!pushed) 
                 {
                     // 队列满了，丢弃帧
-                    av_frame_free(&cloned_frame);
+                    frame_pool.release(out_frame);
+                    state_->metrics.add(MetricCounter::FRAMES_DROPPED_QUEUE);
                 } 
                 else 
                 {
@@ -233,14 +322,24 @@ void DecodeThread<Decoder, PacketQueue, FrameQueue>::run()
             av_frame_unref(frame);
         }
         
-        av_packet_unref(&pkt);
+        state_->metrics.record(is_audio ? MetricStage::AUDIO_DECODE : MetricStage::VIDEO_DECODE,
+                               av_gettime_relative() - decode_start - decode_wait);
+        
+        pkt.reset();
+        
+        if (draining) {
+            // 解码器进入结束状态，恢复可用以便之后重新解码
+            decoder_->flush();
+            break;
+        }
     }
 
     printf("%s: Finished after decoding %d frames\n", name_.c_str(), frame_count);
     av_frame_free(&frame);
+    finished_ = true;
     state_->thread_finished();
 }
 
 // 显式实例化
-template class DecodeThread<AudioDecode, SafeQueue<AVPacket>, SafeQueue<AVFrame*>>;
-template class DecodeThread<VideoDecode, SafeQueue<AVPacket>, SafeQueue<AVFrame*>>;
\ No newline at end of file
+template class DecodeThread<AudioDecode, SpscQueue<PacketHandle>, SpscQueue<AVFrame*>>;
+template class DecodeThread<VideoDecode, SpscQueue<PacketHandle>, SpscQueue<AVFrame*>>;
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include <iostream>
 #include <string>
 #include "../player_core/player_state.hpp"
-#include "../player_core/utils/safe_queue.hpp"
+#include "../player_core/utils/spsc_queue.hpp"
 
 // 前向声明
 class AudioDecode;
@@ -18,11 +18,13 @@ public:
 
     ~DecodeThread();
 
-    void start();
+    void start();   // 已启动时不做任何事
     void join();
     void stop();
 
     const std::string& name() const { return name_; }
+    // 线程已退出（收到 EOF 包并取完解码器中剩余的帧，或被停止）
+    bool finished() const { return finished_.load(); }
 
 private:
     void run();
@@ -34,12 +36,13 @@ private:
     std::string name_;
     std::thread thread_;
     std::atomic<bool> running_;
+    std::atomic<bool> finished_{false};
 };
 
 // 显式实例化声明
-extern template class DecodeThread<AudioDecode, SafeQueue<AVPacket>, SafeQueue<AVFrame*>>;
-extern template class DecodeThread<VideoDecode, SafeQueue<AVPacket>, SafeQueue<AVFrame*>>;
+extern template class DecodeThread<AudioDecode, SpscQueue<PacketHandle>, SpscQueue<AVFrame*>>;
+extern template class DecodeThread<VideoDecode, SpscQueue<PacketHandle>, SpscQueue<AVFrame*>>;
 
 // 添加类型别名
-using AudioDecodeThread = DecodeThread<AudioDecode, SafeQueue<AVPacket>, SafeQueue<AVFrame*>>;
-using VideoDecodeThread = DecodeThread<VideoDecode, SafeQueue<AVPacket>, SafeQueue<AVFrame*>>;
\ No newline at end of file
+using AudioDecodeThread = DecodeThread<AudioDecode, SpscQueue<PacketHandle>, SpscQueue<AVFrame*>>;
+using VideoDecodeThread = DecodeThread<VideoDecode, SpscQueue<PacketHandle>, SpscQueue<AVFrame*>>;
\ No newline at end of file
@@ -2,65 +2,81 @@
 #include <iostream>
 #include <thread>
 #include <climits> 
+#include <algorithm>
 #include "thread_utils.hpp"
 
 void DemuxThread::run() 
 {
     THREAD_SAFE_COUT("DemuxThread: Starting...");
+    state_->threading.applyToCurrentThread(PipelineThread::DEMUX);
     
-    // 打开输入文件
-    if (avformat_open_input(&state_->fmt_ctx, state_->filename.c_str(), nullptr, nullptr) < 0) 
+    // 停止时（打开另一个文件、退出）让阻塞在打开/探测/读取中的 FFmpeg 调用尽快返回
+    AVIOInterruptCB interrupt = {&DemuxThread::interruptCallback, this};
+
+    // 播放列表切换条目（或基准程序）时输入已由主线程接管，这里直接使用
+    if (state_->fmt_ctx) 
     {
-        state_->set_error(PlayerError::FILE_OPEN_FAILED, "Cannot open file: " + state_->filename);
-        // 通知主线程，避免死等
-        state_->demux_ready_cv.notify_one();
-        return;
-    }
-    
-    // 获取流信息
-    if (avformat_find_stream_info(state_->fmt_ctx, nullptr) < 0) {
-        state_->set_error(PlayerError::STREAM_INFO_FAILED, "Could not find stream information");
-        // 通知主线程
+        THREAD_SAFE_COUT("DemuxThread: Using pre-opened input for " << state_->filename);
+        state_->fmt_ctx->interrupt_callback = interrupt;
+        
+        // 通知主线程准备完成
+        {
+            std::lock_guard<std::mutex> lock(state_->demux_ready_mutex);
+            state_->demux_ready = true;
+        }
         state_->demux_ready_cv.notify_one();
-        return;
-    }
-    
-    // 查找音频和视频流
-    state_->audio_stream = -1;
-    state_->video_stream = -1;
-    
-    for (unsigned int i = 0; i < state_->fmt_ctx->nb_streams; i++) 
+    } 
+    else 
     {
-        if (state_->fmt_ctx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO && 
-            state_->audio_stream < 0) 
+        MediaInput& input = input_;
+        std::string message;
+        PlayerError err = openMediaInput(state_->io_options, state_->probe_options, state_->filename,
+                                         input, message, &interrupt);
+        if (err != PlayerError::NONE) 
+        {
+            // 只有本线程在运行，不必让播放器退出；主线程看到错误后报告打开失败
+            {
+                std::lock_guard<std::mutex> lock(state_->demux_ready_mutex);
+                state_->set_error(err, running_ ? message : "Open cancelled", false);
+            }
+            // 通知主线程，避免死等
+            state_->demux_ready_cv.notify_one();
+            state_->thread_finished();
+            return;
+        }
+        if (input.avio) 
         {
-            state_->audio_stream = i;
+            THREAD_SAFE_COUT("DemuxThread: Using " << input.avio->backendName() << " I/O backend");
         }
-        else if (state_->fmt_ctx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && 
-                 state_->video_stream < 0) 
+        THREAD_SAFE_COUT("DemuxThread: Probed streams in " << input.probe_us / 1000 << " ms"
+                      << (input.limited_probe ? " (limited probe)" : ""));
+        state_->stats.probe_us.store(input.probe_us);
+        state_->stats.probe_limited.store(input.limited_probe);
+        THREAD_SAFE_COUT("DemuxThread: Found audio stream: " << input.audio_stream 
+                      << ", video stream: " << input.video_stream);
+        
+        // 通知主线程准备完成
         {
-            state_->video_stream = i;
+            std::lock_guard<std::mutex> lock(state_->demux_ready_mutex);
+            state_->demux_ready = true;
         }
-    }
-    
-    if (state_->audio_stream < 0 && state_->video_stream < 0) {
-        state_->set_error(PlayerError::STREAM_INFO_FAILED, "No audio or video streams found");
-        // 通知主线程
         state_->demux_ready_cv.notify_one();
-        return;
-    }
-    
-    THREAD_SAFE_COUT("DemuxThread: Found audio stream: " << state_->audio_stream 
-                  << ", video stream: " << state_->video_stream);
-    
-    // 通知主线程准备完成
-    {
-        std::lock_guard<std::mutex> lock(state_->demux_ready_mutex);
-        state_->demux_ready = true;
+        
+        // 界面在主线程读取 fmt_ctx 和流索引，由主线程接管输入（publishInput）之后才开始读包
+        {
+            std::unique_lock<std::mutex> lock(publish_mutex_);
+            publish_cv_.wait(lock, [this]() { return published_ || !running_; });
+        }
+        if (!published_) 
+        {
+            THREAD_SAFE_COUT("DemuxThread: Stopped before the input was adopted");
+            input_.close();
+            state_->thread_finished();
+            return;
+        }
     }
-    state_->demux_ready_cv.notify_one();
     
-    AVPacket pkt;
+    PacketHandle pkt;
     int packet_count = 0;
     
     // 主循环：读取数据包并放入相应队列
@@ -77,16 +93,16 @@ void DemuxThread::run()
             }
         }
 
-        // 检查队列是否已满
-        if ((state_->audio_stream >= 0 && state_->audio_packet_queue.size() >= MAX_AUDIO_PACKETS) ||
-            (state_->video_stream >= 0 && state_->video_packet_queue.size() >= MAX_VIDEO_PACKETS)) 
+        // 队列已满时等待“有空间”信号，而不是睡眠轮询
+        if (!waitForQueueSpace()) 
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            continue;
+            continue; // 被 seek 请求或退出唤醒，回到循环顶部处理
         }
         
         // 读取数据包
-        int ret = av_read_frame(state_->fmt_ctx, &pkt);
+        int64_t read_start = av_gettime_relative();
+        int ret = av_read_frame(state_->fmt_ctx, pkt.get());
+        state_->metrics.record(MetricStage::DEMUX_READ, av_gettime_relative() - read_start);
         if (ret < 0) 
         {
             if (ret == AVERROR_EOF) 
@@ -94,23 +110,16 @@ void DemuxThread::run()
                 THREAD_SAFE_COUT("DemuxThread: End of file reached");
                 state_->demux_finished = true;
                 
-                // 发送EOF包到队列
-                AVPacket eof_pkt;
-                av_init_packet(&eof_pkt);
-                eof_pkt.data = nullptr;
-                eof_pkt.size = 0;
-                
+                // 发送EOF包到队列（使用正常的stream_index）
                 if (state_->audio_stream >= 0) 
                 {
-                    eof_pkt.stream_index = state_->audio_stream; // 使用正常的stream_index
-                    state_->audio_packet_queue.push(eof_pkt, true, 100);
+                    state_->audio_packet_queue.push(PacketHandle::makeEof(state_->audio_stream), true, 100);
                     state_->audio_eof = true;
                 }
                 
                 if (state_->video_stream >= 0) 
                 {
-                    eof_pkt.stream_index = state_->video_stream; // 使用正常的stream_index
-                    state_->video_packet_queue.push(eof_pkt, true, 100);
+                    state_->video_packet_queue.push(PacketHandle::makeEof(state_->video_stream), true, 100);
                     state_->video_eof = true;
                 }
                 
@@ -123,51 +132,62 @@ void DemuxThread::run()
         }
         
         packet_count++;
+        state_->metrics.add(MetricCounter::PACKETS_READ);
+        state_->metrics.add(MetricCounter::BYTES_READ, pkt->size);
         if (packet_count % 100 == 0) 
         {
             THREAD_SAFE_COUT("DemuxThread: Read packet " << packet_count 
-                          << ", stream: " << pkt.stream_index);
+                          << ", stream: " << pkt->stream_index);
         }
         
-        // 克隆数据包并放入相应队列
-        AVPacket* cloned_pkt = av_packet_alloc();
-        if (av_packet_ref(cloned_pkt, &pkt) == 0) 
+        // 把数据包的所有权移动进相应队列（不复制数据；入队失败或其他流的包由 reset 释放）
+        if (pkt->stream_index == state_->audio_stream) 
         {
-            if (cloned_pkt->stream_index == state_->audio_stream) 
-            {
-                if (!state_->audio_packet_queue.push(*cloned_pkt, true, 100)) 
-                {
-                    av_packet_free(&cloned_pkt);
-                }
-                else 
-                {
-                    state_->stats.audio_packets++;
-                }
-            } 
-            else if (cloned_pkt->stream_index == state_->video_stream) 
+            if (state_->audio_packet_queue.push(std::move(pkt), true, 100)) 
             {
-                if (!state_->video_packet_queue.push(*cloned_pkt, true, 100)) 
-                {
-                    av_packet_free(&cloned_pkt);
-                }
-                else 
-                {
-                    state_->stats.video_packets++;
-                }
-            } 
-            else 
+                state_->stats.audio_packets++;
+            }
+        } 
+        else if (pkt->stream_index == state_->video_stream) 
+        {
+            if (state_->video_packet_queue.push(std::move(pkt), true, 100)) 
             {
-                av_packet_free(&cloned_pkt);
+                state_->stats.video_packets++;
             }
-        }
+        } 
         
-        av_packet_unref(&pkt);
+        pkt.reset();
     }
     
     THREAD_SAFE_COUT("DemuxThread: Finished after reading " << packet_count << " packets");
+    // 格式上下文比本线程对象活得久，回调不能再指向这里
+    state_->fmt_ctx->interrupt_callback = AVIOInterruptCB{nullptr, nullptr};
     state_->thread_finished();
 }
 
+bool DemuxThread::waitForQueueSpace()
+{
+    bool audio_full = state_->audio_stream >= 0 && state_->audio_queue_full();
+    bool video_full = state_->video_stream >= 0 && state_->video_queue_full();
+    if (!audio_full && !video_full) 
+    {
+        return true;
+    }
+
+    // 滞回：已满的队列要降到恢复水位以下才继续读取
+    while (running_ && !state_->quit && !state_->seek_request.load()) 
+    {
+        uint64_t generation = state_->packet_space_signal.generation();
+        if ((!audio_full || state_->audio_packet_queue.below_low_watermark()) &&
+            (!video_full || state_->video_packet_queue.below_low_watermark())) 
+        {
+            return true;
+        }
+        state_->packet_space_signal.wait(generation, FLOW_WAIT_TIMEOUT_MS);
+    }
+    return false;
+}
+
 bool DemuxThread::handleSeekRequest()
 {
     if (!state_->seek_request.load()) {
@@ -189,8 +209,24 @@ bool DemuxThread::handleSeekRequest()
     // 设置seeking状态
     state_->seeking.store(true);
     
-    // ✅ 修复：使用更好的seek方法
-    int ret = av_seek_frame(state_->fmt_ctx, -1, seek_pos, seek_flags);
+    // 精确模式：定位到目标之前的关键帧，由解码线程解码到目标帧
+    bool accurate = state_->seek_mode.load() == SeekMode::ACCURATE;
+    if (accurate) {
+        seek_flags |= AVSEEK_FLAG_BACKWARD;
+    }
+    
+    // 关键帧索引就绪时直接定位到目标前的关键帧；关键帧模式下落点即目标，解码器无需再解码丢帧
+    int ret = 0;
+    int64_t keyframe_pos = AV_NOPTS_VALUE;
+    if (seekToKeyframe(seek_pos, seek_rel, accurate, keyframe_pos)) {
+        printf("Keyframe index: landed on keyframe at %.3fs\n", keyframe_pos / (double)AV_TIME_BASE);
+        if (!accurate) {
+            seek_pos = keyframe_pos;
+        }
+    } else {
+        // ✅ 修复：使用更好的seek方法
+        ret = av_seek_frame(state_->fmt_ctx, -1, seek_pos, seek_flags);
+    }
     
     if (ret < 0) {
         char errbuf[AV_ERROR_MAX_STRING_SIZE];
@@ -226,14 +262,7 @@ bool DemuxThread::handleSeekRequest()
     printf("Sending flush packets...\n");
     
     if (state_->audio_stream >= 0) {
-        AVPacket flush_pkt;
-        av_init_packet(&flush_pkt);
-        flush_pkt.data = nullptr;
-        flush_pkt.size = 0;
-        flush_pkt.stream_index = FF_FLUSH_PACKET_STREAM_INDEX;
-        flush_pkt.pos = seek_pos;
-        
-        if (state_->audio_packet_queue.push(flush_pkt, true, 1000)) {
+        if (state_->audio_packet_queue.push(PacketHandle::makeFlush(seek_pos, accurate), true, 1000)) {
             printf("  Audio flush packet sent\n");
         } else {
             printf("  ERROR: Failed to send audio flush packet\n");
@@ -241,14 +270,7 @@ bool DemuxThread::handleSeekRequest()
     }
     
     if (state_->video_stream >= 0) {
-        AVPacket flush_pkt;
-        av_init_packet(&flush_pkt);
-        flush_pkt.data = nullptr;
-        flush_pkt.size = 0;
-        flush_pkt.stream_index = FF_FLUSH_PACKET_STREAM_INDEX;
-        flush_pkt.pos = seek_pos;
-        
-        if (state_->video_packet_queue.push(flush_pkt, true, 1000)) {
+        if (state_->video_packet_queue.push(PacketHandle::makeFlush(seek_pos, accurate), true, 1000)) {
             printf("  Video flush packet sent\n");
         } else {
             printf("  ERROR: Failed to send video flush packet\n");
@@ -262,8 +284,7 @@ bool DemuxThread::handleSeekRequest()
     
     // 更新时钟到目标位置
     double seek_time = seek_pos / (double)AV_TIME_BASE;
-    state_->audio_clock.set(seek_time);
-    state_->video_clock.set(seek_time);
+    state_->sync.resetTo(seek_time);
     printf("Updated clocks to %.2fs\n", seek_time);
     
     // 重置 seek 请求标志
@@ -273,6 +294,57 @@ bool DemuxThread::handleSeekRequest()
     return true;
 }
 
+bool DemuxThread::seekToKeyframe(int64_t seek_pos, int64_t seek_rel, bool accurate, int64_t& keyframe_pos)
+{
+    const KeyframeIndex& index = state_->keyframe_index;
+    if (!index.ready() || index.streamIndex() != state_->video_stream) {
+        return false;
+    }
+
+    AVRational time_base = index.timeBase();
+    int64_t target_ts = av_rescale_q(seek_pos, AV_TIME_BASE_Q, time_base);
+    int64_t current_ts = av_rescale_q(seek_pos - seek_rel, AV_TIME_BASE_Q, time_base);
+
+    KeyframeIndex::Entry entry;
+    bool found = index.findBefore(target_ts, entry);
+
+    // 向前 seek 时前一个关键帧可能不在当前位置之后（长 GOP），改用目标之后的第一个关键帧；
+    // 精确模式必须从目标之前开始解码，不做此调整
+    if (!accurate && seek_rel > 0 && (!found || entry.pts <= current_ts)) {
+        found = index.findAfter(target_ts, entry);
+    }
+    if (!found) {
+        return false;
+    }
+
+    AVFormatContext* fmt_ctx = state_->fmt_ctx;
+    int ret = -1;
+
+    // 时间戳不连续的容器（TS/PS 等）自身索引很差，按记录的字节偏移定位；其他容器按时间戳精确定位
+    int format_flags = fmt_ctx->iformat ? fmt_ctx->iformat->flags : 0;
+    if ((format_flags & AVFMT_TS_DISCONT) && !(format_flags & AVFMT_NO_BYTE_SEEK) && entry.pos >= 0) {
+        ret = av_seek_frame(fmt_ctx, state_->video_stream, entry.pos, AVSEEK_FLAG_BYTE);
+    }
+    if (ret < 0) {
+        // 多数容器的索引和 seek 按 dts 计时，B 帧流的关键帧 pts > dts，以 pts 为下限会落到下一个关键帧。
+        // 以该关键帧的 pts 为上限：下一个关键帧的 dts 晚于它的 pts（重排延迟短于 GOP），解封装器落在
+        // 这个关键帧上，容器索引缺少它时落在更早的关键帧上，解码线程按目标丢帧，不会越过目标
+        ret = avformat_seek_file(fmt_ctx, state_->video_stream, INT64_MIN, entry.pts, entry.pts, 0);
+    }
+    if (ret < 0) {
+        return false;
+    }
+
+    keyframe_pos = av_rescale_q(entry.pts, time_base, AV_TIME_BASE_Q);
+    return true;
+}
+
+int DemuxThread::interruptCallback(void* opaque)
+{
+    DemuxThread* self = static_cast<DemuxThread*>(opaque);
+    return (!self->running_ || self->state_->quit) ? 1 : 0;
+}
+
 void DemuxThread::start() 
 {
     running_ = true;
@@ -282,7 +354,21 @@ void DemuxThread::start()
 
 void DemuxThread::stop() 
 { 
-    running_ = false; 
+    {
+        std::lock_guard<std::mutex> lock(publish_mutex_);
+        running_ = false; 
+    }
+    publish_cv_.notify_all();
+}
+
+void DemuxThread::publishInput()
+{
+    state_->adoptInput(input_);
+    {
+        std::lock_guard<std::mutex> lock(publish_mutex_);
+        published_ = true;
+    }
+    publish_cv_.notify_all();
 }
 
 void DemuxThread::join() 
@@ -1,8 +1,11 @@
 #pragma once
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include "../player_core/player_state.hpp"
 #include "../player_core/utils/player_constants.hpp" // ✅ 包含常量定义
+#include "../player_core/media_input.hpp"
 
 class DemuxThread 
 {
@@ -15,12 +18,23 @@ public:
     void start();
     void join();
     void stop();
+    // state->fmt_ctx 为空时本线程自己打开文件；demux_ready 且无错误之后由主线程调用，
+    // 把打开的输入交给 PlayerState，本线程随后开始读包
+    void publishInput();
 
 private:
     void run();
     bool handleSeekRequest();
+    // 按关键帧索引定位，成功时返回选中关键帧的时间（AV_TIME_BASE 单位）；索引未就绪或定位失败返回 false
+    bool seekToKeyframe(int64_t seek_pos, int64_t seek_rel, bool accurate, int64_t& keyframe_pos);
+    bool waitForQueueSpace(); // 包队列满时阻塞等待，返回 false 表示被 seek/退出打断
+    static int interruptCallback(void* opaque);
 
     PlayerState* state_;
     std::thread thread_;
     std::atomic<bool> running_;
+    MediaInput input_;                  // 打开完成到主线程接管之间暂存
+    std::mutex publish_mutex_;
+    std::condition_variable publish_cv_;
+    bool published_ = false;
 };
\ No newline at end of file
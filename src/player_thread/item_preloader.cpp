@@ -0,0 +1,99 @@
+#include "item_preloader.hpp"
+#include "thread_utils.hpp"
+
+void ItemPreloader::run()
+{
+    // 做的是解封装线程的工作，沿用它的优先级/绑核
+    state_->threading.applyToCurrentThread(PipelineThread::DEMUX);
+
+    int64_t start = av_gettime_relative();
+    AVIOInterruptCB interrupt = {&ItemPreloader::interruptCallback, this};
+    std::string message;
+    // 预加载不赶时间，完整探测流信息（切换后没有后台探测补全时长）
+    PlayerError err = openMediaInput(state_->io_options, ProbeOptions(), item_->filename, item_->input,
+                                     message, &interrupt);
+    if (err != PlayerError::NONE || !openDecoders(*item_))
+    {
+        THREAD_SAFE_COUT("ItemPreloader: " << (running_ ? "Failed to open " : "Cancelled ") << item_->filename
+                      << (message.empty() ? "" : " (" + message + ")"));
+        item_.reset();
+    }
+    else
+    {
+        THREAD_SAFE_COUT("ItemPreloader: " << item_->filename << " ready in "
+                      << (av_gettime_relative() - start) / 1000 << " ms");
+    }
+    done_ = true;
+}
+
+bool ItemPreloader::openDecoders(PreparedItem& item)
+{
+    if (!running_) return false;
+
+    if (item.input.audio_stream >= 0)
+    {
+        AVCodecParameters* codecpar = item.input.fmt_ctx->streams[item.input.audio_stream]->codecpar;
+        DecoderConfig config = DecoderConfig::fromEnvironment(AVMEDIA_TYPE_AUDIO);
+        state_->threading.configureDecoder(config, AVMEDIA_TYPE_AUDIO);
+        item.audio_decoder = std::make_unique<AudioDecode>();
+        AffinityScope affinity(state_->threading, PipelineThread::AUDIO_DECODE);
+        if (!item.audio_decoder->open(codecpar, config) || item.audio_decoder->getCodecCtx()->sample_rate <= 0)
+        {
+            return false;
+        }
+    }
+
+    if (item.input.video_stream >= 0 && running_)
+    {
+        AVCodecParameters* codecpar = item.input.fmt_ctx->streams[item.input.video_stream]->codecpar;
+        DecoderConfig config = DecoderConfig::fromEnvironment(AVMEDIA_TYPE_VIDEO);
+        state_->threading.configureDecoder(config, AVMEDIA_TYPE_VIDEO);
+        item.video_decoder = std::make_unique<VideoDecode>();
+        // FFmpeg 在打开时创建解码工作线程，让它们继承解码线程的绑核
+        AffinityScope affinity(state_->threading, PipelineThread::VIDEO_DECODE);
+        if (!item.video_decoder->open(codecpar, config))
+        {
+            return false;
+        }
+    }
+    return running_;
+}
+
+int ItemPreloader::interruptCallback(void* opaque)
+{
+    ItemPreloader* self = static_cast<ItemPreloader*>(opaque);
+    return (!self->running_ || self->state_->quit) ? 1 : 0;
+}
+
+void ItemPreloader::start(int index, const std::string& filename)
+{
+    cancel();
+    index_ = index;
+    item_ = std::make_unique<PreparedItem>();
+    item_->index = index;
+    item_->filename = filename;
+    done_ = false;
+    running_ = true;
+    thread_ = std::thread(&ItemPreloader::run, this);
+}
+
+void ItemPreloader::cancel()
+{
+    running_ = false;
+    if (thread_.joinable())
+        thread_.join();
+    item_.reset();
+    index_ = -1;
+    done_ = false;
+}
+
+std::unique_ptr<PreparedItem> ItemPreloader::take()
+{
+    if (thread_.joinable())
+        thread_.join();
+    std::unique_ptr<PreparedItem> item = std::move(item_);
+    index_ = -1;
+    done_ = false;
+    running_ = false;
+    return item;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <string>
+#include "../player_core/player_state.hpp"
+#include "../player_core/media_input.hpp"
+#include "../player_core/decode/audio_decode.hpp"
+#include "../player_core/decode/video_decode.hpp"
+
+/**
+ * 预先打开好的播放列表条目：输入已探测，解码器已打开，切换时整体交给 PlayerState。
+ */
+struct PreparedItem
+{
+    int index = -1;
+    std::string filename;
+    MediaInput input;
+    std::unique_ptr<AudioDecode> audio_decoder;
+    std::unique_ptr<VideoDecode> video_decoder;
+};
+
+/**
+ * 后台预加载线程。
+ *
+ * 当前条目开始播放后就打开下一条目（I/O 后端、avformat_find_stream_info、解码器），
+ * 当前条目播放完时主线程直接接管结果，切换过程中没有文件打开和探测的等待。
+ * 与 KeyframeIndexer 一样用中断回调响应取消；不计入 PlayerState 的线程计数。
+ */
+class ItemPreloader
+{
+public:
+    explicit ItemPreloader(PlayerState* state) : state_(state) {}
+    ~ItemPreloader() { cancel(); }
+
+    // 开始预加载第 index 项（取消进行中的预加载）
+    void start(int index, const std::string& filename);
+    // 停止并丢弃结果
+    void cancel();
+
+    bool pending() const { return index_ >= 0; }
+    bool done() const { return done_.load(); }
+    int index() const { return index_; }
+
+    // 线程结束后取走结果；打开失败时返回 nullptr
+    std::unique_ptr<PreparedItem> take();
+
+private:
+    void run();
+    bool openDecoders(PreparedItem& item);
+    static int interruptCallback(void* opaque);
+
+    PlayerState* state_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> done_{false};
+    int index_ = -1;
+    std::unique_ptr<PreparedItem> item_;
+};
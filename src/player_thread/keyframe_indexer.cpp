@@ -0,0 +1,123 @@
+#include "keyframe_indexer.hpp"
+#include <iostream>
+#include "thread_utils.hpp"
+
+void KeyframeIndexer::run() 
+{
+    state_->threading.applyToCurrentThread(PipelineThread::INDEX);
+
+    KeyframeIndex& index = state_->keyframe_index;
+    index.setStatus(KeyframeIndex::Status::BUILDING);
+
+    std::string key = KeyframeIndex::cacheKey(filename_);
+    std::vector<KeyframeIndex::Entry> entries;
+
+    if (KeyframeIndex::loadCache(key, stream_index_, time_base_, entries)) 
+    {
+        THREAD_SAFE_COUT("KeyframeIndexer: Loaded " << entries.size() << " keyframes from cache");
+        index.publish(std::move(entries), stream_index_, time_base_, true);
+        state_->thread_finished();
+        return;
+    }
+
+    int64_t start = av_gettime_relative();
+    if (!scan(entries) || entries.empty()) 
+    {
+        THREAD_SAFE_COUT("KeyframeIndexer: Scan " << (running_ && !state_->quit ? "failed" : "interrupted"));
+        index.setStatus(KeyframeIndex::Status::FAILED);
+        state_->thread_finished();
+        return;
+    }
+
+    THREAD_SAFE_COUT("KeyframeIndexer: Indexed " << entries.size() << " keyframes in "
+                  << (av_gettime_relative() - start) / 1000 << " ms");
+
+    KeyframeIndex::saveCache(key, stream_index_, time_base_, entries);
+    index.publish(std::move(entries), stream_index_, time_base_, false);
+    state_->thread_finished();
+}
+
+bool KeyframeIndexer::scan(std::vector<KeyframeIndex::Entry>& entries)
+{
+    AVFormatContext* fmt_ctx = avformat_alloc_context();
+    if (!fmt_ctx) return false;
+
+    // 停止时让阻塞在 FFmpeg 内部的读取尽快返回
+    fmt_ctx->interrupt_callback.callback = &KeyframeIndexer::interruptCallback;
+    fmt_ctx->interrupt_callback.opaque = this;
+
+    if (avformat_open_input(&fmt_ctx, filename_.c_str(), nullptr, nullptr) < 0) {
+        return false;
+    }
+
+    if (stream_index_ >= static_cast<int>(fmt_ctx->nb_streams)) {
+        avformat_close_input(&fmt_ctx);
+        return false;
+    }
+
+    // 只需要视频流的包头（时间戳、标志、偏移），其他流在解封装层直接丢弃
+    for (unsigned int i = 0; i < fmt_ctx->nb_streams; i++) {
+        fmt_ctx->streams[i]->discard = (static_cast<int>(i) == stream_index_) ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    }
+
+    int64_t file_size = fmt_ctx->pb ? avio_size(fmt_ctx->pb) : -1;
+    AVPacket* pkt = av_packet_alloc();
+    int packet_count = 0;
+    bool ok = pkt != nullptr;
+
+    while (ok && running_ && !state_->quit) 
+    {
+        int ret = av_read_frame(fmt_ctx, pkt);
+        if (ret == AVERROR_EOF) break;
+        if (ret < 0) {
+            // 文件尾部损坏时保留已扫描的部分
+            ok = !entries.empty();
+            break;
+        }
+
+        if (pkt->stream_index == stream_index_ && (pkt->flags & AV_PKT_FLAG_KEY)) 
+        {
+            int64_t ts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+            if (ts != AV_NOPTS_VALUE) {
+                entries.push_back({ts, pkt->pos});
+            }
+        }
+
+        if (++packet_count % KEYFRAME_INDEX_PROGRESS_PACKETS == 0 && file_size > 0 && pkt->pos >= 0) {
+            state_->keyframe_index.setProgress(static_cast<float>(pkt->pos) / file_size);
+        }
+
+        av_packet_unref(pkt);
+    }
+
+    if (!running_ || state_->quit) ok = false;
+
+    av_packet_free(&pkt);
+    avformat_close_input(&fmt_ctx);
+    return ok;
+}
+
+int KeyframeIndexer::interruptCallback(void* opaque)
+{
+    KeyframeIndexer* self = static_cast<KeyframeIndexer*>(opaque);
+    return (!self->running_ || self->state_->quit) ? 1 : 0;
+}
+
+void KeyframeIndexer::start() 
+{
+    filename_ = state_->filename;
+    running_ = true;
+    state_->thread_started();
+    thread_ = std::thread(&KeyframeIndexer::run, this);
+}
+
+void KeyframeIndexer::stop() 
+{ 
+    running_ = false; 
+}
+
+void KeyframeIndexer::join() 
+{
+    if (thread_.joinable()) 
+        thread_.join();
+}
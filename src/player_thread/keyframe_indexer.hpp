@@ -0,0 +1,38 @@
+#pragma once
+#include <thread>
+#include <atomic>
+#include <string>
+#include "../player_core/player_state.hpp"
+
+/**
+ * 后台关键帧索引线程。
+ *
+ * 先按文件内容哈希查找缓存；没有缓存时用独立的 AVFormatContext 只读视频流扫描一遍，
+ * 记录每个关键帧包的 pts 和字节偏移，发布到 PlayerState::keyframe_index 并写入缓存。
+ * 只处理本地文件；与解封装线程互不干扰，扫描期间 seek 照常走容器自带的索引。
+ */
+class KeyframeIndexer 
+{
+public:
+    // stream_index/time_base 取自解封装线程已打开的视频流，必须在 demux_ready 之后构造
+    KeyframeIndexer(PlayerState* state, int stream_index, AVRational time_base)
+        : state_(state), stream_index_(stream_index), time_base_(time_base), running_(false) 
+    {
+    }
+
+    void start();
+    void join();
+    void stop();
+
+private:
+    void run();
+    bool scan(std::vector<KeyframeIndex::Entry>& entries);
+    static int interruptCallback(void* opaque);
+
+    PlayerState* state_;
+    std::string filename_;
+    int stream_index_;
+    AVRational time_base_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+};
@@ -0,0 +1,53 @@
+#include "stream_info_prober.hpp"
+#include "thread_utils.hpp"
+
+void StreamInfoProber::run() 
+{
+    // 和关键帧索引一样是不影响播放的后台扫描
+    state_->threading.applyToCurrentThread(PipelineThread::INDEX);
+
+    int64_t start = av_gettime_relative();
+    AVIOInterruptCB interrupt = {&StreamInfoProber::interruptCallback, this};
+    MediaInput input;
+    std::string message;
+    PlayerError err = openMediaInput(state_->io_options, ProbeOptions(), filename_, input, message, &interrupt);
+
+    if (err != PlayerError::NONE || input.fmt_ctx->duration == AV_NOPTS_VALUE) 
+    {
+        THREAD_SAFE_COUT("StreamInfoProber: " << (running_ && !state_->quit ? "Duration still unknown" : "Interrupted"));
+        state_->thread_finished();
+        return;
+    }
+
+    // 解封装线程没有得到时长时才发布
+    int64_t unknown = AV_NOPTS_VALUE;
+    state_->media_duration.compare_exchange_strong(unknown, input.fmt_ctx->duration);
+    THREAD_SAFE_COUT("StreamInfoProber: Duration " << input.fmt_ctx->duration / (double)AV_TIME_BASE
+                  << "s after full probe in " << (av_gettime_relative() - start) / 1000 << " ms");
+    state_->thread_finished();
+}
+
+int StreamInfoProber::interruptCallback(void* opaque)
+{
+    StreamInfoProber* self = static_cast<StreamInfoProber*>(opaque);
+    return (!self->running_ || self->state_->quit) ? 1 : 0;
+}
+
+void StreamInfoProber::start() 
+{
+    filename_ = state_->filename;
+    running_ = true;
+    state_->thread_started();
+    thread_ = std::thread(&StreamInfoProber::run, this);
+}
+
+void StreamInfoProber::stop() 
+{ 
+    running_ = false; 
+}
+
+void StreamInfoProber::join() 
+{
+    if (thread_.joinable()) 
+        thread_.join();
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <thread>
+#include <atomic>
+#include <string>
+#include "../player_core/player_state.hpp"
+
+/**
+ * 后台补全流信息。
+ *
+ * 快速打开只探测文件开头，已经足够开始解码和播放，但总时长可能还不知道（需要扫描更多数据或
+ * 文件尾部的格式）。此时用独立的 AVFormatContext 按默认范围完整探测一遍，把得到的时长发布到
+ * PlayerState::media_duration。播放照常进行；解码器、重采样器和渲染器按帧适应探测没拿到的参数。
+ */
+class StreamInfoProber 
+{
+public:
+    explicit StreamInfoProber(PlayerState* state)
+        : state_(state), running_(false) 
+    {
+    }
+
+    void start();
+    void join();
+    void stop();
+
+private:
+    void run();
+    static int interruptCallback(void* opaque);
+
+    PlayerState* state_;
+    std::string filename_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+};
@@ -123,9 +123,9 @@ void ControlPanel::RenderProgressBar(const ImVec2& size)
     }
 
     // 获取时长与当前时间（秒）
-    int64_t duration_ts = m_playerState->fmt_ctx->duration;
-    double total_seconds = (duration_ts > 0) ? (double)duration_ts / (double)AV_TIME_BASE : 0.0;
-    double current_seconds = m_playerState->video_clock.get();
+    double duration = m_playerState->mediaDuration();
+    double total_seconds = (duration > 0.0) ? duration : 0.0;
+    double current_seconds = m_playerState->itemPosition(m_playerState->video_clock.get());
     float progress = (total_seconds > 0.0) ? std::clamp((float)(current_seconds / total_seconds), 0.0f, 1.0f) : 0.0f;
 
     // 轨道高度与垂直偏移（使轨道在给定区域内垂直居中）
@@ -490,9 +490,13 @@ void ControlPanel::RenderSpeedControl(float width, float height)
         int idx = 3;
         static const char* speeds[] = {"0.25x","0.5x","0.75x","1.0x","1.25x","1.5x","2.0x"};
         static const float speed_vals[] = {0.25f,0.5f,0.75f,1.0f,1.25f,1.5f,2.0f};
+        if (m_playerState) m_playbackSpeed = static_cast<float>(m_playerState->playback_speed.load());
         for (int i=0;i<7;i++) if (std::abs(m_playbackSpeed - speed_vals[i]) < 0.01f) { idx = i; break; }
         ImGui::SetNextItemWidth(-1);
-        if (ImGui::Combo("##speed", &idx, speeds, 7)) m_playbackSpeed = speed_vals[idx];
+        if (ImGui::Combo("##speed", &idx, speeds, 7)) {
+            m_playbackSpeed = speed_vals[idx];
+            if (m_playerState) m_playerState->playback_speed.store(m_playbackSpeed);
+        }
     ImGui::PopID();
 
     // 打开文件：尽量小的高度并占满列宽
@@ -15,21 +15,96 @@ void MainPanel::Render() {
         
         ImGui::Separator();
         
-        // 队列状态
-        ImGui::Text("音频包队列: %d/%d", 
-                   m_playerState->audio_packet_queue.size(), MAX_AUDIO_PACKETS);
-        ImGui::Text("视频包队列: %d/%d", 
-                   m_playerState->video_packet_queue.size(), MAX_VIDEO_PACKETS);
-        ImGui::Text("音频帧队列: %d/%d", 
-                   m_playerState->audio_frame_queue.size(), MAX_AUDIO_FRAMES);
-        ImGui::Text("视频帧队列: %d/%d", 
-                   m_playerState->video_frame_queue.size(), MAX_VIDEO_FRAMES);
+        // 队列状态（个数 / 字节 / 时长）
+        auto queueLine = [](const char* label, size_t count, int max_count, int64_t bytes, double seconds) {
+            ImGui::Text("%s: %d/%d  %.1f MB  %.2f s", label, (int)count, max_count,
+                       bytes / (1024.0 * 1024.0), seconds);
+        };
+        queueLine("音频包队列", m_playerState->audio_packet_queue.size(), MAX_AUDIO_PACKETS,
+                  m_playerState->audio_packet_queue.bytes(), m_playerState->audio_packet_queue.duration());
+        queueLine("视频包队列", m_playerState->video_packet_queue.size(), MAX_VIDEO_PACKETS,
+                  m_playerState->video_packet_queue.bytes(), m_playerState->video_packet_queue.duration());
+        queueLine("音频帧队列", m_playerState->audio_frame_queue.size(), MAX_AUDIO_FRAMES,
+                  m_playerState->audio_frame_queue.bytes(), m_playerState->audio_frame_queue.duration());
+        queueLine("视频帧队列", m_playerState->video_frame_queue.size(), MAX_VIDEO_FRAMES,
+                  m_playerState->video_frame_queue.bytes(), m_playerState->video_frame_queue.duration());
+        
+        ImGui::Separator();
+
+        // 文件 I/O 状态
+        if (m_playerState->avio) {
+            IoStats io = m_playerState->avio->getStats();
+            ImGui::Text("I/O (%s): 读取 %.1f MB, 系统调用 %lld",
+                       m_playerState->avio->backendName(),
+                       io.bytes_read / (1024.0 * 1024.0), (long long)io.syscalls);
+        } else {
+            ImGui::Text("I/O (ffmpeg)");
+        }
+
+        // 关键帧索引状态
+        const KeyframeIndex& kf_index = m_playerState->keyframe_index;
+        switch (kf_index.status()) {
+            case KeyframeIndex::Status::BUILDING:
+                ImGui::Text("关键帧索引: 扫描中 %.0f%%", kf_index.progress() * 100.0f);
+                break;
+            case KeyframeIndex::Status::READY:
+                ImGui::Text("关键帧索引: %d 个关键帧%s", (int)kf_index.size(),
+                           kf_index.fromCache() ? " (缓存)" : "");
+                break;
+            case KeyframeIndex::Status::FAILED:
+                ImGui::Text("关键帧索引: 不可用");
+                break;
+            default:
+                ImGui::Text("关键帧索引: 未建立");
+                break;
+        }
+
+        // Seek 模式与延迟
+        bool accurate = m_playerState->seek_mode.load() == SeekMode::ACCURATE;
+        if (ImGui::Checkbox("精确 Seek (A)", &accurate)) {
+            m_playerState->seek_mode.store(accurate ? SeekMode::ACCURATE : SeekMode::KEYFRAME);
+        }
+        const auto& stats = m_playerState->stats;
+        int64_t seek_count = stats.seek_count.load();
+        ImGui::Text("Seek: %lld 次, 最近 %.1f ms, 平均 %.1f ms, 最大 %.1f ms, 追帧丢弃 %lld",
+                   (long long)seek_count, stats.seek_latency_last_us.load() / 1000.0,
+                   seek_count > 0 ? stats.seek_latency_total_us.load() / 1000.0 / seek_count : 0.0,
+                   stats.seek_latency_max_us.load() / 1000.0, (long long)stats.seek_dropped_frames.load());
+        ImGui::Text("音频欠载: %lld 次, 补静音 %lld 字节, 待播放 %lld 帧",
+                   (long long)stats.audio_underruns.load(), (long long)stats.audio_underrun_bytes.load(),
+                   (long long)stats.audio_queued_frames.load());
+        // 打开耗时：探测流信息，到第一帧上屏 / 第一次输出音频（尚未发生时显示 -）
+        auto openLatency = [](int64_t us, char* buf, size_t size) {
+            if (us > 0) snprintf(buf, size, "%.0f ms", us / 1000.0);
+            else snprintf(buf, size, "-");
+            return buf;
+        };
+        char probe_text[32], frame_text[32], audio_text[32];
+        ImGui::Text("打开: 探测 %s%s, 首帧 %s, 首次出声 %s",
+                   openLatency(stats.probe_us.load(), probe_text, sizeof(probe_text)),
+                   stats.probe_limited.load() ? " (限量)" : "",
+                   openLatency(stats.first_frame_us.load(), frame_text, sizeof(frame_text)),
+                   openLatency(stats.first_audio_us.load(), audio_text, sizeof(audio_text)));
+
+        // 帧池状态
+        const FramePool* pools[] = {&m_playerState->audio_frame_pool, &m_playerState->video_frame_pool};
+        for (const FramePool* pool : pools) {
+            FramePool::PoolStats ps = pool->getStats();
+            ImGui::Text("%s帧池: 命中 %lld / 未命中 %lld, 借出 %lld (峰值 %lld), 空闲 %d",
+                       pool->name() == "audio" ? "音频" : "视频",
+                       (long long)ps.hits, (long long)ps.misses,
+                       (long long)ps.outstanding, (long long)ps.high_water, (int)ps.idle);
+        }
         
         ImGui::Separator();
         
         // 时钟信息
         ImGui::Text("视频时钟: %.3f s", m_playerState->video_clock.get());
         ImGui::Text("音频时钟: %.3f s", m_playerState->audio_clock.get());
+        const SyncEngine& sync = m_playerState->sync;
+        ImGui::Text("主时钟: %s, 音频漂移 %.1f ms, 视频漂移 %.1f ms, 声卡延迟 %.1f ms",
+                   SyncEngine::masterName(sync.master()),
+                   sync.audioDrift() * 1000.0, sync.videoDrift() * 1000.0, sync.audioLatency() * 1000.0);
         
         // 流信息
         if (m_playerState->audio_stream >= 0) {
@@ -40,9 +115,9 @@ void MainPanel::Render() {
         }
         
         // 进度信息
-        if (m_playerState->fmt_ctx && m_playerState->fmt_ctx->duration != AV_NOPTS_VALUE) {
-            double total_seconds = m_playerState->fmt_ctx->duration / AV_TIME_BASE;
-            double current_seconds = m_playerState->video_clock.get();
+        double total_seconds = m_playerState->mediaDuration();
+        if (m_playerState->fmt_ctx && !std::isnan(total_seconds)) {
+            double current_seconds = m_playerState->itemPosition(m_playerState->video_clock.get());
             float progress = (total_seconds > 0) ? static_cast<float>(current_seconds / total_seconds) : 0.0f;
             
             ImGui::Separator();
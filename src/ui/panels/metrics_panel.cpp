@@ -0,0 +1,106 @@
+#include "metrics_panel.hpp"
+#include <imgui/imgui.h>
+#include "../../player_core/player_state.hpp"
+
+void MetricsPanel::Render() {
+    if (!m_visible || !m_playerState) return;
+
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    if (!ImGui::Begin("流水线统计 (F3)", &m_visible, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
+
+    const PipelineMetrics& metrics = m_playerState->metrics;
+
+    if (ImGui::BeginTable("stages", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("阶段");
+        ImGui::TableSetupColumn("次数");
+        ImGui::TableSetupColumn("p50 ms");
+        ImGui::TableSetupColumn("p99 ms");
+        ImGui::TableSetupColumn("最大 ms");
+        ImGui::TableSetupColumn("预算 ms");
+        ImGui::TableSetupColumn("超预算");
+        ImGui::TableHeadersRow();
+
+        for (int i = 0; i < PipelineMetrics::STAGE_COUNT; i++) {
+            MetricStage stage = static_cast<MetricStage>(i);
+            LatencyHistogram::Snapshot s = metrics.histogram(stage).snapshot();
+            int64_t budget = PipelineMetrics::stageBudget(stage);
+            int64_t over = metrics.overBudget(stage);
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(PipelineMetrics::stageName(stage));
+            ImGui::TableNextColumn(); ImGui::Text("%lld", (long long)s.count);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", s.p50_us / 1000.0);
+            ImGui::TableNextColumn();
+            // p99 超出预算时标红，一眼看出瓶颈阶段
+            if (budget > 0 && s.p99_us > budget) {
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%.2f", s.p99_us / 1000.0);
+            } else {
+                ImGui::Text("%.2f", s.p99_us / 1000.0);
+            }
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", s.max_us / 1000.0);
+            ImGui::TableNextColumn();
+            if (budget > 0) {
+                ImGui::Text("%.1f", budget / 1000.0);
+            } else {
+                ImGui::TextDisabled("-");
+            }
+            ImGui::TableNextColumn(); ImGui::Text("%lld", (long long)over);
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::Separator();
+    for (int i = 0; i < PipelineMetrics::COUNTER_COUNT; i++) {
+        MetricCounter counter = static_cast<MetricCounter>(i);
+        ImGui::Text("%s: %lld", PipelineMetrics::counterName(counter), (long long)metrics.counter(counter));
+    }
+    ImGui::Text("display: %.2f Hz, %s", m_playerState->stats.display_refresh_hz.load(),
+               m_playerState->stats.vsync_locked.load() ? "vsync" : "software pacing");
+
+    // 线程布局：实际生效的绑核和优先级（设置失败的标红）
+    ImGui::Separator();
+    const ThreadingPolicy& threading = m_playerState->threading;
+    if (ImGui::BeginTable("threads", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("线程");
+        ImGui::TableSetupColumn("绑核");
+        ImGui::TableSetupColumn("优先级");
+        ImGui::TableHeadersRow();
+
+        const ImVec4 failed(1.0f, 0.4f, 0.4f, 1.0f);
+        for (const ThreadingPolicy::ThreadLayout& t : threading.layout()) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            if (t.started) {
+                ImGui::TextUnformatted(t.name.c_str());
+            } else {
+                ImGui::TextDisabled("%s", t.name.c_str());
+            }
+            ImGui::TableNextColumn();
+            if (t.started && !t.affinity_ok) {
+                ImGui::TextColored(failed, "失败");
+            } else {
+                ImGui::TextUnformatted(t.cpus.empty() ? "any" : t.cpus.c_str());
+            }
+            ImGui::TableNextColumn();
+            if (t.started && !t.priority_ok) {
+                ImGui::TextColored(failed, "%s", ThreadingPolicy::priorityName(t.priority));
+            } else {
+                ImGui::TextUnformatted(ThreadingPolicy::priorityName(t.priority));
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    ThreadingPolicy::DecoderLayout video = threading.decoderLayout(AVMEDIA_TYPE_VIDEO);
+    ThreadingPolicy::DecoderLayout audio = threading.decoderLayout(AVMEDIA_TYPE_AUDIO);
+    auto threadType = [](int type) {
+        return (type & FF_THREAD_FRAME) ? "frame" : (type & FF_THREAD_SLICE) ? "slice" : "none";
+    };
+    ImGui::Text("video decoder: %d threads (%s)", video.thread_count, threadType(video.thread_type));
+    ImGui::Text("audio decoder: %d threads (%s)", audio.thread_count, threadType(audio.thread_type));
+
+    ImGui::End();
+}
@@ -0,0 +1,18 @@
+// metrics_panel.hpp
+#pragma once
+
+#include "../gui_panel.hpp"
+
+/**
+ * 流水线统计浮层：各阶段耗时分位数、超预算次数、计数器和线程布局（F3 或 View 菜单切换）。
+ */
+class MetricsPanel : public GuiPanel {
+public:
+    void Render() override;
+
+    void SetVisible(bool visible) { m_visible = visible; }
+    bool IsVisible() const { return m_visible; }
+
+private:
+    bool m_visible = false;
+};
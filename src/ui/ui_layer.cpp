@@ -2,6 +2,7 @@
 #include "../play/opengl_renderer.hpp"
 #include "player_core/player_state.hpp"
 #include "panels/main_panel.hpp"
+#include "panels/metrics_panel.hpp"
 #include "../utils/file_dialog.hpp"
 
 #include <algorithm>       // std::min, std::clamp
@@ -207,6 +208,16 @@ void UiLayer::RenderMenuBar()
             ImGui::EndMenu();
         }
         
+        if (ImGui::BeginMenu("View")) 
+        {
+            bool show_metrics = IsMetricsVisible();
+            if (ImGui::MenuItem("Pipeline Metrics", "F3", &show_metrics)) 
+            {
+                SetMetricsVisible(show_metrics);
+            }
+            ImGui::EndMenu();
+        }
+        
         if (ImGui::BeginMenu("Help")) 
         {
             if (ImGui::MenuItem("About")) 
@@ -343,11 +354,30 @@ void UiLayer::ClearVideoInfo()
     }
 }
 
+/**
+ * @brief 显示或隐藏指标面板
+*/
+void UiLayer::SetMetricsVisible(bool visible) 
+{
+    auto* panel = static_cast<MetricsPanel*>(m_guiManager.GetPanel("MetricsPanel"));
+    if (panel) panel->SetVisible(visible);
+}
+
+/**
+ * @brief 指标面板是否可见
+*/
+bool UiLayer::IsMetricsVisible() 
+{
+    auto* panel = static_cast<MetricsPanel*>(m_guiManager.GetPanel("MetricsPanel"));
+    return panel && panel->IsVisible();
+}
+
 /**
  * @brief 注册所有面板
 */
 void UiLayer::RegisterPanels() 
 {
     m_guiManager.AddPanel("MainPanel", std::make_unique<MainPanel>());
+    m_guiManager.AddPanel("MetricsPanel", std::make_unique<MetricsPanel>());
 }
 
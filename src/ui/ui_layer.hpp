@@ -36,6 +36,9 @@ public:
     void SetVisible(bool visible) { m_visible = visible; }
     bool IsVisible() const { return m_visible; }
     
+    void SetMetricsVisible(bool visible);   // 流水线统计浮层
+    bool IsMetricsVisible();
+    
     void SetVideoSize(int width, int height);
     void SetVideoTexture(GLuint texture);
     void UpdateVideoInfo(GLuint texture, int width, int height); // 一次性更新